@@ -3,13 +3,17 @@
 
 #include "facilities.h"
 #include "gsl_interface.h"
+#include "spline.h"
 #include "type_aliases.h"
 
 #include <algorithm>
 #include <complex>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 /// Facilities for dealing with complex valued functions.
@@ -17,6 +21,9 @@ namespace cauchy {
 using type_aliases::Complex;
 using Curve = std::function<Complex(double)>;
 using Complex_function = std::function<Complex(const Complex&)>;
+using Batch_curve = std::function<std::vector<Complex>(
+        const std::vector<double>&)>;
+    // evaluates a curve at many parameter values at once
 using gsl::Interval;
 
 // -- Basic facilities --------------------------------------------------------
@@ -139,6 +146,27 @@ std::tuple<Complex,double,double> c_integrate(const Curve& c,
     ///< Using `c_integrate`, the same instance of `Integration` can be used for
     ///< both.
 
+std::tuple<Complex,double,double> c_integrate(const Curve& c,
+        const Interval& points, const gsl::Integration& integrate);
+    ///< Integrate `c` in the interval [`points.front()`,`points.back()`]
+    ///< using `integrate`, the inner elements of `points` are known
+    ///< non-smooth points of `c`. Return the value of the integral, the error
+    ///< of the real part and the error of the imaginary part.
+
+std::tuple<Complex,double,double> c_integrate(const Batch_curve& c,
+        double lower, double upper, const gsl::Integration& integrate);
+    ///< Integrate `c` in the interval [`lower`,`upper`] using
+    ///< `gsl::Integration::batch`. Return the value of the integral, the
+    ///< error of the real part and the error of the imaginary part.
+
+std::tuple<Complex,double,double> c_integrate(const Batch_curve& c,
+        const Interval& points, const gsl::Integration& integrate);
+    ///< Integrate `c` in the interval [`points.front()`,`points.back()`]
+    ///< using `gsl::Integration::batch` for each subinterval, the inner
+    ///< elements of `points` are known non-smooth points of `c`. Return the
+    ///< value of the integral, the error of the real part and the error of
+    ///< the imaginary part.
+
 std::tuple<Complex,double,double> c_integrate(const Complex_function& f,
         const Curve& c, const Curve& c_derivative, double lower, double upper,
         const gsl::Integration& integrate);
@@ -146,6 +174,142 @@ std::tuple<Complex,double,double> c_integrate(const Complex_function& f,
     ///< `integrate`. Return the value of the integral, the error of the real
     ///< part and the error of the imaginary part.
 
+std::tuple<Complex,double,double> c_principal_value(const Curve& c,
+        double lower, double upper, double singularity,
+        const gsl::Principal_value& integrate);
+    ///< Compute the principal value of the integral of
+    ///< `c`(x)/(x-`singularity`) in the interval [`lower`,`upper`] using
+    ///< `integrate`. Return the value of the integral, the error of the real
+    ///< part and the error of the imaginary part.
+
+Complex polygon_integral(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, const Complex& s, int subtractions,
+        std::pair<std::size_t,std::size_t> principal={0,0});
+    ///< @brief Return \f$s^n\int dz\, f(z)/(z^n(z-s))\f$ along the polygon
+    ///< `z[0]`, `z[1]`, ..., where \f$f\f$ is linear in \f$z\f$ between
+    ///< adjacent vertices with \f$f(\f$`z[k]`\f$)=\f$`f[k]` and
+    ///< \f$n=\f$`subtractions`.
+    ///<
+    ///< The integral is computed in closed form, piece by piece. The pieces
+    ///< [`z[k]`,`z[k+1]`] with `principal.first`<=k<`principal.second` need
+    ///< to lie on a straight line through `s`, for them the Cauchy principal
+    ///< value is taken. Otherwise, `s` must not lie on the polygon and the
+    ///< polygon must not pass through 0.
+
+std::vector<Complex> polygon_moments(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, int subtractions);
+    ///< @brief Return \f$\int dz\, f(z)/z^{j+1}\f$ along the polygon for
+    ///< j=0,...,`subtractions`-1, with the same conventions as for
+    ///< `polygon_integral`.
+
+Complex polygon_integral(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, const Complex& s,
+        const std::vector<Complex>& moments,
+        std::pair<std::size_t,std::size_t> principal={0,0});
+    ///< @brief Same as above, where `moments` is the result of
+    ///< `polygon_moments`.
+    ///<
+    ///< The moments do not depend on `s`, such that the subtractions cost
+    ///< nothing if many values of `s` share the same polygon.
+
+std::vector<Complex> polygon_integrals(const std::vector<Complex>& z,
+        const std::vector<std::vector<Complex>>& f, const Complex& s,
+        const std::vector<std::vector<Complex>>& moments,
+        std::pair<std::size_t,std::size_t> principal={0,0});
+    ///< @brief Same as above for several functions `f[i]` with moments
+    ///< `moments[i]` along the same polygon.
+    ///<
+    ///< The logarithms depend on the polygon and `s` only and are evaluated
+    ///< once for all functions.
+
+// -- Fast Cauchy sums --------------------------------------------------------
+
+/// @brief Evaluate the sums \f$\sum_j q_j/(x_j-s_i)\f$ for fixed nodes
+/// \f$x_j\f$, fixed targets \f$s_i\f$ and arbitrary charges \f$q_j\f$.
+///
+/// For many nodes and targets, the sums are computed via the fast multipole
+/// method on a quadtree covering nodes and targets, which needs
+/// O(N+M) operations for N nodes and M targets. The tree is built once in the
+/// constructor. If summing directly is cheaper, this is done instead.
+class Cauchy_sum {
+public:
+    Cauchy_sum(const std::vector<Complex>& nodes,
+            const std::vector<Complex>& targets, double tolerance=1e-12);
+        ///< @brief `tolerance` bounds the error of each sum relative to
+        ///< \f$\sum_j |q_j|/|x_j-s_i|\f$.
+        ///<
+        ///< Targets must not coincide with nodes.
+
+    std::vector<Complex> operator()(const std::vector<Complex>& charges)
+        const;
+        ///< @brief Return the sums for all targets, `charges` contains the
+        ///< \f$q_j\f$ in the same order as the nodes.
+
+    std::size_t nodes_size() const noexcept {return nodes.size();}
+    std::size_t targets_size() const noexcept {return targets.size();}
+    bool is_direct() const noexcept {return levels.empty();}
+        ///< Return true if the sums are computed directly.
+private:
+    // Boxes are identified by their Morton code, i.e. by interleaving the
+    // bits of their position on the 2^level x 2^level grid of their level.
+    // Only boxes containing nodes (sources) or targets are stored.
+    struct Level {
+        std::vector<std::uint64_t> sources;
+        std::vector<std::uint64_t> targets;
+        std::vector<std::size_t> source_parents;
+        std::vector<std::size_t> target_parents;
+        std::vector<std::size_t> interaction_offsets;
+        std::vector<std::size_t> interactions;
+            // the source boxes interacting with a target box via expansions:
+            // they are well separated from the target box, while their
+            // parents are neighbours of the target box's parent
+    };
+
+    std::vector<Complex> nodes;
+    std::vector<Complex> targets;
+    std::size_t order;
+        // the number of terms of the expansions
+    Complex corner;
+    double width;
+        // lower left corner and width of the root box
+    std::vector<Level> levels;
+        // levels[i] corresponds to level i+2, the coarsest level with well
+        // separated boxes being level 2
+
+    // the nodes and targets contained in the leaves in compressed sparse row
+    // format, as well as the source leaves neighbouring each target leaf
+    std::vector<std::size_t> node_offsets;
+    std::vector<std::size_t> node_order;
+    std::vector<std::size_t> target_offsets;
+    std::vector<std::size_t> target_order;
+    std::vector<std::size_t> near_offsets;
+    std::vector<std::size_t> near;
+
+    std::vector<double> binomials;
+        // binomial coefficients C(n,k) at n*2*order+k
+
+    std::size_t depth() const noexcept {return levels.size()+1;}
+    double radius(std::size_t level) const noexcept;
+        // half the width of the boxes of `level`
+    Complex center(std::uint64_t box, std::size_t level) const noexcept;
+    double binomial(std::size_t n, std::size_t k) const noexcept
+        {return binomials[n*2*order+k];}
+    void build(std::size_t depth);
+    double cost() const;
+        // Estimate the number of operations needed by the fast multipole
+        // method.
+    std::vector<Complex> direct(const std::vector<Complex>& charges) const;
+};
+
+std::vector<Complex> cauchy_sum(const std::vector<Complex>& nodes,
+        const std::vector<Complex>& charges,
+        const std::vector<Complex>& targets, double tolerance=1e-12);
+    ///< @brief Return \f$\sum_j q_j/(x_j-s_i)\f$ for all targets \f$s_i\f$,
+    ///< where \f$x_j\f$ and \f$q_j\f$ are given by `nodes` and `charges`.
+    ///<
+    ///< See `Cauchy_sum`, which should be used if the same nodes and targets
+    ///< are used for several sets of charges.
+
 // -- Interpolation -----------------------------------------------------------
 
 /// @brief Interpolate data provided as pairs \f$(x_i,y_i)\f$, here \f$y_i\f$
@@ -153,24 +317,34 @@ std::tuple<Complex,double,double> c_integrate(const Complex_function& f,
 class Interpolate {
 public:
     Interpolate(const Interval& x, const std::vector<Complex>& y,
-            gsl::Interpolation_method m);
+            spline::Method m);
         ///< The sizes of `x` and `y` need to be the same.
 
-    Complex operator()(double x) const;
+    Complex operator()(double x) const noexcept {return spline(x);}
         ///< Return the value of the (interpolated) data at point `x`.
 
         ///< If evaluated outside the interval (`front()`,`back()`), the
         ///< boundary values are returned.
 
-    double front() const noexcept {return real_part.front();}
-    double back() const noexcept {return real_part.back();}
+    void operator()(const double* first, const double* last, Complex* out)
+        const noexcept {spline(first,last,out);}
+        ///< @brief Evaluate the interpolation at all points in
+        ///< [`first`,`last`) and write the results to `out`.
+        ///<
+        ///< This is fastest if the points are sorted.
+    std::vector<Complex> operator()(const std::vector<double>& x) const
+        {return spline(x);}
+        ///< Return the values of the interpolation at all elements of `x`.
+
+    double front() const noexcept {return spline.front();}
+    double back() const noexcept {return spline.back();}
 private:
-    gsl::Interpolate real_part;
-    gsl::Interpolate imaginary_part;
+    spline::Spline<Complex> spline;
+        // real and imaginary parts are stored interleaved
 };
 
 Interpolate sample(const Complex_function& f, const Curve& c,
-        const Interval& i, gsl::Interpolation_method m);
+        const Interval& i, spline::Method m);
     ///< Interpolate `f` along `c`.
 
     ///< Return interpolator for data pairs
@@ -178,14 +352,74 @@ Interpolate sample(const Complex_function& f, const Curve& c,
     ///< order) and contains at least 2 elements. It is guaranteed that the
     ///< returned `Interpolate` instance works at boundaries of `i`.
 
-Interpolate sample(const Curve& c, const Interval& i,
-        gsl::Interpolation_method m);
+Interpolate sample(const Curve& c, const Interval& i, spline::Method m);
     ///< Interpolate `c` along `i`.
 
     ///< Return interpolator for data pairs
     ///< ( i[k], c(i[k]) ). It is assumed that `i` is sorted (in ascending
     ///< order) and contains at least 2 elements. It is guaranteed that the
     ///< returned `Interpolate` instance works at boundaries of `i`.
+
+/// @brief Interpolate data sampled at the knots of Gauss-Legendre rules on
+/// adjacent intervals via barycentric Lagrange interpolation on each interval.
+///
+/// In contrast to splines, this keeps the spectral accuracy of the
+/// Gauss-Legendre rules for data that is smooth on each interval.
+class Legendre_interpolate {
+public:
+    Legendre_interpolate(const Interval& boundaries,
+            const std::vector<std::size_t>& sizes,
+            const std::vector<Complex>& y);
+        ///< @brief `y` contains the data at the knots of the
+        ///< `gsl::Gauss_Legendre` rules with `sizes[k]` points on
+        ///< [`boundaries[k]`,`boundaries[k+1]`], in the order of the rules
+        ///< (cf. `grid::Grid::x_parameter_values`).
+
+    Complex operator()(double x) const;
+        ///< @brief Return the value of the (interpolated) data at point `x`.
+        ///<
+        ///< If evaluated outside the interval (`front()`,`back()`), the
+        ///< boundary values are returned.
+    void operator()(const double* first, const double* last, Complex* out)
+        const;
+        ///< @brief Evaluate the interpolation at all points in
+        ///< [`first`,`last`) and write the results to `out`.
+    std::vector<Complex> operator()(const std::vector<double>& x) const;
+        ///< Return the values of the interpolation at all elements of `x`.
+
+    Complex polygon_integral(const std::vector<Complex>& z, const Complex& s,
+            int subtractions,
+            std::pair<std::size_t,std::size_t> principal={0,0}) const;
+        ///< @brief Return \f$s^n\int dz\, f(z)/(z^n(z-s))\f$ along the
+        ///< polygon `z[0]`, `z[1]`, ..., where `z[k]` corresponds to
+        ///< `boundaries[k]`, the polygon is parametrised linearly on each
+        ///< interval and \f$n=\f$`subtractions`.
+        ///<
+        ///< The same conventions as for the free function `polygon_integral`
+        ///< apply. The error is of the order of the interpolation error.
+
+    double front() const noexcept {return boundaries.front();}
+    double back() const noexcept {return boundaries.back();}
+private:
+    Interval boundaries;
+    std::vector<std::size_t> offsets;
+        // the knots of interval k are those in [offsets[k],offsets[k+1])
+    std::vector<double> knots;
+        // mapped to [0,1] and sorted in ascending order on each interval
+    std::vector<double> weights;
+        // the Gauss-Legendre weights on [0,1]
+    std::vector<double> barycentric;
+        // the weights of the barycentric formula
+    std::vector<Complex> values;
+
+    std::size_t locate(double x) const noexcept;
+    template<typename U>
+    Complex evaluate(std::size_t k, const U& u) const noexcept;
+        // Evaluate the polynomial on interval `k` at `u` in [0,1]-units.
+    Complex piece_integral(std::size_t k, const Complex& za,
+            const Complex& zb, const Complex& s, int subtractions,
+            bool principal) const;
+};
 } // cauchy
 
 #endif // CAUCHY_HEADER_H
@@ -6,7 +6,9 @@
 #include "type_aliases.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <type_traits>
@@ -23,27 +25,112 @@ std::vector<Complex> first_points(const grid::Curve& curve, std::size_t size);
 std::vector<Complex> all_points(const grid::Curve& curve);
     ///< Extract all boundary points of `curve`.
 
-bool on_second_sheet(const std::vector<Complex>& points,
-        const Complex& mandelstam_s);
-    ///< Determine if `mandelstam_s` is on the second sheet.
+/// @brief The region enclosed by a curve and the real axis in the lower half
+/// plane.
+///
+/// If the right-hand cut of the Omnes function is deformed onto the curve,
+/// this is the part of the complex plane where the function is evaluated on
+/// its second sheet. The region is classified by a crossing number test. A
+/// curve that is not a polygon is divided into edges, along which both its
+/// real and its imaginary part are monotonic. Only points in the bounding box
+/// of such an edge need the curve itself, where the crossing is located by
+/// bisection.
+class Region {
+public:
+    template<typename C>
+    explicit Region(const C& curve, std::size_t samples=64)
+        : Region{curve,samples,curve.is_linear()
+            ? Curve_function{}
+            : Curve_function{[c = std::make_shared<const C>(curve)](double x)
+                {return c->curve_func(x);}}} {}
+        ///< @param samples The number of edges each piece of `curve` is
+        ///< divided into at least, unless the curve is a polygon already
+        ///< (cf. `Curve::is_linear`).
+    bool contains(const Complex& s) const;
+        ///< Determine if `s` lies inside the region.
+    std::vector<bool> contains(const std::vector<Complex>& s) const;
+        ///< @brief Same as above for many points at once, where the loop over
+        ///< the points is the inner one.
+private:
+    using Curve_function = std::function<Complex(double)>;
+
+    /// An edge of the polygon that is not horizontal.
+    struct Edge {
+        double imag_lower;
+        double imag_upper;
+        double real_start;
+        double imag_start;
+        double slope;
+            ///< the change of the real part per imaginary part
+        std::size_t piece{none};
+            ///< the index of the piece of the curve in `pieces`, if any
+
+        static constexpr std::size_t none{static_cast<std::size_t>(-1)};
+
+        bool crosses(const Complex& s) const noexcept
+            /// Determine whether a ray from `s` to the right crosses the edge.
+        {
+            return s.imag()>=imag_lower && s.imag()<imag_upper
+                && s.real()<real_start+(s.imag()-imag_start)*slope;
+        }
+    };
+
+    /// The piece of a curve an edge stands for.
+    struct Piece {
+        double parameter_start;
+        double parameter_end;
+        Complex end;
+        double real_lower;
+        double real_upper;
+    };
+
+    Region(const grid::Curve& curve, std::size_t samples,
+            Curve_function curve_func);
+
+    bool in_bounds(const Complex& s) const noexcept
+    {
+        return s.imag()<0.0 && s.imag()>=imag_lower
+            && s.real()>=real_lower && s.real()<=real_upper;
+    }
+    bool crosses(const Edge& e, const Complex& s) const
+        // Same as `Edge::crosses`, but against the curve for curved edges.
+    {
+        if (e.piece==Edge::none || s.imag()<e.imag_lower
+                || s.imag()>=e.imag_upper)
+            return e.crosses(s);
+        const auto& p{pieces[e.piece]};
+        if (s.real()<p.real_lower)
+            return true;
+        if (s.real()>=p.real_upper)
+            return false;
+        return crosses_curve(e,p,s);
+    }
+    bool crosses_curve(const Edge& e, const Piece& p, const Complex& s) const;
+        // Locate the crossing for `s` inside the bounding box of `p`.
+
+    Curve_function curve_func;
+    std::vector<Edge> edges;
+    std::vector<Piece> pieces;
+    double real_lower;
+    double real_upper;
+    double imag_lower;
+};
 
 /// An Omnes function with a cut along `curve`.
 class CurvedOmnes {
 public:
     template<typename C>
-    CurvedOmnes(omnes::OmnesF o, CFunction amplitude, C&& curve)
+    CurvedOmnes(omnes::OmnesF o, CFunction amplitude, C&& curve,
+            std::size_t samples=64)
         /// @param o The omnes function with the usual right-hand cut.
         /// @param amplitude The two-to-two particle scattering amplitude
         /// associated with the phase of `o`.
-        /// @param curve The branch cut of the returned Omnes function.
-        /// Currently, this needs to be a piecewise curve with either two
-        /// points (in this case a subset of the real axis) or one with at
-        /// least four knots, where
-        /// the first four knots form a rectangle extending into the lower half
-        /// plane. This is due to the non-general inner-workings of
-        /// `on_second_sheet`.
+        /// @param curve The branch cut of the returned Omnes function. It
+        /// starts at the branch point and may leave the real axis into the
+        /// lower half plane (cf. `Region`).
+        /// @param samples cf. `Region`
         : o{std::move(o)}, amplitude{std::move(amplitude)},
-        points{all_points(std::forward<C>(curve))}
+        region{curve,samples}
     {
         static_assert(std::is_base_of_v<grid::Curve,
                                         std::remove_reference_t<C>>,
@@ -52,11 +139,24 @@ public:
 
     Complex operator()(Complex mandelstam_s) const
     {
-        if (on_second_sheet(points, mandelstam_s))
+        if (region.contains(mandelstam_s))
             return omnes::second_sheet(o, amplitude, mandelstam_s);
         return o(mandelstam_s);
     }
 
+    std::vector<Complex> operator()(const std::vector<Complex>& mandelstam_s)
+        const
+        /// Same as above, but all points are classified in one pass.
+    {
+        const auto second{region.contains(mandelstam_s)};
+        std::vector<Complex> result(mandelstam_s.size());
+        for (std::size_t k{0}; k<result.size(); ++k)
+            result[k] = second[k]
+                ? omnes::second_sheet(o, amplitude, mandelstam_s[k])
+                : o(mandelstam_s[k]);
+        return result;
+    }
+
     const omnes::OmnesF& original() const
     {
         return o;
@@ -64,7 +164,7 @@ public:
 private:
     omnes::OmnesF o;
     CFunction amplitude;
-    std::vector<Complex> points;
+    Region region;
 };
 } // curved_omnes
 
@@ -45,6 +45,19 @@ constexpr T square(const T& x)
     return x*x;
 }
 
+template<class T>
+constexpr T power(T x, unsigned n)
+    /// Return `x` to the power `n` via repeated squaring.
+{
+    T result{1};
+    for (; n; n >>= 1) {
+        if (n & 1u)
+            result *= x;
+        x *= x;
+    }
+    return result;
+}
+
 template<class T>
 constexpr T identity(const T& x)
 {
@@ -66,6 +79,31 @@ constexpr Out identity(const In& x)
     return x;
 }
 
+template<class Argument, class Return>
+std::function<std::vector<Return>(const std::vector<Argument>&)>
+vectorize(std::function<Return(Argument)> f)
+    /// Return a function applying `f` elementwise to a vector of arguments.
+{
+    return [f = std::move(f)](const std::vector<Argument>& x)
+    {
+        std::vector<Return> result(x.size());
+        std::transform(x.cbegin(),x.cend(),result.begin(),f);
+        return result;
+    };
+}
+
+template<class Argument, class Return>
+std::function<Return(Argument)>
+scalarize(std::function<std::vector<Return>(const std::vector<Argument>&)> f)
+    /// @brief Return a function evaluating the vectorized function `f` at a
+    /// single argument.
+{
+    return [f = std::move(f)](Argument x)
+    {
+        return f(std::vector<Argument>{x}).front();
+    };
+}
+
 template<class F, class G>
 constexpr auto compose(F&& f, G&& g)
     /// Return the composition of `f` and `g`.
@@ -7,9 +7,11 @@
 #include <algorithm>
 #include <complex>
 #include <cmath>
+#include <functional>
 #include <iterator>
 #include <numeric>
 #include <optional>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -36,20 +38,91 @@ using Knots = std::vector<Knot>;
 template<typename T1, typename T2=double>
 using Sampling_points = std::vector<std::tuple<T1,T2,T1>>;
 
-Knots generate_knots(double start, double end, std::size_t points);
-    ///< @brief Return (point,weight) pairs for Gauss-Legendre integration in
-    ///< interval [`start`,`end`].
+/// The available quadrature rules.
+enum class Quadrature {
+    gauss_legendre,
+        ///< the Gauss-Legendre rule, the most accurate for smooth integrands
+    fejer,
+        ///< @brief Fejér's second rule, i.e. interpolatory quadrature on the
+        ///< extrema of the Chebyshev polynomials. Its knots are nested: the
+        ///< knots of the rule with n points are among those of the rule with
+        ///< 2n+1 points (cf. `Grid::refined`).
+    gauss_jacobi,
+        ///< @brief the Gauss-Jacobi rule, exact for polynomials times
+        ///< powers of the distances to the endpoints (cf.
+        ///< `Rule::gauss_jacobi`)
+    graded,
+        ///< @brief composite Gauss-Legendre rule on intervals shrinking
+        ///< geometrically towards an endpoint (cf. `Rule::graded`)
+    clenshaw_curtis
+        ///< @brief interpolatory quadrature on the Chebyshev extrema including
+        ///< the endpoints, at least two points are needed. As the Omnes
+        ///< function is singular at the threshold and at its cutoff, this is
+        ///< suitable for inner panels of a curve only.
+};
+
+/// @brief A quadrature rule together with its parameters.
+///
+/// The weights always refer to the plain integral over an interval, i.e. the
+/// weight function of Gauss-Jacobi is divided out. Hence, all rules can be
+/// used interchangeably, e.g. on different panels of a `Grid`.
+class Rule {
+public:
+    Rule(Quadrature quadrature=Quadrature::gauss_legendre) noexcept
+        : _quadrature{quadrature} {}
+        ///< @brief Use `quadrature` with the default parameters, i.e. an
+        ///< exponent 1/2 at the start for Gauss-Jacobi and four levels with
+        ///< ratio 0.15 towards the start for the graded rule.
+    static Rule gauss_jacobi(double start_exponent, double end_exponent=0.0);
+        ///< @brief Return the Gauss-Jacobi rule for integrands behaving like
+        ///< (x-start)^`start_exponent` (end-x)^`end_exponent` times a smooth
+        ///< function, the exponents need to be larger than -1.
+        ///<
+        ///< E.g. for integrands with a square-root threshold at the start of
+        ///< the interval, use `start_exponent`=0.5.
+    static Rule graded(std::size_t levels, double ratio=0.15,
+            bool at_start=true);
+        ///< @brief Return the composite Gauss-Legendre rule on `levels`+1
+        ///< intervals, whose lengths decrease by `ratio` towards the start (or
+        ///< the end, if `at_start` is false) of the interval.
+        ///<
+        ///< The points are distributed evenly on the intervals, this resolves
+        ///< integrands that are non-analytic at the endpoint.
+
+    Quadrature quadrature() const noexcept {return _quadrature;}
+    Rule z_rule() const noexcept;
+        ///< @brief Return the rule to be used along the line in the z-plane.
+        ///<
+        ///< The integrands are smooth in z, such that Gauss-Legendre is used
+        ///< unless the rule is nested (cf. `Grid::refined`).
+    Knots knots(double start, double end, std::size_t points) const;
+        ///< @brief Return (point,weight) pairs for integration in the interval
+        ///< [`start`,`end`], sorted in ascending order.
+private:
+    Quadrature _quadrature;
+    double start_exponent{0.5};
+    double end_exponent{0.0};
+    std::size_t levels{4};
+    double ratio{0.15};
+    bool at_start{true};
+};
+
+Knots generate_knots(double start, double end, std::size_t points,
+        const Rule& rule=Rule{});
+    ///< @brief Return (point,weight) pairs for integration in interval
+    ///< [`start`,`end`] (cf. `Rule::knots`).
 
 template<typename F1, typename F2>
 auto knots_along_curve(double start, double end,
-        std::size_t points, const F1& curve, const F2& derivative)
-    /// Compute `curve` and `derivative` at Gauss-Legendre knots.
+        std::size_t points, const F1& curve, const F2& derivative,
+        const Rule& rule=Rule{})
+    /// Compute `curve` and `derivative` at the knots of `rule`.
     -> Sampling_points<decltype(curve(start))>
 {
-    const gsl::Gauss_Legendre g{points};
+    const auto knots{generate_knots(start,end,points,rule)};
     Sampling_points<decltype(curve(start))> result(points);
     for (std::size_t i{0}; i<points; ++i) {
-        const auto p{g.point(start,end,i)};
+        const auto& p{knots[i]};
         result[i] =
             std::make_tuple(curve(p.first),p.second,derivative(p.first));
     }
@@ -58,8 +131,9 @@ auto knots_along_curve(double start, double end,
 
 template<typename F1, typename F2>
 auto knots_along_piecewise_curve(std::vector<double> boundaries,
-        std::vector<std::size_t> points, const F1& curve, const F2& derivative)
-    /// @brief Compute `curve` and `derivative` at Gauss-Legendre knots for a
+        std::vector<std::size_t> points, const F1& curve, const F2& derivative,
+        const std::vector<Rule>& rules)
+    /// @brief Compute `curve` and `derivative` at the knots of `rules` for a
     /// piecewise defined curve.
     ///
     /// @param boundaries cf. `Curve::boundaries()`
@@ -67,14 +141,17 @@ auto knots_along_piecewise_curve(std::vector<double> boundaries,
     /// of the) curve.
     /// @param curve the curve
     /// @param derivative the derivative of the curve
+    /// @param rules the rule applied on each segment
     -> Sampling_points<decltype(curve(decltype(boundaries)::value_type{}))>
 {
     if (boundaries.size() != points.size()+1)
         throw std::invalid_argument{"Each segment requires a number of knots."};
+    if (rules.size() != points.size())
+        throw std::invalid_argument{"Each segment requires a rule."};
     Sampling_points<decltype(curve(decltype(boundaries)::value_type{}))> result;
     for (std::size_t i{0}; i<points.size(); ++i) {
         auto segment{knots_along_curve(boundaries[i],boundaries[i+1],
-                points[i],curve,derivative)};
+                points[i],curve,derivative,rules[i])};
         result.insert(result.cend(),
                 std::make_move_iterator(segment.begin()),
                 std::make_move_iterator(segment.end()));
@@ -82,6 +159,18 @@ auto knots_along_piecewise_curve(std::vector<double> boundaries,
     return result;
 }
 
+template<typename F1, typename F2>
+auto knots_along_piecewise_curve(std::vector<double> boundaries,
+        std::vector<std::size_t> points, const F1& curve, const F2& derivative,
+        const Rule& rule=Rule{})
+    /// Same as above, but with the same rule on each segment.
+    -> Sampling_points<decltype(curve(decltype(boundaries)::value_type{}))>
+{
+    const std::vector<Rule> rules(points.size(),rule);
+    return knots_along_piecewise_curve(boundaries,points,curve,derivative,
+            rules);
+}
+
 template<typename T>
 std::vector<size_t> evenly_spaced(const T& curve, double x_step)
     /// @brief Return the number of knots needed on each segment of `curve`
@@ -141,6 +230,14 @@ struct Curve {
         ///< Evaluate the curve at `x`.
     virtual Complex derivative_func(double x) const=0;
         ///< Evaluate the derivative of the curve at `x`.
+    virtual void evaluate(const double* first, const double* last,
+            Complex* values, Complex* derivatives) const;
+        ///< @brief Evaluate the curve and its derivative at all parameter
+        ///< values in [`first`,`last`).
+        ///<
+        ///< The default calls `curve_func` and `derivative_func` for each
+        ///< value, curves may override this to evaluate entire quadrature
+        ///< rules without the virtual calls per point.
     virtual Segment hits(const Complex& s) const=0;
         ///< @brief Determine whether `s` hits the curve.
         ///<
@@ -168,28 +265,48 @@ struct Curve {
         ///<    curve_func(boundaries()[2]) == C
         ///<
         ///< See also the free function `boundary_points`.
+    virtual bool is_linear() const {return false;}
+        ///< @brief Return true if the curve is a polygon, whose segments are
+        ///< all parametrised linearly.
+        ///<
+        ///< This allows for dispersive integrals along the curve in closed
+        ///< form.
 };
 
 std::vector<Complex> boundary_points(const Curve& c);
     ///< Return the boundary points of a curve.
 
+Sampling_points<Complex> sample_curve(const Curve& c,
+        const std::vector<double>& boundaries,
+        const std::vector<std::size_t>& points, const std::vector<Rule>& rules);
+    ///< @brief Same as `knots_along_piecewise_curve`, but the curve is
+    ///< evaluated at the knots of each segment at once (cf. `Curve::evaluate`).
+
 template<typename T>
 /// A grid in the (x,z)-plane.
 
-/// The z-values are independent of the x-values, that is, for each x-value,
-/// the corresponding z-values are the same. The x-values can be specified by
-/// an arbitrary curve in the complex plane, while the z-values are straight
-/// lines from -1 to 1.
+/// The z-values depend on the x-values only via the panel of the x-value, that
+/// is, for all x-values on the same panel, the corresponding z-values are the
+/// same. The x-values can be specified by an arbitrary curve in the complex
+/// plane, while the z-values are straight lines from -1 to 1.
 /// This class acts like a decorator for a `Curve` that describes a curve in
 /// the x-plane. While the `Curve` is a continuous parametrisation, a `Grid`
 /// allows on top of this for discrete sampling with Gauss-Legendre weights.
 class Grid : public std::enable_if_t<std::is_base_of<Curve,T>::value,T> {
 public:
-    Grid(const T& t, std::vector<std::size_t> x_sizes, std::size_t z_size);
+    Grid(const T& t, std::vector<std::size_t> x_sizes, std::size_t z_size,
+            const Rule& rule=Rule{});
         ///< @param t The continuous curve in the x-plane.
         ///< @param x_sizes The number of knots along the (different segements
         ///< of the) curve in the x-plane.
         ///< @param z_size The number of knots along the line in the z-plane.
+        ///< @param rule The rule used in the x-plane (cf. `Rule::z_rule` for
+        ///< the z-plane).
+
+    Grid(const T& t, std::vector<std::size_t> x_sizes,
+            std::vector<std::size_t> z_sizes, const Rule& rule=Rule{});
+        ///< @brief Same as above, but with `z_sizes[k]` knots along the line
+        ///< in the z-plane for the x-values on segment k of the curve.
 
     Grid(const T& t, double x_step, std::size_t z_size);
         ///< @param t The continuous curve in the x-plane.
@@ -197,8 +314,34 @@ public:
         ///< in the x-plane.
         ///< @param z_size The number of knots along the line in the z-plane.
 
+    Grid(const T& t, std::vector<double> panels,
+            std::vector<std::size_t> x_sizes, std::size_t z_size,
+            const Rule& rule=Rule{});
+        ///< @param t The continuous curve in the x-plane.
+        ///< @param panels The parameter values bounding the intervals, on
+        ///< which separate quadrature rules are used. They need to be
+        ///< sorted and to contain all elements of `t.boundaries()`, such that
+        ///< each panel lies within a single segment of the curve.
+        ///< @param x_sizes The number of knots on each panel.
+        ///< @param z_size The number of knots along the line in the z-plane.
+        ///< @param rule The rule used on each panel.
+
+    Grid(const T& t, std::vector<double> panels,
+            std::vector<std::size_t> x_sizes,
+            std::vector<std::size_t> z_sizes, const Rule& rule=Rule{});
+        ///< @brief Same as above, but with `z_sizes[k]` knots along the line
+        ///< in the z-plane for the x-values on panel k.
+
+    Grid(const T& t, std::vector<double> panels,
+            std::vector<std::size_t> x_sizes,
+            std::vector<std::size_t> z_sizes, std::vector<Rule> rules);
+        ///< @brief Same as above, but with rule `rules[k]` on panel k, e.g.
+        ///< to treat a threshold at the start of the curve via
+        ///< `Rule::gauss_jacobi`.
+
     Point operator()(std::size_t x_index, std::size_t z_index) const;
-        ///< Return the point of the grid at the corresponding position.
+        ///< @brief Return the point of the grid at the corresponding position,
+        ///< `z_index` < `z_size(x_index)`.
     std::vector<double> x_parameter_values() const;
         ///< @brief Return the parameter values at which the curve in the
         ///< x-plane is evaluated at according to the Gauss-Legendre method.
@@ -206,12 +349,59 @@ public:
         ///< Return the x-value correspoding to `x_index`.
     Complex derivative(std::size_t x_index) const;
         ///< Return the derivative correspoding to `x_index`.
+    double z(std::size_t x_index, std::size_t z_index) const;
+        ///< Return the z-value correspoding to `x_index` and `z_index`.
     double z(std::size_t z_index) const;
-        ///< Return the z-value correspoding to `z_index`.
+        ///< @brief Return the z-value correspoding to `z_index`.
+        ///<
+        ///< Requires the same z-values for all x-values (cf.
+        ///< `is_z_uniform`).
     std::size_t x_size() const noexcept;
         ///< Return the number of knots along the curve in the x-plane.
-    std::size_t z_size() const noexcept;
-        ///< Return the number of knots along the line in the z-plane.
+    std::size_t z_size(std::size_t x_index) const;
+        ///< Return the number of knots in the z-plane for `x_index`.
+    std::size_t z_size() const;
+        ///< @brief Return the number of knots along the line in the z-plane.
+        ///<
+        ///< Requires the same z-values for all x-values (cf.
+        ///< `is_z_uniform`).
+    bool is_z_uniform() const noexcept;
+        ///< Return true if the z-values are the same for all x-values.
+    std::size_t size() const noexcept;
+        ///< Return the total number of points of the grid.
+    std::size_t index(std::size_t x_index, std::size_t z_index) const;
+        ///< @brief Return the position of a point in vectors containing all
+        ///< points of the grid.
+        ///<
+        ///< The points are ordered by x-values first and z-values second.
+    const std::vector<double>& panel_boundaries() const noexcept;
+        ///< @brief Return the parameter values bounding the panels of
+        ///< Gauss-Legendre knots in the x-plane.
+        ///<
+        ///< Unless specified otherwise on construction, the panels are the
+        ///< segments of the curve, i.e. this equals `boundaries()`.
+    const std::vector<std::size_t>& panel_sizes() const noexcept;
+        ///< Return the number of knots on each panel.
+    const std::vector<std::size_t>& panel_z_sizes() const noexcept;
+        ///< @brief Return the number of knots in the z-plane for the x-values
+        ///< of each panel.
+    const std::vector<Rule>& panel_rules() const noexcept;
+        ///< Return the rule used on each panel.
+    bool uses(Quadrature quadrature) const noexcept;
+        ///< Return true if `quadrature` is used on all panels.
+    Grid refined() const;
+        ///< @brief Return the grid with 2n+1 instead of n knots on each panel
+        ///< and along each line in the z-plane.
+        ///<
+        ///< This requires a nested rule, i.e. `Quadrature::fejer` on all
+        ///< panels. All points
+        ///< of this grid are points of the refined grid, cf.
+        ///< `refined_x_index` and `refined_z_index`.
+    std::size_t refined_x_index(std::size_t x_index) const;
+        ///< Return the index of the x-value `x_index` in `refined()`.
+    constexpr static std::size_t refined_z_index(std::size_t z_index)
+        {return 2*z_index+1;}
+        ///< Return the index of the z-value `z_index` in `refined()`.
     double x_parameter_lower() const noexcept;
         ///< @brief Return the parameter corresponding to the beginning of the
         ///< curve in the x-plane.
@@ -224,25 +414,86 @@ private:
 
     double _x_lower;
     double _x_upper;
+    std::vector<double> panels;
     std::vector<size_t> x_sizes;
+    std::vector<size_t> z_sizes;
+    std::vector<Rule> rules;
     Sampling_points<Complex> x_knots;
-    Knots z_knots;
+    std::vector<Knots> z_knots;
+        // the knots in the z-plane for each panel
+    std::vector<std::size_t> x_panels;
+        // the panel of each x-value
+    std::vector<std::size_t> offsets;
+        // the points with x-value i have indices in [offsets[i],offsets[i+1])
+
+    const Knots& z_knots_uniform() const;
 };
 
 template<typename T>
-Grid<T>::Grid(const T& t, std::vector<std::size_t> x_sizes, std::size_t z_size)
+Grid<T>::Grid(const T& t, std::vector<std::size_t> x_sizes, std::size_t z_size,
+        const Rule& rule)
+    : Grid{t,t.boundaries(),x_sizes,z_size,rule}
+{
+}
+
+template<typename T>
+Grid<T>::Grid(const T& t, std::vector<std::size_t> x_sizes,
+        std::vector<std::size_t> z_sizes, const Rule& rule)
+    : Grid{t,t.boundaries(),x_sizes,z_sizes,rule}
+{
+}
+
+template<typename T>
+Grid<T>::Grid(const T& t, std::vector<double> panels,
+        std::vector<std::size_t> x_sizes, std::size_t z_size,
+        const Rule& rule)
+    : Grid{t,panels,x_sizes,std::vector<std::size_t>(x_sizes.size(),z_size),
+        rule}
+{
+}
+
+template<typename T>
+Grid<T>::Grid(const T& t, std::vector<double> panels,
+        std::vector<std::size_t> x_sizes, std::vector<std::size_t> z_sizes,
+        const Rule& rule)
+    : Grid{t,panels,x_sizes,z_sizes,std::vector<Rule>(x_sizes.size(),rule)}
+{
+}
+
+template<typename T>
+Grid<T>::Grid(const T& t, std::vector<double> panels,
+        std::vector<std::size_t> x_sizes, std::vector<std::size_t> z_sizes,
+        std::vector<Rule> rules)
     : T{t},
     _x_lower{t.boundaries().front()},
     _x_upper{t.boundaries().back()},
+    panels{panels},
     x_sizes{x_sizes},
-    x_knots{
-        knots_along_piecewise_curve(
-                t.boundaries(),
-                x_sizes,
-                [t](const auto x) {return t.curve_func(x);},
-                [t](const auto x) {return t.derivative_func(x);})},
-    z_knots{generate_knots(z_lower,z_upper,z_size)}
+    z_sizes{z_sizes},
+    rules{rules},
+    x_knots{sample_curve(t,panels,x_sizes,rules)},
+    offsets{0}
 {
+    if (z_sizes.size()!=x_sizes.size())
+        throw std::invalid_argument{"Each panel requires a number of knots \
+in the z-plane."};
+    for (std::size_t p{0}; p<z_sizes.size(); ++p) {
+        z_knots.push_back(
+                generate_knots(z_lower,z_upper,z_sizes[p],rules[p].z_rule()));
+        for (std::size_t i{0}; i<x_sizes[p]; ++i) {
+            x_panels.push_back(p);
+            offsets.push_back(offsets.back()+z_sizes[p]);
+        }
+    }
+
+    const auto boundaries{t.boundaries()};
+    if (std::adjacent_find(panels.cbegin(),panels.cend(),
+                std::greater_equal<double>{})!=panels.cend()
+            || panels.front()!=_x_lower || panels.back()!=_x_upper
+            || !std::includes(panels.cbegin(),panels.cend(),
+                boundaries.cbegin(),boundaries.cend()))
+        throw std::invalid_argument{"The panels need to be sorted and \
+to refine the segments of the curve."};
 }
 
 template<typename T>
@@ -256,7 +507,7 @@ template<typename T>
 Point Grid<T>::operator()(std::size_t i, std::size_t j) const
 {
     const auto x{x_knots[i]};
-    const auto z{z_knots[j]};
+    const auto z{z_knots[x_panels[i]][j]};
     return {std::get<0>(x),std::get<1>(x),std::get<2>(x),z.first,z.second};
 }
 
@@ -265,7 +516,7 @@ std::vector<double> Grid<T>::x_parameter_values() const
 {
     const auto identity{[](double x){return x;}};
     auto knots{
-        knots_along_piecewise_curve(T::boundaries(),x_sizes,identity,identity)};
+        knots_along_piecewise_curve(panels,x_sizes,identity,identity,rules)};
     std::vector<double> result(x_size());
     std::transform(knots.cbegin(),knots.cend(),result.begin(),
             [](const auto& t){return std::get<0>(t);});
@@ -284,10 +535,16 @@ Complex Grid<T>::derivative(std::size_t x_index) const
     return std::get<2>(x_knots[x_index]);
 }
 
+template<typename T>
+double Grid<T>::z(std::size_t x_index, std::size_t z_index) const
+{
+    return z_knots[x_panels[x_index]][z_index].first;
+}
+
 template<typename T>
 double Grid<T>::z(std::size_t z_index) const
 {
-    return z_knots[z_index].first;
+    return z_knots_uniform()[z_index].first;
 }
 
 template<typename T>
@@ -297,9 +554,97 @@ std::size_t Grid<T>::x_size() const noexcept
 }
 
 template<typename T>
-std::size_t Grid<T>::z_size() const noexcept
+std::size_t Grid<T>::z_size(std::size_t x_index) const
 {
-    return z_knots.size();
+    return z_sizes[x_panels[x_index]];
+}
+
+template<typename T>
+std::size_t Grid<T>::z_size() const
+{
+    return z_knots_uniform().size();
+}
+
+template<typename T>
+bool Grid<T>::is_z_uniform() const noexcept
+{
+    return std::adjacent_find(z_sizes.cbegin(),z_sizes.cend(),
+            std::not_equal_to<std::size_t>{})==z_sizes.cend();
+}
+
+template<typename T>
+std::size_t Grid<T>::size() const noexcept
+{
+    return offsets.back();
+}
+
+template<typename T>
+std::size_t Grid<T>::index(std::size_t x_index, std::size_t z_index) const
+{
+    return offsets[x_index]+z_index;
+}
+
+template<typename T>
+const Knots& Grid<T>::z_knots_uniform() const
+{
+    if (!is_z_uniform())
+        throw std::logic_error{"The number of knots in the z-plane differs \
+between panels."};
+    return z_knots.front();
+}
+
+template<typename T>
+const std::vector<double>& Grid<T>::panel_boundaries() const noexcept
+{
+    return panels;
+}
+
+template<typename T>
+const std::vector<std::size_t>& Grid<T>::panel_sizes() const noexcept
+{
+    return x_sizes;
+}
+
+template<typename T>
+const std::vector<std::size_t>& Grid<T>::panel_z_sizes() const noexcept
+{
+    return z_sizes;
+}
+
+template<typename T>
+const std::vector<Rule>& Grid<T>::panel_rules() const noexcept
+{
+    return rules;
+}
+
+template<typename T>
+bool Grid<T>::uses(Quadrature quadrature) const noexcept
+{
+    return std::all_of(rules.cbegin(),rules.cend(),
+            [quadrature](const Rule& r){return r.quadrature()==quadrature;});
+}
+
+template<typename T>
+Grid<T> Grid<T>::refined() const
+{
+    if (!uses(Quadrature::fejer))
+        throw std::logic_error{"Only grids using nested quadrature rules can \
+be refined."};
+    const auto refine{[](std::vector<std::size_t> sizes)
+        {
+            for (auto& n: sizes)
+                n = 2*n+1;
+            return sizes;
+        }};
+    return Grid{static_cast<const T&>(*this),panels,refine(x_sizes),
+        refine(z_sizes),rules};
+}
+
+template<typename T>
+std::size_t Grid<T>::refined_x_index(std::size_t x_index) const
+{
+    // Each of the preceding panels gains one more knot than it had before.
+    return 2*x_index+x_panels[x_index]+1;
 }
 
 template<typename T>
@@ -323,6 +668,70 @@ Grid<T> make_grid(const T& t, std::vector<std::size_t> x_sizes,
             "T needs to inherit from Curve");
     return Grid<T>{t,x_sizes,z_size};
 }
+
+double legendre_tail(const Complex* values, std::size_t size);
+    ///< @brief Return the larger modulus of the last two coefficients of the
+    ///< Legendre series interpolating `values`, given at the knots of a
+    ///< `gsl::Gauss_Legendre` rule with `size` points.
+    ///<
+    ///< This estimates the error of the interpolation, `size` needs to be at
+    ///< least 2.
+
+template<typename T, typename F>
+std::vector<double> refine_panels(const T& curve, std::vector<double> panels,
+        std::size_t order, std::size_t z_size, double tolerance,
+        std::size_t max_sweeps, const F& sample)
+    /// @brief Bisect the panels of a grid along `curve` until the sampled
+    /// functions are resolved to `tolerance` and return the final panels.
+    ///
+    /// @param panels the initial panels (cf. `Grid`)
+    /// @param order the number of knots on each panel
+    /// @param z_size the number of knots along the line in the z-plane
+    /// @param tolerance the tolerance for the error estimate of each panel,
+    /// i.e. the tail of the Legendre series on the panel (cf.
+    /// `legendre_tail`) times the chord of the panel relative to the sum of
+    /// the chords of all panels, relative to the largest modulus of the
+    /// function on the grid
+    /// @param max_sweeps the maximal number of refinements
+    /// @param sample maps a `Grid<T>` to a vector of functions, each given by
+    /// its values at the values of x of the grid
+{
+    if (order<2)
+        throw std::invalid_argument{"refine_panels requires at least two \
+knots per panel"};
+    for (std::size_t sweep{0}; sweep<max_sweeps; ++sweep) {
+        const std::size_t n{panels.size()-1};
+        const Grid<T> g{curve,panels,std::vector<std::size_t>(n,order),z_size};
+        // the length of the curve is approximated by the sum of the chords
+        std::vector<double> lengths(n);
+        for (std::size_t p{0}; p<n; ++p)
+            lengths[p] = std::abs(curve.curve_func(panels[p+1])
+                    -curve.curve_func(panels[p]));
+        const double total_length{std::accumulate(lengths.cbegin(),
+                lengths.cend(),0.0)};
+        std::vector<bool> split(n,false);
+        for (const auto& f: sample(g)) {
+            double scale{0.0};
+            for (const auto& value: f)
+                scale = std::max(scale,std::abs(value));
+            for (std::size_t p{0}; p<n; ++p) {
+                const double tail{legendre_tail(f.data()+p*order,order)};
+                if (tail*lengths[p]>tolerance*scale*total_length)
+                    split[p] = true;
+            }
+        }
+        if (std::none_of(split.cbegin(),split.cend(),[](bool b){return b;}))
+            return panels;
+        std::vector<double> refined{panels.front()};
+        for (std::size_t p{0}; p<n; ++p) {
+            if (split[p])
+                refined.push_back(0.5*(panels[p]+panels[p+1]));
+            refined.push_back(panels[p+1]);
+        }
+        panels = std::move(refined);
+    }
+    throw std::runtime_error{"refine_panels did not reach the tolerance"};
+}
 } // grid
 
 #endif // KERNEL_GRID_H
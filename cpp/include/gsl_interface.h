@@ -1,16 +1,20 @@
 #ifndef GSL_INTERFACE_H
 #define GSL_INTERFACE_H
 
+#include "facilities.h"
+
 #include "gsl/gsl_integration.h"
 #include "gsl/gsl_errno.h"
 #include "gsl/gsl_spline.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <stdexcept>
 #include <string>
@@ -22,6 +26,9 @@
 namespace gsl {
 using Value = std::pair<double,double>; // a value and its error
 using Function = std::function<double(double)>;
+using Batch_function = std::function<std::vector<double>(
+        const std::vector<double>&)>;
+    // evaluates a function elementwise at many abscissae at once
 
 /// By representing intervals used e.g. for interpolation in this way, the user
 /// can choose regions with dense sampling and ones with coarse sampling.
@@ -137,6 +144,25 @@ struct Integration {
         ///< Both `lower` and `upper` are allowed to be infinity
         ///< (use e.g. `std::numeric_limits<double>::infinity()`).
 
+    virtual Value batch(const Batch_function& f, double lower, double upper)
+        const;
+        ///< @brief Integrate the function `f` in the interval
+        ///< [`lower`,`upper`], where `f` maps a vector of abscissae to the
+        ///< vector of function values.
+        ///<
+        ///< Routines with fixed sets of abscissae per subinterval call `f`
+        ///< once per subinterval or rule. By default, `f` is called with a
+        ///< single abscissa at a time.
+
+    virtual Value operator()(Function f, const Interval& points) const;
+        ///< @brief Integrate the function `f` in the interval
+        ///< [`points.front()`,`points.back()`].
+        ///<
+        ///< The inner elements of `points` mark known non-smooth points of
+        ///< `f`, e.g. kinks or the boundaries of curve segments. `points`
+        ///< needs to contain at least two elements. By default, the
+        ///< subintervals are integrated separately and the results summed.
+
     virtual ~Integration() {}
 };
 
@@ -278,6 +304,12 @@ struct Settings {
     double absolute_precision{0.0};
     double relative_precision{1e-7};
     std::size_t space{1000};
+    double lower_exponent{0.5};
+        ///< Algebraic behaviour of the integrand at the lower end of the
+        ///< interval (only used by `Gauss_Jacobi`).
+    double upper_exponent{0.0};
+        ///< Algebraic behaviour of the integrand at the upper end of the
+        ///< interval (only used by `Gauss_Jacobi`).
 };
 
 /// @brief Integration of one function or multiple functions using GSL CQUAD
@@ -295,6 +327,7 @@ public:
     Cquad& operator=(Cquad&&)=default;
     ~Cquad() noexcept {}
 
+    using Integration::operator();
     Value operator()(Function f, double lower, double upper) const override;
 
     void reserve(std::size_t space);
@@ -327,6 +360,8 @@ public:
     ~Qag() noexcept {}
 
     Value operator()(Function f, double lower, double upper) const override;
+    Value operator()(Function f, const Interval& points) const override;
+        ///< Use GSL QAGP for finite intervals.
 
     void reserve(std::size_t space);
         // Change the size of the workspace used by the gsl integration
@@ -344,6 +379,209 @@ private:
     Qag_workspace workspace;
 };
 
+/// @brief Integration via double-exponential (tanh-sinh) quadrature.
+///
+/// The substitution x = tanh(pi/2 sinh(t)) clusters the abscissae doubly
+/// exponentially at both ends of the interval. Hence, integrands with
+/// algebraic endpoint behaviour (e.g. square roots at a threshold) are
+/// integrated without any subdivision. The step size in t is halved until two
+/// successive levels agree within the requested precision.
+class Tanh_sinh : public Integration {
+public:
+    Tanh_sinh(const Settings& set=Settings{});
+        ///< If `absolute_precision` is set to zero, `relative_precision` is
+        ///< used and vice versa. `space` denotes the maximal number of
+        ///< function evaluations.
+
+    using Integration::operator();
+    Value operator()(Function f, double lower, double upper) const override;
+    Value batch(const Batch_function& f, double lower, double upper) const
+        override;
+        ///< The abscissae of each level are passed to `f` at once.
+
+    void reserve(std::size_t space) noexcept {evaluations = space;}
+        ///< Change the maximal number of function evaluations.
+    void set_absolute(double abs) noexcept {absolute_precision = abs;}
+    void set_relative(double rel) noexcept {relative_precision = rel;}
+
+    double absolute() const noexcept {return absolute_precision;}
+    double relative() const noexcept {return relative_precision;}
+    std::size_t size() const noexcept {return evaluations;}
+private:
+    double absolute_precision;
+    double relative_precision;
+    std::size_t evaluations;
+};
+
+/// Deleter needed for fixed quadrature rules.
+struct Fixed_deleter {
+    void operator()(gsl_integration_fixed_workspace* p)
+    {
+        gsl_integration_fixed_free(p);
+    }
+};
+
+/// @brief Integration via Gauss-Jacobi quadrature for integrands with a known
+/// algebraic behaviour at the endpoints.
+///
+/// The integrand is assumed to behave like (x-`lower`)^`lower_exponent` and
+/// (`upper`-x)^`upper_exponent` at the ends of the interval. These factors are
+/// absorbed into the weight function of the rule, such that the remainder is
+/// smooth. The number of points is doubled until two successive rules agree
+/// within the requested precision.
+class Gauss_Jacobi : public Integration {
+public:
+    Gauss_Jacobi(const Settings& set=Settings{});
+        ///< If `absolute_precision` is set to zero, `relative_precision` is
+        ///< used and vice versa. `space` denotes the maximal number of
+        ///< points of a single rule. Both exponents need to exceed -1.
+
+    Value operator()(Function f, double lower, double upper) const override;
+    Value operator()(Function f, const Interval& points) const override;
+        ///< The endpoint behaviour is only applied to the outermost
+        ///< subintervals, the inner subintervals use Gauss-Legendre rules.
+    Value batch(const Batch_function& f, double lower, double upper) const
+        override;
+        ///< The nodes of each rule are passed to `f` at once.
+
+    void reserve(std::size_t space) noexcept {maximal_size = space;}
+        ///< Change the maximal number of points of a single rule.
+    void set_absolute(double abs) noexcept {absolute_precision = abs;}
+    void set_relative(double rel) noexcept {relative_precision = rel;}
+
+    double absolute() const noexcept {return absolute_precision;}
+    double relative() const noexcept {return relative_precision;}
+    double lower_exponent() const noexcept {return exponent_lower;}
+    double upper_exponent() const noexcept {return exponent_upper;}
+    std::size_t size() const noexcept {return maximal_size;}
+private:
+    /// Nodes and weights on [-1,1], the weights are already divided by the
+    /// weight function.
+    struct Rule {
+        std::vector<double> nodes;
+        std::vector<double> weights;
+    };
+
+    /// Rules with 8, 16, 32, ... points for one pair of exponents.
+    struct Family {
+        double lower;
+        double upper;
+        std::vector<Rule> rules;
+    };
+
+    constexpr static std::size_t smallest_rule{8};
+
+    double absolute_precision;
+    double relative_precision;
+    double exponent_lower;
+    double exponent_upper;
+    std::size_t maximal_size;
+    mutable std::vector<Family> families;
+        // The rules are computed on first use.
+
+    const Rule& rule(double at_lower, double at_upper, std::size_t level)
+        const;
+        // Return the rule with `smallest_rule`*2^`level` points for the
+        // exponents `at_lower` and `at_upper`.
+    Value integrate(const Batch_function& f, double lower, double upper,
+            double at_lower, double at_upper) const;
+        // Integrate `f` in [`lower`,`upper`] for the exponents `at_lower` and
+        // `at_upper`.
+};
+
+/// @brief Adaptive Gauss-Kronrod (G7K15) integration starting from the
+/// subdivision found in a previous call on the same interval.
+///
+/// Sequences of nearby integrals, e.g. scans along Mandelstam s, need
+/// almost the same subdivision. Hence, the final partition of every interval
+/// is cached. The next integration on that interval refines the cached
+/// partition where needed, while neighbouring subintervals with negligible
+/// errors are merged before the partition is stored again. The error of each
+/// subinterval is estimated as in QUADPACK's qk15. Due to the cache, a single
+/// instance must not be used by multiple threads at once.
+class Warm_start : public Integration {
+public:
+    Warm_start(const Settings& set=Settings{});
+        ///< If `absolute_precision` is set to zero, `relative_precision` is
+        ///< used and vice versa. `space` denotes the maximal number of
+        ///< subintervals.
+
+    using Integration::operator();
+    Value operator()(Function f, double lower, double upper) const override;
+    Value batch(const Batch_function& f, double lower, double upper) const
+        override;
+        ///< The 15 abscissae of each subinterval are passed to `f` at once.
+
+    void reserve(std::size_t space) noexcept {limit = space;}
+        ///< Change the maximal number of subintervals.
+    void clear() noexcept {partitions.clear();}
+        ///< Forget all cached partitions.
+    void set_absolute(double abs) noexcept {absolute_precision = abs;}
+    void set_relative(double rel) noexcept {relative_precision = rel;}
+
+    double absolute() const noexcept {return absolute_precision;}
+    double relative() const noexcept {return relative_precision;}
+    std::size_t size() const noexcept {return limit;}
+private:
+    /// The subdivision of [`lower`,`upper`] found in the last integration.
+    struct Partition {
+        double lower;
+        double upper;
+        std::vector<double> points;
+    };
+
+    constexpr static std::size_t cached_intervals{16};
+
+    double absolute_precision;
+    double relative_precision;
+    std::size_t limit;
+    mutable std::vector<Partition> partitions;
+        // The least recently created partition is dropped first.
+
+    std::vector<double>& partition(double lower, double upper,
+            double mapped_lower, double mapped_upper) const;
+        // Return the cached partition of [`lower`,`upper`]. If there is none,
+        // create one consisting of [`mapped_lower`,`mapped_upper`] only.
+};
+
+// -- Integration: principal values -------------------------------------------
+
+/// @brief Cauchy principal value integration using the GSL QAWC routine.
+///
+/// The singular factor 1/(x-`singularity`) is absorbed into the weight
+/// function of the rule (modified Clenshaw-Curtis close to the singularity).
+/// Hence, no subtraction of the integrand at the singularity is needed.
+class Principal_value {
+public:
+    Principal_value(const Settings& set=Settings{});
+        ///< If `absolute_precision` is set to zero, `relative_precision` is
+        ///< used and vice versa. `space` denotes the size of the workspace
+        ///< used by the gsl integration routine.
+
+    Value operator()(Function f, double lower, double upper,
+            double singularity) const;
+        ///< @brief Compute the principal value of the integral of
+        ///< `f`(x)/(x-`singularity`) in the interval [`lower`,`upper`].
+        ///<
+        ///< Both `lower` and `upper` need to be finite. `singularity` must not
+        ///< coincide with one of them.
+
+    void reserve(std::size_t space);
+        ///< Change the size of the workspace used by the gsl integration
+        ///< routine.
+    void set_absolute(double abs) noexcept {absolute_precision = abs;}
+    void set_relative(double rel) noexcept {relative_precision = rel;}
+
+    double absolute() const noexcept {return absolute_precision;}
+    double relative() const noexcept {return relative_precision;}
+    std::size_t size() const noexcept {return workspace.size();}
+private:
+    double absolute_precision;
+    double relative_precision;
+    std::size_t limit;
+    Qag_workspace workspace;
+};
+
 // -- Interpolation -----------------------------------------------------------
 
 /// @brief These methods can be used by the interpolation routine accessed via
@@ -397,6 +635,12 @@ public:
         ///< the interpolator works only for values in the interval
         ///< [`front()`,`back()`]. In this case, evaluation outside the interval
         ///< will throw.
+    std::vector<double> operator()(const std::vector<double>& x) const;
+        ///< @brief Return the values of the (interpolated) data at all
+        ///< elements of `x`.
+        ///<
+        ///< The accelerator starts the lookup of each element at the
+        ///< interval of the previous one, which is fastest if `x` is sorted.
 
     double front() const noexcept {return x_data.front();}
     double back() const noexcept {return x_data.back();}
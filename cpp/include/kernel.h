@@ -10,10 +10,13 @@
 #include "mandelstam.h"
 #include "omnes.h"
 #include "phase_space.h"
+#include "rational.h"
+#include "spline.h"
 #include "type_aliases.h"
 
 #include "Eigen/Dense"
 
+#include <algorithm>
 #include <functional>
 #include <iterator>
 #include <limits>
@@ -39,47 +42,203 @@ using grid::Point;
 using Matrix =
     Eigen::Matrix<Complex,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
 using Vector = Eigen::VectorXcd;
+using Real_matrix =
+    Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
+using facilities::power;
 using facilities::square;
 using helpers::hits_threshold_m;
 using type_aliases::CFunction;
+using type_aliases::CBatch_function;
 
-constexpr inline std::size_t index(std::size_t x_index, std::size_t z_index,
-        std::size_t z_size)
-    /// Convert from two-dimensional to one-dimensional indices.
+template<typename T>
+inline double angular(const Grid<T>& g, std::size_t x_index,
+        std::size_t z_index)
+    /// Compute angular contribution at given point of grid.
 {
-    return x_index*z_size + z_index;
+    return 1.0-square(g.z(x_index,z_index));
 }
 
+/// @brief The points of a grid together with Mandelstam t, for a fixed pion
+/// mass and virtuality.
+///
+/// All quantities needed to set up the KT equations are computed once and
+/// stored in contiguous arrays. Quantities depending on z are stored for all
+/// points, ordered as in `Grid::index`.
+class Kinematic_grid {
+public:
+    template<typename T>
+    Kinematic_grid(const Grid<T>& g, double pion_mass, double virtuality);
+
+    std::size_t x_size() const noexcept {return _x.size();}
+    std::size_t size() const noexcept {return _t.size();}
+        ///< Return the total number of points.
+    std::size_t z_size(std::size_t x_index) const noexcept
+        {return _offsets[x_index+1]-_offsets[x_index];}
+    std::size_t index(std::size_t x_index, std::size_t z_index) const noexcept
+        {return _offsets[x_index]+z_index;}
+        ///< Return the position of a point in the arrays below.
+    double pion_mass() const noexcept {return _pion_mass;}
+    double virtuality() const noexcept {return _virtuality;}
+
+    const std::vector<Complex>& x() const noexcept {return _x;}
+    const std::vector<double>& x_weights() const noexcept
+        {return _x_weights;}
+    const std::vector<Complex>& x_derivatives() const noexcept
+        {return _x_derivatives;}
+    const std::vector<std::size_t>& offsets() const noexcept
+        {return _offsets;}
+        ///< @brief The points with x-value `x()[j]` are those in
+        ///< [`offsets()[j]`,`offsets()[j+1]`).
+    const std::vector<double>& z() const noexcept {return _z;}
+    const std::vector<double>& z_weights() const noexcept
+        {return _z_weights;}
+    const std::vector<double>& angular() const noexcept {return _angular;}
+        ///< Return the angular contributions (cf. `angular`).
+    const std::vector<Complex>& t() const noexcept {return _t;}
+        ///< Return Mandelstam t at all points of the grid.
+private:
+    double _pion_mass;
+    double _virtuality;
+    std::vector<Complex> _x;
+    std::vector<double> _x_weights;
+    std::vector<Complex> _x_derivatives;
+    std::vector<std::size_t> _offsets;
+    std::vector<double> _z;
+    std::vector<double> _z_weights;
+    std::vector<double> _angular;
+    std::vector<Complex> _t;
+};
+
 template<typename T>
-inline double angular(const Grid<T>& g, std::size_t z_index)
-    /// Compute angular contribution at given point of grid.
+Kinematic_grid::Kinematic_grid(const Grid<T>& g, double pion_mass,
+        double virtuality)
+    : _pion_mass{pion_mass},
+    _virtuality{virtuality},
+    _x(g.x_size()),
+    _x_weights(g.x_size()),
+    _x_derivatives(g.x_size()),
+    _offsets(g.x_size()+1),
+    _z(g.size()),
+    _z_weights(g.size()),
+    _angular(g.size()),
+    _t(g.size())
 {
-    return 1.0-square(g.z(z_index));
+    const std::size_t n_x{g.x_size()};
+    for (std::size_t i{0}; i<n_x; ++i) {
+        _offsets[i] = g.index(i,0);
+        _offsets[i+1] = _offsets[i]+g.z_size(i);
+        for (std::size_t a{0}; a<g.z_size(i); ++a) {
+            const auto& point{g(i,a)};
+            const auto k{_offsets[i]+a};
+            _z[k] = point.z;
+            _z_weights[k] = point.z_weight;
+            _angular[k] = kernel::angular(g,i,a);
+            _t[k] = mandelstam::t_photon_pion(point.x,point.z,pion_mass,
+                    virtuality);
+        }
+        const auto& point{g(i,0)};
+        _x[i] = point.x;
+        _x_weights[i] = point.x_weight;
+        _x_derivatives[i] = point.x_derivative;
+    }
 }
 
-template<typename T>
-Complex t_at(const Grid<T>& g, std::size_t x_index,
-        std::size_t z_index, double pion_mass, double virtuality)
-    /// Evaluate Mandelstam t at a given point of a grid.
+template<typename F>
+Vector sample_on_grid(const F& f, const Kinematic_grid& g)
+    /// Sample `f` at values of Mandelstam t on grid `g`.
 {
-    const auto p{g(x_index,z_index)};
-    return mandelstam::t_photon_pion(p.x,p.z,pion_mass,virtuality);
+    const auto& t{g.t()};
+    Vector result(t.size());
+    for (std::size_t k{0}; k<t.size(); ++k)
+        result(k) = f(t[k]);
+    return result;
 }
 
+Vector sample_on_grid(const CurvedOmnes& o, const Kinematic_grid& g);
+    ///< @brief Same as above, but the sheet is determined for all values of t
+    ///< in one pass.
+
 template<typename F, typename T>
 Vector sample_on_grid(const F& f, const Grid<T>& g, double pion_mass,
         double virtuality)
     /// Sample `f` at values of Mandelstam t on grid `g`.
 {
-    const std::size_t n_x{g.x_size()};
-    const std::size_t n_z{g.z_size()};
-    Vector result(n_x*n_z);
-    for (std::size_t i{0}; i<n_x; ++i)
-        for (std::size_t a{0}; a<n_z; ++a) {
-            const Complex t{t_at(g,i,a,pion_mass,virtuality)};
-            result(index(i,a,n_z)) = f(t);
+    return sample_on_grid(f,Kinematic_grid{g,pion_mass,virtuality});
+}
+
+/// @brief The Omnes function and the pion pion scattering amplitude sampled on
+/// a grid.
+///
+/// Evaluating the Omnes function is the expensive part of setting up the KT
+/// equations. For a grid obtained via `Grid::refined`, the values at the
+/// points shared with the coarser grid are taken over instead.
+struct Grid_samples {
+    Grid_samples(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+            const Kinematic_grid& g);
+        ///< @param o the Omnes function
+        ///< @param pi_pi the pion pion scattering amplitude at the values of
+        ///< x of `g`
+        ///< @param g the grid the functions are sampled on
+
+    template<typename T>
+    Grid_samples(const CurvedOmnes& o, const CFunction& pi_pi,
+            const Kinematic_grid& fine, const Grid<T>& coarse_grid,
+            const Grid_samples& coarse);
+        ///< @brief Sample on `fine`, which needs to belong to
+        ///< `coarse_grid.refined()`, evaluating `o` and `pi_pi` only at the
+        ///< points that are not part of `coarse_grid`.
+
+    std::vector<Complex> pi_pi;
+        ///< the pion pion scattering amplitude at the values of x
+    std::vector<Complex> omnes_x;
+        ///< `o.original()` at the values of x
+    Vector omnes_t;
+        ///< `o` at the values of Mandelstam t
+};
+
+template<typename T>
+Grid_samples::Grid_samples(const CurvedOmnes& o, const CFunction& pi_pi,
+        const Kinematic_grid& fine, const Grid<T>& coarse_grid,
+        const Grid_samples& coarse)
+    : pi_pi(fine.x_size()),
+    omnes_x(fine.x_size()),
+    omnes_t(fine.size())
+{
+    if (!coarse_grid.uses(grid::Quadrature::fejer)
+            || fine.x_size()!=2*coarse_grid.x_size()
+                +coarse_grid.panel_sizes().size())
+        throw std::invalid_argument{"The fine grid needs to be the refinement \
+of the coarse grid."};
+    std::vector<bool> known_x(fine.x_size(),false);
+    std::vector<bool> known_t(fine.size(),false);
+    for (std::size_t i{0}; i<coarse_grid.x_size(); ++i) {
+        const auto j{coarse_grid.refined_x_index(i)};
+        this->pi_pi[j] = coarse.pi_pi[i];
+        omnes_x[j] = coarse.omnes_x[i];
+        known_x[j] = true;
+        for (std::size_t a{0}; a<coarse_grid.z_size(i); ++a) {
+            const auto k{fine.index(j,coarse_grid.refined_z_index(a))};
+            omnes_t(k) = coarse.omnes_t(coarse_grid.index(i,a));
+            known_t[k] = true;
         }
-    return result;
+    }
+    for (std::size_t j{0}; j<fine.x_size(); ++j) {
+        if (known_x[j])
+            continue;
+        this->pi_pi[j] = pi_pi(fine.x()[j]);
+        omnes_x[j] = o.original()(fine.x()[j]);
+    }
+    std::vector<std::size_t> unknown;
+    std::vector<Complex> t;
+    for (std::size_t k{0}; k<fine.size(); ++k) {
+        if (known_t[k])
+            continue;
+        unknown.push_back(k);
+        t.push_back(fine.t()[k]);
+    }
+    const auto values{o(t)};
+    for (std::size_t i{0}; i<unknown.size(); ++i)
+        omnes_t(unknown[i]) = values[i];
 }
 
 inline double max_distance(const Vector& a, const Vector& b)
@@ -89,68 +248,109 @@ inline double max_distance(const Vector& a, const Vector& b)
 }
 
 template<typename T>
-std::vector<Complex> generate_x_dependent(const OmnesF& o,
-    const CFunction& pi_pi,
-    const Grid<T>& g, double pion_mass, int subtractions)
-    /// Generate the x_j dependent terms needed in the integration kernel.
+std::vector<Complex> x_values(const Grid<T>& g)
+    /// Return the values of x of all points of the grid.
 {
     const std::size_t n_x{g.x_size()};
-    std::vector<Complex> x_dependent(n_x);
-    for (std::size_t j{0}; j<n_x; ++j) {
-        const auto x{g.x(j)};
-        x_dependent[j] = pi_pi(x)/o(x)*phase_space::sigma(pion_mass,x)
-            /std::pow(x,subtractions);
-    }
-    return x_dependent;
+    std::vector<Complex> result(n_x);
+    for (std::size_t j{0}; j<n_x; ++j)
+        result[j] = g.x(j);
+    return result;
 }
 
 template<typename T>
-Matrix generate_kernel(const CurvedOmnes& o, const CFunction& pi_pi,
-    const Grid<T>& g, double pion_mass, double virtuality, int subtractions)
-    /// Compute the integration kernel.
+std::vector<Complex> sample_x(const CFunction& f, const Grid<T>& g)
+    /// Sample `f` at the values of x of the grid.
 {
-    const std::size_t n_x{g.x_size()};
-    const std::size_t n_z{g.z_size()};
-    const std::size_t n{n_x*n_z};
-    Matrix result(n,n);
-
-    // x_j dependent terms
-    const std::vector<Complex> x_dependent{
-        generate_x_dependent(o.original(),pi_pi,g,pion_mass,subtractions)};
-
-    // t(x_i,z_a) dependent terms
-    std::vector<Complex> t(n);
-    std::vector<Complex> t_dependent(n);
-    for (std::size_t i{0}; i<n_x; ++i)
-        for (std::size_t a{0}; a<n_z; ++a) {
-            const std::size_t in{index(i,a,n_z)};
-            t[in] = t_at(g,i,a,pion_mass,virtuality);
-            t_dependent[in] = o(t[in])*std::pow(t[in],subtractions);
-        }
+    return facilities::vectorize(f)(x_values(g));
+}
 
-    // create the matrix
-    const double coeff{1.5/constants::pi()};
-    for (std::size_t i{0}; i<n_x; ++i)
-        for (std::size_t a{0}; a<n_z; ++a) {
-            const std::size_t in{index(i,a,n_z)};
-            const Complex t_term{t_dependent[in]};
-            for (std::size_t j{0}; j<n_x; ++j) {
-                const Complex x_term{x_dependent[j]};
-                // `cauchy` is the only term that couples columns and rows.
-                const Complex cauchy{g.x(j)-t[in]};
-                for (std::size_t b{0}; b<n_z; ++b) {
-                    const auto& point{g(j,b)};
-                    const double weight{point.x_weight*point.z_weight};
-                    result(in,index(j,b,n_z)) =
-                        coeff*x_term*t_term*weight*angular(g,b)
-                        *point.x_derivative/cauchy;
-                }
-            }
-        }
+std::vector<Complex> generate_x_dependent(const OmnesF& o,
+    const std::vector<Complex>& pi_pi, const Kinematic_grid& g,
+    int subtractions);
+    ///< @brief Generate the x_j dependent terms needed in the integration
+    ///< kernel, `pi_pi` contains the pion pion scattering amplitude at x_j.
 
-    return result;
+std::vector<Complex> generate_x_dependent(const Grid_samples& samples,
+    const Kinematic_grid& g, int subtractions);
+    ///< Same as above.
+
+Matrix generate_kernel(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+    const Kinematic_grid& g, int subtractions);
+    ///< @brief Compute the integration kernel, `pi_pi` contains the pion pion
+    ///< scattering amplitude at the values of x of the grid.
+
+Matrix generate_kernel(const Grid_samples& samples, const Kinematic_grid& g,
+    int subtractions);
+    ///< Same as above.
+
+template<typename T>
+Matrix generate_kernel(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+    const Grid<T>& g, double pion_mass, double virtuality, int subtractions)
+    /// Same as above.
+{
+    return generate_kernel(o,pi_pi,Kinematic_grid{g,pion_mass,virtuality},
+            subtractions);
 }
 
+bool is_real(const Grid_samples& samples, const Kinematic_grid& g,
+    int subtractions, double tolerance=1e-13);
+    ///< @brief Return true if the integration kernel and the inhomogeneities
+    ///< are real up to `tolerance` relative to their size.
+    ///<
+    ///< This is the case if the curve in the x-plane is real, all values of t
+    ///< lie below the threshold (e.g. for scattering kinematics) and the pion
+    ///< pion scattering amplitude has the phase of the Omnes function.
+
+Real_matrix generate_real_kernel(const Grid_samples& samples,
+    const Kinematic_grid& g, int subtractions);
+    ///< @brief Same as `generate_kernel`, but everything is computed in real
+    ///< arithmetic, i.e. the imaginary parts are dropped (cf. `is_real`).
+
+/// @brief The integration kernel applied without storing the matrix.
+///
+/// The only term of the kernel coupling rows and columns is the Cauchy kernel
+/// 1/(x_j-t(x_i,z_a)), such that applying the kernel to a vector amounts to a
+/// sum over the angular knots followed by a Cauchy sum (cf.
+/// `cauchy::Cauchy_sum`), which needs O(n) instead of O(n^2) operations for
+/// large grids. Small grids, i.e. up to about a hundred values of x, are
+/// summed directly (cf. `is_direct`).
+class Kernel_operator {
+public:
+    Kernel_operator(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+        const Kinematic_grid& g, int subtractions, double tolerance=1e-10);
+        ///< The arguments match those of `generate_kernel`, `tolerance` is
+        ///< passed on to `cauchy::Cauchy_sum`. The default lies well below
+        ///< the default accuracy of `iteration` in `basis`.
+    Kernel_operator(const Grid_samples& samples, const Kinematic_grid& g,
+        int subtractions, double tolerance=1e-10);
+        ///< Same as above.
+    template<typename T>
+    Kernel_operator(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+        const Grid<T>& g, double pion_mass, double virtuality,
+        int subtractions, double tolerance=1e-10)
+        : Kernel_operator{o,pi_pi,Kinematic_grid{g,pion_mass,virtuality},
+            subtractions,tolerance} {}
+        ///< Same as above.
+
+    Vector operator*(const Vector& v) const;
+        ///< Return the kernel applied to `v`.
+    bool is_direct() const noexcept {return cauchy_sum.is_direct();}
+        ///< Return true if the Cauchy sum is evaluated directly in O(n^2),
+        ///< because the expansion does not pay off (cf.
+        ///< `cauchy::Cauchy_sum::is_direct`).
+private:
+    std::vector<std::size_t> offsets;
+        // cf. `Kinematic_grid::offsets`
+    std::vector<Complex> x_terms;
+        // everything depending on x_j only
+    std::vector<double> z_terms;
+        // everything depending on z_b (and the panel of x_j) only
+    std::vector<Complex> t_terms;
+        // everything depending on t(x_i,z_a) only
+    cauchy::Cauchy_sum cauchy_sum;
+};
+
 Vector iteration(const Matrix& kernel, const Vector& start, double accuracy,
         facilities::On_off_stream status=facilities::On_off_stream{});
     ///< @brief Solve KT equations iteratively.
@@ -161,18 +361,38 @@ Vector iteration(const Matrix& kernel, const Vector& start, double accuracy,
     ///< @param status in verbose mode, the number of the current iteration is
     ///< printed to the specified stream
 
+Vector iteration(const Kernel_operator& kernel, const Vector& start,
+        double accuracy,
+        facilities::On_off_stream status=facilities::On_off_stream{});
+    ///< Same as above, but without storing the kernel.
+
 Vector inverse(const Matrix& kernel, const Vector& start);
     ///< @brief Solve KT equations via matrix inversion.
     ///<
     ///< @param kernel the integration kernel
     ///< @param start the Omnes function times the subtraction polynomial
 
+Vector inverse(const Real_matrix& kernel, const Vector& start);
+    ///< @brief Same as above for a real kernel, the imaginary part of `start`
+    ///< is dropped.
+
 /// The different available solution methods.
 enum class Method {
     iteration,
     inverse
 };
 
+/// @brief The different available reconstructions of the integrands of the
+/// basis functions from their values on the grid.
+enum class Reconstruction {
+    linear,
+        ///< linear interpolation in the curve parameter
+    barycentric
+        ///< @brief barycentric Lagrange interpolation on the Gauss-Legendre
+        ///< knots of each panel, which keeps the spectral accuracy of the
+        ///< rule and allows for much smaller grids
+};
+
 class Unknown_method : public std::exception {
 public:
     const char* what() const noexcept override {return message.data();}
@@ -180,15 +400,26 @@ private:
     std::string message{"Unknown method."};
 };
 
+std::vector<Vector> basis(const Grid_samples& samples,
+        const Kinematic_grid& g, int subtractions,
+        Method method=Method::inverse,
+        std::optional<double> accuracy=std::nullopt);
+    ///< @brief Compute the set of basis vectors for a given KT problem from the
+    ///< functions sampled on the grid.
+    ///<
+    ///< See below for the meaning of the remaining arguments.
+
 template<typename T>
-std::vector<Vector> basis(const CurvedOmnes& o, const CFunction& pi_pi,
+std::vector<Vector> basis(const CurvedOmnes& o,
+        const std::vector<Complex>& pi_pi,
         int subtractions, const Grid<T>& g, double pion_mass,
         double virtuality, Method method=Method::inverse,
         std::optional<double> accuracy=std::nullopt)
     /// @brief Compute the set of basis vectors for a given KT problem.
     ///
     /// @param o the Omnes function
-    /// @param pi_pi the pion pion scattering amplitude
+    /// @param pi_pi the pion pion scattering amplitude at the values of x of
+    /// the grid (cf. `sample_x`)
     /// @param subtraction the number of subtractions
     /// @param g the grid on which the integrands of the KT equations
     /// are sampled
@@ -201,31 +432,136 @@ std::vector<Vector> basis(const CurvedOmnes& o, const CFunction& pi_pi,
     /// @param accuracy allows to tune the accuracy of the solution if
     /// iteration is used.
 {
-    Matrix kernel{
-        generate_kernel(o,pi_pi,g,pion_mass,virtuality,subtractions)};
-    Vector omnes_start{sample_on_grid(o,g,pion_mass,virtuality)};
-
-    std::vector<Vector> result;
-    for (int i{0}; i<subtractions; ++i) {
-        auto polynomial{[i](const Complex& s){return std::pow(s,i);}};
-        Vector start{sample_on_grid(polynomial,g,pion_mass,virtuality)};
-        start = start.cwiseProduct(omnes_start);
-        switch (method) {
-            case Method::iteration: {
-                constexpr double default_value{1e-8};
-                const double precision{accuracy ? *accuracy : default_value};
-                result.push_back(iteration(kernel,start,precision));
-                break; }
-            case Method::inverse:
-                result.push_back(inverse(kernel,start));
-                break;
-            default:
-                throw Unknown_method{};
+    const Kinematic_grid kinematics{g,pion_mass,virtuality};
+    return basis(Grid_samples{o,pi_pi,kinematics},kinematics,subtractions,
+            method,accuracy);
+}
+
+template<typename T>
+double refinement_error(const Grid<T>& coarse, const Vector& coarse_values,
+        const Grid<T>& fine, const Vector& fine_values)
+    /// @brief Return the largest difference of `coarse_values` and
+    /// `fine_values` at the points shared by `coarse` and `fine`, relative to
+    /// the largest modulus of `fine_values`.
+    ///
+    /// `fine` needs to be `coarse.refined()`. Applied to the solutions of the
+    /// KT equations on both grids, this estimates the error of the solution on
+    /// `coarse`, without sampling anything in addition.
+{
+    double error{0.0};
+    for (std::size_t i{0}; i<coarse.x_size(); ++i) {
+        const auto j{coarse.refined_x_index(i)};
+        for (std::size_t a{0}; a<coarse.z_size(i); ++a) {
+            const auto k{fine.index(j,coarse.refined_z_index(a))};
+            error = std::max(error,
+                    std::abs(coarse_values(coarse.index(i,a))-fine_values(k)));
         }
     }
-    return result;
+    return error/fine_values.cwiseAbs().maxCoeff();
+}
+
+template<typename T>
+double refinement_error(const OmnesF& omn, const CFunction& pi_pi,
+        int subtractions, const Grid<T>& coarse, double pion_mass,
+        double virtuality, Method method=Method::inverse,
+        std::optional<double> accuracy=std::nullopt)
+    /// @brief Solve the KT equations on `coarse` and on `coarse.refined()`
+    /// and return the largest `refinement_error` of the basis functions.
+    ///
+    /// The samples on `coarse` are reused on the refined grid (cf.
+    /// `Grid_samples`), the arguments match those of `Basis`.
+{
+    const CurvedOmnes curved{omn,pi_pi,coarse};
+    const Kinematic_grid coarse_kinematics{coarse,pion_mass,virtuality};
+    const Grid_samples coarse_samples{curved,sample_x(pi_pi,coarse),
+        coarse_kinematics};
+    const Grid<T> fine{coarse.refined()};
+    const Kinematic_grid fine_kinematics{fine,pion_mass,virtuality};
+    const Grid_samples fine_samples{curved,pi_pi,fine_kinematics,coarse,
+        coarse_samples};
+    const auto coarse_basis{basis(coarse_samples,coarse_kinematics,
+            subtractions,method,accuracy)};
+    const auto fine_basis{basis(fine_samples,fine_kinematics,subtractions,
+            method,accuracy)};
+    double error{0.0};
+    for (int i{0}; i<subtractions; ++i)
+        error = std::max(error,refinement_error(coarse,coarse_basis[i],fine,
+                    fine_basis[i]));
+    return error;
 }
 
+using Real_batch = std::function<Matrix(const std::vector<double>&)>;
+    ///< A vector valued function of a real variable, evaluated at many points
+    ///< at once: column k of the result contains the function at point k.
+
+/// @brief Vector valued functions tabulated along an interval of the real
+/// axis.
+///
+/// The interval is divided into parts at given break points, e.g. at the kinks
+/// of the functions, and each function is interpolated by a natural cubic
+/// spline (cf. `spline::Spline`) on each part. The knots are placed
+/// adaptively, such that the table is dense only where needed.
+class Real_table {
+public:
+    Real_table(const Real_batch& f, std::vector<double> breaks,
+            double tolerance, std::size_t max_levels=32);
+        ///< @param f the functions to be tabulated
+        ///< @param breaks the boundaries of the parts in strictly ascending
+        ///< order, the first and the last one bound the table. At the break
+        ///< points, the one-sided limits are tabulated, such that `f` needs
+        ///< not be regular there.
+        ///< @param tolerance every interval between neighbouring knots is
+        ///< bisected until the splines reproduce `f` at its midpoint up to
+        ///< `tolerance`, relative to the largest modulus of the respective
+        ///< function in the table
+        ///< @param max_levels the maximal number of bisections of the
+        ///< intervals, into which each part is divided initially. Intervals
+        ///< shorter than 1e-8 times the length of their part are not bisected
+        ///< either.
+    Real_table(const std::vector<double>& points, const Matrix& values);
+        ///< @brief Restore a table from the output of `points()` and
+        ///< `values()`.
+    double front() const noexcept {return breaks.front();}
+    double back() const noexcept {return breaks.back();}
+    bool contains(double s) const noexcept
+        {return front()<=s && s<=back();}
+    std::size_t size() const noexcept {return _size;}
+        ///< Return the number of functions.
+    Complex operator()(std::size_t i, double s) const;
+        ///< @brief Interpolate function `i` at `s`, values outside
+        ///< [`front()`,`back()`] are assigned to the boundaries.
+    Vector evaluate_all(double s) const;
+        ///< Interpolate all functions at `s`.
+    std::vector<double> points() const;
+        ///< @brief Return the knots of all parts in ascending order, the
+        ///< break points between neighbouring parts appear twice.
+    Matrix values() const;
+        ///< @brief Return the tabulated values, column k contains the
+        ///< functions at `points()[k]`.
+    double error() const noexcept {return _error;}
+        ///< @brief Return the largest relative deviation of the splines from
+        ///< the tabulated functions found at the last bisection of each
+        ///< interval, which estimates the interpolation error. Zero for a
+        ///< restored table.
+private:
+    /// The splines on the interval between two neighbouring break points.
+    struct Part {
+        std::vector<double> x;
+        Matrix y;
+            // row i contains function i at `x`
+        std::vector<spline::Spline<Complex>> splines;
+    };
+
+    std::vector<double> breaks;
+    std::vector<Part> parts;
+    std::size_t _size{0};
+    double _error{0.0};
+
+    void add_part(std::vector<double> x, Matrix y);
+    const Part& part(double s) const noexcept;
+        // Return the part containing `s`.
+};
+
 template<typename T>
 /// The basis of the solution space to a KT equation.
 class Basis {
@@ -234,7 +570,8 @@ public:
         const Grid<T>& g, double pion_mass, double virtuality,
         Method method=Method::inverse,
         std::optional<double> accuracy=std::nullopt,
-        double minimal_distance=1e-4);
+        double minimal_distance=1e-4, bool warm_start=false,
+        Reconstruction reconstruction=Reconstruction::linear);
         ///< @param o the Omnes function
         ///< @param pi_pi the pion pion scattering amplitude
         ///< @param subtraction the number of subtractions
@@ -248,20 +585,159 @@ public:
         ///< or via direct matrix inversion
         ///< @param accuracy allows to tune the accuracy of the solution if
         ///< iteration is used.
+        ///< @param minimal_distance half the width of the band around the
+        ///< threshold, in which the average of neighbouring points is used,
+        ///< i.e. for all s in the band, the values at the threshold plus and
+        ///< minus 1.1 `minimal_distance` with the imaginary part of s
+        ///< @param warm_start if true, the dispersive integrals start from the
+        ///< subdivision found in the previous evaluation (cf.
+        ///< `gsl::Warm_start`), which speeds up scans along nearby values of
+        ///< s. An instance must not be evaluated by multiple threads at once
+        ///< in this case. If the curve of `g` is a linearly parametrised
+        ///< polygon (cf. `Curve::is_linear`), the dispersive integrals are
+        ///< computed in closed form and `warm_start` has no effect.
+        ///< @param reconstruction determine how the integrands of the
+        ///< dispersive integrals are interpolated between the knots of `g`,
+        ///< `Reconstruction::barycentric` requires `Quadrature::gauss_legendre`
+    Basis(const OmnesF& omn, const CBatch_function& pi_pi, int subtractions,
+        const Grid<T>& g, double pion_mass, double virtuality,
+        Method method=Method::inverse,
+        std::optional<double> accuracy=std::nullopt,
+        double minimal_distance=1e-4, bool warm_start=false,
+        Reconstruction reconstruction=Reconstruction::linear);
+        ///< @brief Same as above, but `pi_pi` is evaluated at all values of
+        ///< x of the grid at once.
     Complex operator()(std::size_t i, Complex s) const;
         ///< @brief Evaluate the basis function with subtraction polynomial
         ///< s^`i` at `s`.
+    Vector evaluate_all(Complex s) const;
+        ///< @brief Evaluate all basis functions at `s`, element `i` equals
+        ///< `(*this)(i,s)`.
+        ///<
+        ///< Everything but the integrands is computed once for all basis
+        ///< functions, e.g. the Omnes function and, in closed form, the
+        ///< logarithms of the Cauchy kernel.
+    Matrix evaluate_all(const std::vector<Complex>& s) const;
+        ///< @brief Same as above for many values of s, column k contains the
+        ///< basis functions at `s[k]`.
+        ///<
+        ///< The sheet of the Omnes function is determined for all values at
+        ///< once.
+    Vector inhomogeneities(Complex s, std::size_t z_size=0) const;
+        ///< @brief Return the angular averages
+        ///< \f[\hat F_i(s)=\frac{3}{2}\int_{-1}^1dz\,(1-z^2)F_i(t(s,z))\f]
+        ///< of all basis functions \f$F_i\f$, i.e. the inhomogeneities of
+        ///< the KT equations.
+        ///<
+        ///< The integral uses the rule along the lines in the z-plane of the
+        ///< panel, whose values of x lie closest to `s`, with `z_size` knots,
+        ///< by default with as many as on this panel. Hence, at the values of
+        ///< x of the grid, the same values of t enter as in the solution of
+        ///< the KT equations, also if the panels differ in their rules or
+        ///< numbers of knots.
+    Matrix inhomogeneities(const std::vector<Complex>& s,
+            std::size_t z_size=0) const;
+        ///< @brief Same as above for many values of s, column k contains the
+        ///< angular averages at `s[k]`.
+        ///<
+        ///< The basis functions are evaluated at all values of t at once.
+    void tabulate(double lower, double upper, double tolerance=1e-8);
+        ///< @brief Tabulate all basis functions on the interval
+        ///< [`lower`,`upper`] of the real axis (cf. `Real_table`).
+        ///<
+        ///< Afterwards, `operator()` and `evaluate_all` interpolate the table
+        ///< at real values of s in this interval. On the cut, the table
+        ///< contains the same boundary values as `operator()`. The interval
+        ///< is divided at the threshold and at the knots on the real axis,
+        ///< where the basis functions have kinks.
+    void tabulate(Real_table table);
+        ///< @brief Use `table`, e.g. restored from an exported one, which
+        ///< needs to contain as many functions as there are basis functions.
+    const std::optional<Real_table>& table() const noexcept {return _table;}
+        ///< Return the table used for real values of s, if any.
+    rational::Rational compress(const std::vector<Complex>& samples,
+            double tolerance=1e-10, std::size_t max_support=100) const;
+        ///< @brief Approximate all basis functions by rational functions,
+        ///< which are evaluated in about a microsecond (cf. `rational::aaa`).
+        ///<
+        ///< `samples` represent the region of interest, e.g. points along its
+        ///< boundary and, where it touches the cut, the boundary values on the
+        ///< cut. The approximation continues the basis functions analytically
+        ///< beyond this region, its poles hint at the analytic structure.
 private:
-    gsl::Cquad integrate;
+    gsl::Cquad cquad;
+    gsl::Warm_start warm;
+    bool warm_start;
+    gsl::Principal_value principal_value;
 
     CurvedOmnes curved_omn;
     std::vector<Vector> _basis;
     int subtractions;
     double pion_mass;
+    double virtuality;
     double minimal_distance;
 
     Grid<T> grid;
+    gsl::Interval boundaries;
+        // The boundaries of the segments of `grid`, i.e. the kinks of the
+        // integrands.
+    Reconstruction reconstruction;
     std::vector<cauchy::Interpolate> integrands;
+    std::vector<cauchy::Legendre_interpolate> barycentric_integrands;
+        // only one of them is filled, depending on `reconstruction`
+
+    bool analytic;
+        // true if the dispersive integrals are computed in closed form
+    gsl::Interval nodes;
+        // The vertices of the polygon the closed form is applied to. For
+        // linear reconstruction, these are the knots of `integrands` together
+        // with `boundaries`: in between, both the curve and the integrands
+        // are linear. Otherwise, these are the boundaries of the panels of
+        // `grid`.
+    std::vector<Complex> vertices;
+        // the curve evaluated at `nodes`
+    std::vector<std::vector<Complex>> node_values;
+        // the integrands evaluated at `nodes` (linear reconstruction only)
+    std::vector<std::vector<Complex>> node_moments;
+        // the subtraction terms of the closed form, which do not depend on s
+        // (cf. `cauchy::polygon_moments`, linear reconstruction only)
+    std::optional<Real_table> _table;
+
+    Basis(const OmnesF& omn, const CFunction& pi_pi,
+        const std::vector<Complex>& pi_pi_x, int subtractions,
+        const Grid<T>& g, double pion_mass, double virtuality, Method method,
+        std::optional<double> accuracy, double minimal_distance,
+        bool warm_start, Reconstruction reconstruction);
+        // The constructor the public constructors delegate to, `pi_pi_x`
+        // contains `pi_pi` at the values of x of `g`.
+
+    /// The pole of the Cauchy kernel in the closed form.
+    struct Pole {
+        Complex s;
+            // the pole, with the imaginary part dropped if it lies on the
+            // curve
+        std::pair<std::size_t,std::size_t> principal;
+            // the pieces, for which the principal value is taken (cf.
+            // `cauchy::polygon_integral`)
+        std::optional<double> parameter;
+            // the curve parameter of the pole if it lies on the curve
+    };
+
+    const gsl::Integration& integrate() const noexcept;
+        // Return the routine used for the dispersive integrals.
+    Pole pole(const Complex& s) const;
+    Complex analytic_integral(std::size_t i, const Complex& s) const;
+    Complex numerical_integral(std::size_t i, const Complex& s) const;
+        // Return the dispersive integral of the basis function `i` in closed
+        // form or via numerical integration.
+    template<typename F>
+    Complex numerical_integral(const F& integrand, const Complex& s) const;
+    Vector dispersive_integrals(const Complex& s) const;
+        // Return the dispersive integrals of all basis functions.
+    Vector combine(const Complex& s, const Complex& omnes,
+            Vector integrals) const;
+        // Return the basis functions from the Omnes function and the
+        // dispersive integrals at `s`.
 };
 
 template<typename T>
@@ -279,40 +755,54 @@ Basis<T> make_basis(const OmnesF& omn, const CFunction& pi_pi,
 
 template<typename T>
 std::vector<Complex> discrete_basis_integrand(const OmnesF& o,
-        const CFunction& pi_pi, const Vector& basis, const Grid<T>& g,
-        double pion_mass)
+        const std::vector<Complex>& pi_pi, const Vector& basis,
+        const Grid<T>& g, double pion_mass)
     /// @brief Return the Mandelstam-s independent part of the integrand needed
     /// in the evaluation of a basis function.
 {
     const std::size_t n_x{g.x_size()};
-    const std::size_t n_z{g.z_size()};
     std::vector<Complex> result(n_x);
 
     for (std::size_t j{0}; j<n_x; ++j) {
-        for (std::size_t b{0}; b<n_z; ++b)
-            result[j] += angular(g,b) * basis(index(j,b,n_z)) * g(j,b).z_weight;
+        for (std::size_t b{0}; b<g.z_size(j); ++b)
+            result[j] += angular(g,j,b) * basis(g.index(j,b))
+                * g(j,b).z_weight;
         const auto x{g.x(j)};
-        result[j] *= pi_pi(x)*phase_space::sigma(pion_mass,x)/o(x);
+        result[j] *= pi_pi[j]*phase_space::sigma(pion_mass,x)/o(x);
     }
     return result;
 }
 
 template<typename T>
 cauchy::Interpolate basis_integrand(const OmnesF& o,
-        const CFunction& pi_pi, const Vector& basis, const Grid<T>& g,
-        double pion_mass)
+        const std::vector<Complex>& pi_pi, const Vector& basis,
+        const Grid<T>& g, double pion_mass)
     /// @brief Return the interpolated Mandelstam-s independent part of the
     /// integrand needed in the evaluation of a basis function.
 {
-    const auto discrete_integrand{
+    auto discrete_integrand{
         discrete_basis_integrand(o,pi_pi,basis,g,pion_mass)};
-    return cauchy::Interpolate{g.x_parameter_values(),discrete_integrand,
-        gsl::Interpolation_method::linear};
+    auto parameters{g.x_parameter_values()};
+    // Rules containing the endpoints of the panels (e.g.
+    // `Quadrature::clenshaw_curtis`) sample the boundaries of adjacent panels
+    // twice, only the first sample is kept.
+    std::size_t size{0};
+    for (std::size_t j{0}; j<parameters.size(); ++j) {
+        if (size>0 && parameters[j]==parameters[size-1])
+            continue;
+        parameters[size] = parameters[j];
+        discrete_integrand[size] = discrete_integrand[j];
+        ++size;
+    }
+    parameters.resize(size);
+    discrete_integrand.resize(size);
+    return cauchy::Interpolate{parameters,discrete_integrand,
+        spline::Method::linear};
 }
 
 template<typename T>
 std::vector<cauchy::Interpolate> basis_integrands(const OmnesF& o,
-        const CFunction& pi_pi, const std::vector<Vector>& basis,
+        const std::vector<Complex>& pi_pi, const std::vector<Vector>& basis,
         const Grid<T>& g, double pion_mass)
     /// @brief Return the interpolated Mandelstam-s independent parts of the
     /// integrands needed in the evaluation of an entire basis.
@@ -324,25 +814,164 @@ std::vector<cauchy::Interpolate> basis_integrands(const OmnesF& o,
     return result;
 }
 
+template<typename T>
+Grid<T> adaptive_grid(const OmnesF& omn, const CFunction& pi_pi,
+        int subtractions, const T& curve, double pion_mass, double virtuality,
+        std::size_t z_size, double tolerance, std::size_t order=16,
+        Method method=Method::iteration, std::size_t max_sweeps=40)
+    /// @brief Return a grid along `curve`, whose panels are bisected where
+    /// needed to resolve the integrands of the KT equations to `tolerance`.
+    ///
+    /// First, the factor pi_pi(x) sigma(x)/omn(x) common to all integrands is
+    /// resolved. Starting from the resulting grid, the basis is solved and
+    /// the integrands of the basis functions (cf. `discrete_basis_integrand`)
+    /// are resolved, solving again after each refinement. See
+    /// `grid::refine_panels` for the error estimate and the meaning of
+    /// `order` and `max_sweeps`, the remaining arguments match those of
+    /// `Basis`.
+{
+    const auto factors{[&](const Grid<T>& g)
+        {
+            auto values{sample_x(pi_pi,g)};
+            for (std::size_t j{0}; j<values.size(); ++j) {
+                const auto x{g.x(j)};
+                values[j] *= phase_space::sigma(pion_mass,x)/omn(x);
+            }
+            return std::vector<std::vector<Complex>>{values};
+        }};
+    const auto integrands{[&](const Grid<T>& g)
+        {
+            const CurvedOmnes curved{omn,pi_pi,g};
+            const auto pi_pi_x{sample_x(pi_pi,g)};
+            std::vector<std::vector<Complex>> result;
+            for (const auto& b: basis(curved,pi_pi_x,subtractions,g,pion_mass,
+                        virtuality,method))
+                result.push_back(
+                        discrete_basis_integrand(omn,pi_pi_x,b,g,pion_mass));
+            return result;
+        }};
+    auto panels{grid::refine_panels(curve,curve.boundaries(),order,z_size,
+            tolerance,max_sweeps,factors)};
+    panels = grid::refine_panels(curve,panels,order,z_size,tolerance,
+            max_sweeps,integrands);
+    return Grid<T>{curve,panels,std::vector<std::size_t>(panels.size()-1,order),
+        z_size};
+}
+
+template<typename T>
+cauchy::Legendre_interpolate barycentric_basis_integrand(const OmnesF& o,
+        const std::vector<Complex>& pi_pi, const Vector& basis,
+        const Grid<T>& g, double pion_mass)
+    /// @brief Same as `basis_integrand`, but the integrand is interpolated
+    /// via barycentric Lagrange interpolation on the Gauss-Legendre knots of
+    /// each panel of the grid.
+{
+    return cauchy::Legendre_interpolate{g.panel_boundaries(),g.panel_sizes(),
+        discrete_basis_integrand(o,pi_pi,basis,g,pion_mass)};
+}
+
+template<typename T>
+std::vector<cauchy::Legendre_interpolate> barycentric_basis_integrands(
+        const OmnesF& o, const std::vector<Complex>& pi_pi,
+        const std::vector<Vector>& basis, const Grid<T>& g, double pion_mass)
+    /// @brief Same as `basis_integrands`, but via
+    /// `barycentric_basis_integrand`.
+{
+    std::vector<cauchy::Legendre_interpolate> result;
+    for (const auto& b: basis)
+        result.push_back(barycentric_basis_integrand(o,pi_pi,b,g,pion_mass));
+    return result;
+}
+
+template<typename T>
+gsl::Interval polygon_nodes(const Grid<T>& g)
+    /// @brief Return the parameter values of the knots along the curve in the
+    /// x-plane merged with the boundaries of its segments, sorted in
+    /// ascending order.
+{
+    const auto knots{g.x_parameter_values()};
+    const auto boundaries{g.boundaries()};
+    gsl::Interval result;
+    result.reserve(knots.size()+boundaries.size());
+    std::merge(knots.cbegin(),knots.cend(),boundaries.cbegin(),
+            boundaries.cend(),std::back_inserter(result));
+    result.erase(std::unique(result.begin(),result.end()),result.end());
+    return result;
+}
+
 template<typename T>
 Basis<T>::Basis(const OmnesF& omn, const CFunction& pi_pi,
         int subtractions, const Grid<T>& g, double pion_mass,
         double virtuality, Method method, std::optional<double> accuracy,
-        double minimal_distance)
+        double minimal_distance, bool warm_start, Reconstruction reconstruction)
+    : Basis{omn,pi_pi,sample_x(pi_pi,g),subtractions,g,pion_mass,virtuality,
+        method,accuracy,minimal_distance,warm_start,reconstruction}
+{
+}
+
+template<typename T>
+Basis<T>::Basis(const OmnesF& omn, const CBatch_function& pi_pi,
+        int subtractions, const Grid<T>& g, double pion_mass,
+        double virtuality, Method method, std::optional<double> accuracy,
+        double minimal_distance, bool warm_start, Reconstruction reconstruction)
+    : Basis{omn,facilities::scalarize(pi_pi),pi_pi(x_values(g)),subtractions,
+        g,pion_mass,virtuality,method,accuracy,minimal_distance,warm_start,
+        reconstruction}
+{
+}
+
+template<typename T>
+Basis<T>::Basis(const OmnesF& omn, const CFunction& pi_pi,
+        const std::vector<Complex>& pi_pi_x, int subtractions,
+        const Grid<T>& g, double pion_mass, double virtuality, Method method,
+        std::optional<double> accuracy, double minimal_distance,
+        bool warm_start, Reconstruction reconstruction)
     :
+    warm_start{warm_start},
     curved_omn{CurvedOmnes(omn, pi_pi, g)},
-    _basis{basis(curved_omn,pi_pi,subtractions,g,pion_mass,virtuality,method,accuracy)},
+    _basis{basis(curved_omn,pi_pi_x,subtractions,g,pion_mass,virtuality,method,accuracy)},
     subtractions{subtractions},
     pion_mass{pion_mass},
+    virtuality{virtuality},
     minimal_distance{minimal_distance},
     grid{g},
-    integrands{basis_integrands(omn,pi_pi,_basis,grid,pion_mass)}
+    boundaries{grid.boundaries()},
+    reconstruction{reconstruction},
+    analytic{grid.is_linear()}
 {
+    switch (reconstruction) {
+        case Reconstruction::linear:
+            integrands = basis_integrands(omn,pi_pi_x,_basis,grid,pion_mass);
+            break;
+        case Reconstruction::barycentric:
+            if (!grid.uses(grid::Quadrature::gauss_legendre))
+                throw std::invalid_argument{"Barycentric reconstruction \
+requires Gauss-Legendre knots."};
+            barycentric_integrands = barycentric_basis_integrands(omn,pi_pi_x,
+                    _basis,grid,pion_mass);
+            break;
+        default:
+            throw std::invalid_argument{"Unknown reconstruction."};
+    }
+    if (!analytic)
+        return;
+    nodes = reconstruction==Reconstruction::linear
+        ? polygon_nodes(grid)
+        : grid.panel_boundaries();
+    vertices.reserve(nodes.size());
+    for (const auto t: nodes)
+        vertices.push_back(grid.curve_func(t));
+    for (const auto& f: integrands) {
+        node_values.push_back(f(nodes));
+        node_moments.push_back(cauchy::polygon_moments(vertices,
+                    node_values.back(),subtractions));
+    }
 }
 
 template<typename T, typename F>
-Complex cut_prescription(Grid<T> grid, double lower, double upper, double s,
-        F f, int subtractions, const gsl::Cquad& integrate)
+Complex cut_prescription(const Grid<T>& grid, double lower, double upper,
+        double s, const F& f, int subtractions,
+        const gsl::Principal_value& integrate)
     /// @brief Compute the dispersive integral with integrand `f` assuming that
     /// `s` hits the integration contour, i.e. via Cauchy principal value.
     ///
@@ -352,118 +981,366 @@ Complex cut_prescription(Grid<T> grid, double lower, double upper, double s,
     const auto end{grid.curve_func(upper)};
     const auto singularity{std::real((s-start) / (end-start))+lower};
     const auto fs{f(singularity)};
-    const auto l{std::log((1.0-s/end) / (s/start - 1.0))};
-    const auto sub{subtractions-1};
-    auto h{
-        [singularity
-        ,fs
-        ,sub
-        ,s
-        ,f = std::move(f)
-        ,g = std::move(grid)
-        ](double x)
+    // Neither the grid nor `f` are copied, they outlive the integration. `h`
+    // is passed by reference, which avoids allocating a copy of it.
+    const auto h{[subtractions,&f,&grid](double x)
         {
-            const auto cx{g.curve_func(x)};
-            return (f(x)/std::pow(cx,sub) - fs/std::pow(s,sub))
-                /cx/(x-singularity);
+            return f(x)/power(grid.curve_func(x),subtractions);
         }};
-    const auto result{
-        std::get<0>(cauchy::c_integrate(h,lower,upper,integrate))};
-    return std::pow(s,subtractions)*result
-        + fs*(Complex{0.0,1.0}*constants::pi() + l);
+    const auto result{std::get<0>(cauchy::c_principal_value(std::cref(h),
+                lower,upper,singularity,integrate))};
+    return power(s,subtractions)*result + fs*Complex{0.0,1.0}*constants::pi();
 }
 
 template<typename T, typename F>
-Complex ordinary_prescription(Grid<T> grid, double lower, double upper,
-        const Complex& s, F f, int subtractions, const gsl::Cquad& integrate)
+Complex ordinary_prescription(const Grid<T>& grid, const gsl::Interval& points,
+        const Complex& s, const F& f, int subtractions,
+        const gsl::Integration& integrate)
     /// @brief Compute the dispersive integral with integrand `f` assuming that
     /// `s` does not hit the integration contour.
+    ///
+    /// The integral runs from `points.front()` to `points.back()`, the inner
+    /// elements of `points` are passed to `integrate` as breakpoints.
 {
-    auto h{[subtractions,s,f = std::move(f),g = std::move(grid)](double x)
+    const auto h{[subtractions,s,&f,&grid](double x)
         {
-            const auto cx{g.curve_func(x)};
-            const auto dx{g.derivative_func(x)};
-            return f(x)/std::pow(cx,subtractions)/(cx-s)*dx;
+            Complex cx;
+            Complex dx;
+            grid.evaluate(&x,&x+1,&cx,&dx);
+            return f(x)/power(cx,subtractions)/(cx-s)*dx;
         }};
     const auto result{
-        std::get<0>(cauchy::c_integrate(h,lower,upper,integrate))};
-    return std::pow(s,subtractions)*result;
+        std::get<0>(cauchy::c_integrate(std::cref(h),points,integrate))};
+    return power(s,subtractions)*result;
+}
+
+template<typename T, typename F>
+Complex batch_prescription(const Grid<T>& grid, const gsl::Interval& points,
+        const Complex& s, const F& f, int subtractions,
+        const gsl::Integration& integrate)
+    /// @brief Same as `ordinary_prescription`, but the integrand is evaluated
+    /// at all abscissae of a rule at once via `gsl::Integration::batch`.
+{
+    const auto h{[&](const std::vector<double>& x)
+        {
+            // per-thread scratch for the curve, reused across rules
+            thread_local std::vector<Complex> cx;
+            thread_local std::vector<Complex> dx;
+            cx.resize(x.size());
+            dx.resize(x.size());
+            auto result{f(x)};
+            grid.evaluate(x.data(),x.data()+x.size(),cx.data(),dx.data());
+            for (std::size_t k{0}; k<x.size(); ++k)
+                result[k] = result[k]/power(cx[k],subtractions)
+                    /(cx[k]-s)*dx[k];
+            return result;
+        }};
+    const auto result{std::get<0>(cauchy::c_integrate(
+                cauchy::Batch_curve{std::cref(h)},points,integrate))};
+    return power(s,subtractions)*result;
+}
+
+template<typename T>
+void split(const gsl::Interval& points, const std::pair<T,T>& segment,
+        gsl::Interval& below, gsl::Interval& above)
+    /// @brief Assign the elements of `points` up to `segment.first` to `below`
+    /// and those from `segment.second` on to `above`.
+    ///
+    /// `points` needs to be sorted and contain both elements of `segment`.
+    /// The memory already held by `below` and `above` is reused.
+{
+    const auto first{std::find(points.cbegin(),points.cend(),segment.first)};
+    const auto second{std::find(first,points.cend(),segment.second)};
+    below.assign(points.cbegin(),std::next(first));
+    above.assign(second,points.cend());
+}
+
+template<typename T>
+const gsl::Integration& Basis<T>::integrate() const noexcept
+{
+    if (warm_start)
+        return warm;
+    return cquad;
+}
+
+template<typename T>
+Complex Basis<T>::operator()(std::size_t i, Complex s) const
+{
+    if (_table && s.imag()==0.0 && _table->contains(s.real()))
+        return (*_table)(i,s.real());
+    if (hits_threshold_m(pion_mass,s,minimal_distance)) {
+        // Shifting the threshold rather than s, both points lie outside the
+        // band for all s in it.
+        const Complex centre{helpers::threshold(pion_mass),s.imag()};
+        const double shift{minimal_distance * 1.1};
+        return ((*this)(i, centre - shift) + (*this)(i, centre + shift)) / 2.0;
+    }
+    const Complex dispersive_integral{analytic
+        ? analytic_integral(i,s)
+        : numerical_integral(i,s)};
+    return curved_omn(s)
+        * (power(s,i) + 1.5/constants::pi()*dispersive_integral);
 }
 
 template<typename T>
-constexpr bool tolerant_equal(T a, T b, T tolerance=1e-16)
-    /// Check whether `a` and `b` are equal up to `tolerance`.
+typename Basis<T>::Pole Basis<T>::pole(const Complex& s) const
 {
-    return a-b<tolerance && b-a<tolerance;
+    const auto segment{grid.hits(s)};
+    if (!segment)
+        return Pole{s,{0,0},std::nullopt};
+
+    // The same prescription as in `cut_prescription`.
+    const auto sr{s.real()};
+    const auto first{std::find(nodes.cbegin(),nodes.cend(),segment->first)};
+    const auto second{std::find(first,nodes.cend(),segment->second)};
+    const auto principal{std::make_pair(
+            static_cast<std::size_t>(std::distance(nodes.cbegin(),first)),
+            static_cast<std::size_t>(std::distance(nodes.cbegin(),second)))};
+    const auto start{grid.curve_func(segment->first)};
+    const auto end{grid.curve_func(segment->second)};
+    const auto singularity{std::real((sr-start) / (end-start))
+        + segment->first};
+    return Pole{sr,principal,singularity};
 }
 
-template<typename Container>
-void remove_element(Container& c, const typename Container::value_type& value)
-    /// @brief Remove `value` from `c` if it is contained in it, otherwise
-    /// leave `c` unchanged.
+template<typename T>
+Complex Basis<T>::analytic_integral(std::size_t i, const Complex& s) const
 {
-    const auto new_end{std::remove_if(c.begin(),c.end(),
-            [value](const auto& v){return v==value;})};
-    c.erase(new_end,c.cend());
+    const bool barycentric{reconstruction==Reconstruction::barycentric};
+    const auto p{pole(s)};
+    const auto value{barycentric
+        ? barycentric_integrands.at(i).polygon_integral(vertices,p.s,
+                subtractions,p.principal)
+        : cauchy::polygon_integral(vertices,node_values.at(i),p.s,
+                node_moments.at(i),p.principal)};
+    if (!p.parameter)
+        return value;
+    const auto residue{barycentric
+        ? barycentric_integrands[i](*p.parameter)
+        : integrands[i](*p.parameter)};
+    return value + residue*Complex{0.0,1.0}*constants::pi();
 }
 
 template<typename T>
-std::vector<std::pair<T,T>> segments(const std::vector<T>& points)
-    /// Return all pairs of non-equal successive values.
+Complex Basis<T>::numerical_integral(std::size_t i, const Complex& s) const
 {
-    const auto s{points.size()};
-    if (s<2)
-        return {};
+    if (reconstruction==Reconstruction::barycentric)
+        return numerical_integral(barycentric_integrands.at(i),s);
+    return numerical_integral(integrands.at(i),s);
+}
 
-    std::vector<std::pair<T,T>> result;
-    for (std::size_t i{0}; i<s-1; ++i) {
-        const auto x{points[i]};
-        const auto y{points[i+1]};
-        if (!tolerant_equal(x,y))
-            result.push_back(std::make_pair(x,y));
+template<typename T>
+template<typename F>
+Complex Basis<T>::numerical_integral(const F& integrand, const Complex& s)
+    const
+{
+    const auto regular{[&](const gsl::Interval& points, const Complex& z)
+        {
+            // Warm_start evaluates entire rules at once, such that the
+            // interpolated integrand is evaluated at many points per call.
+            if (warm_start)
+                return batch_prescription(grid,points,z,integrand,
+                        subtractions,integrate());
+            return ordinary_prescription(grid,points,z,integrand,
+                    subtractions,integrate());
+        }};
+    if (const auto segment = grid.hits(s)) {
+        const auto sr{s.real()};
+        Complex dispersive_integral{cut_prescription(grid,segment->first,
+                segment->second,sr,integrand,subtractions,principal_value)};
+        // per-thread scratch, such that evaluations on the cut do not
+        // allocate either
+        thread_local gsl::Interval below;
+        thread_local gsl::Interval above;
+        split(boundaries,*segment,below,above);
+        if (below.size()>1)
+            dispersive_integral += regular(below,sr);
+        if (above.size()>1)
+            dispersive_integral += regular(above,sr);
+        return dispersive_integral;
     }
+    return regular(boundaries,s);
+}
+
+template<typename T>
+Vector Basis<T>::dispersive_integrals(const Complex& s) const
+{
+    const auto n{_basis.size()};
+    Vector result(n);
+    if (!analytic) {
+        // The adaptive routines choose their abscissae per integrand, such
+        // that only the integrals themselves are separate.
+        for (std::size_t i{0}; i<n; ++i)
+            result(i) = numerical_integral(i,s);
+        return result;
+    }
+    const bool barycentric{reconstruction==Reconstruction::barycentric};
+    const auto p{pole(s)};
+    if (barycentric) {
+        for (std::size_t i{0}; i<n; ++i)
+            result(i) = barycentric_integrands[i].polygon_integral(vertices,
+                    p.s,subtractions,p.principal);
+    } else {
+        const auto values{cauchy::polygon_integrals(vertices,node_values,p.s,
+                node_moments,p.principal)};
+        for (std::size_t i{0}; i<n; ++i)
+            result(i) = values[i];
+    }
+    if (p.parameter)
+        for (std::size_t i{0}; i<n; ++i)
+            result(i) += (barycentric
+                    ? barycentric_integrands[i](*p.parameter)
+                    : integrands[i](*p.parameter))
+                * Complex{0.0,1.0}*constants::pi();
     return result;
 }
 
 template<typename T>
-std::vector<std::pair<T,T>> segments_without(const std::vector<T>& points,
-        const std::pair<T,T>& value)
-    /// Return all pairs of non-equal successive values excluding `value`.
+Vector Basis<T>::combine(const Complex& s, const Complex& omnes,
+        Vector integrals) const
 {
-    auto s{segments(points)};
-    remove_element(s,value);
-    return s;
+    for (Eigen::Index i{0}; i<integrals.size(); ++i)
+        integrals(i) = omnes
+            * (power(s,i) + 1.5/constants::pi()*integrals(i));
+    return integrals;
 }
 
 template<typename T>
-Complex Basis<T>::operator()(std::size_t i, Complex s) const
+Vector Basis<T>::evaluate_all(Complex s) const
 {
+    if (_table && s.imag()==0.0 && _table->contains(s.real()))
+        return _table->evaluate_all(s.real());
     if (hits_threshold_m(pion_mass,s,minimal_distance)) {
+        const Complex centre{helpers::threshold(pion_mass),s.imag()};
         const double shift{minimal_distance * 1.1};
-        return ((*this)(i, s - shift) + (*this)(i, s + shift)) / 2.0;
+        return (evaluate_all(centre - shift) + evaluate_all(centre + shift))
+            / 2.0;
     }
-    const auto& integrand{integrands.at(i)};
-    Complex dispersive_integral;
-    if (const auto segment = grid.hits(s)) {
-        const auto x0{grid.x_parameter_lower()};
-        const auto x1{segment->first};
-        const auto x2{segment->second};
-        const auto x3{grid.x_parameter_upper()};
-        const auto intervals{segments_without({x0,x1,x2,x3},*segment)};
-        const auto sr{s.real()};
-        dispersive_integral = cut_prescription(grid,x1,x2,sr,integrand,
-                subtractions,integrate);
-        for (const auto& i: intervals)
-            dispersive_integral += ordinary_prescription(grid,i.first,i.second,
-                    sr,integrand,subtractions,integrate);
+    return combine(s,curved_omn(s),dispersive_integrals(s));
+}
+
+template<typename T>
+Matrix Basis<T>::evaluate_all(const std::vector<Complex>& s) const
+{
+    Matrix result(_basis.size(),s.size());
+    std::vector<std::size_t> regular;
+    std::vector<Complex> points;
+    for (std::size_t k{0}; k<s.size(); ++k) {
+        if (hits_threshold_m(pion_mass,s[k],minimal_distance)
+                || (_table && s[k].imag()==0.0
+                    && _table->contains(s[k].real()))) {
+            result.col(k) = evaluate_all(s[k]);
+            continue;
+        }
+        regular.push_back(k);
+        points.push_back(s[k]);
     }
-    else
-        dispersive_integral = ordinary_prescription(
-                grid,grid.x_parameter_lower(),grid.x_parameter_upper(),
-                s,integrand,subtractions,integrate);
+    const auto omnes{curved_omn(points)};
+    for (std::size_t j{0}; j<points.size(); ++j)
+        result.col(regular[j]) = combine(points[j],omnes[j],
+                dispersive_integrals(points[j]));
+    return result;
+}
 
-    return curved_omn(s)
-        * (std::pow(s,i) + 1.5/constants::pi()*dispersive_integral);
+template<typename T>
+Vector Basis<T>::inhomogeneities(Complex s, std::size_t z_size) const
+{
+    return inhomogeneities(std::vector<Complex>{s},z_size).col(0);
+}
+
+template<typename T>
+Matrix Basis<T>::inhomogeneities(const std::vector<Complex>& s,
+        std::size_t z_size) const
+{
+    // The rule along the line in the z-plane, one for each panel.
+    const auto& rules{grid.panel_rules()};
+    std::vector<grid::Knots> knots;
+    std::vector<Vector> weights;
+    for (std::size_t p{0}; p<rules.size(); ++p) {
+        const std::size_t n{z_size==0 ? grid.panel_z_sizes()[p] : z_size};
+        knots.push_back(grid::generate_knots(-1.0,1.0,n,rules[p].z_rule()));
+        Vector w(n);
+        for (std::size_t b{0}; b<n; ++b) {
+            const auto [z,weight] = knots.back()[b];
+            w(b) = 1.5*weight*(1.0-square(z));
+        }
+        weights.push_back(std::move(w));
+    }
+
+    // Each value of s uses the panel of the value of x closest to it.
+    const auto x{x_values(grid)};
+    std::vector<std::size_t> panel_of;
+    panel_of.reserve(x.size());
+    const auto& x_sizes{grid.panel_sizes()};
+    for (std::size_t p{0}; p<x_sizes.size(); ++p)
+        panel_of.insert(panel_of.end(),x_sizes[p],p);
+    std::vector<std::size_t> panels(s.size());
+    std::vector<Complex> t;
+    for (std::size_t k{0}; k<s.size(); ++k) {
+        const auto closest{std::min_element(x.cbegin(),x.cend(),
+                [&](Complex a, Complex b)
+                {return std::abs(a-s[k])<std::abs(b-s[k]);})};
+        panels[k] = panel_of[closest-x.cbegin()];
+        for (const auto& knot: knots[panels[k]])
+            t.push_back(mandelstam::t_photon_pion(s[k],knot.first,pion_mass,
+                        virtuality));
+    }
+    const Matrix values{evaluate_all(t)};
+    Matrix result(_basis.size(),s.size());
+    for (std::size_t k{0}, offset{0}; k<s.size(); ++k) {
+        const auto& w{weights[panels[k]]};
+        result.col(k) = values.middleCols(offset,w.size())*w;
+        offset += w.size();
+    }
+    return result;
+}
+
+template<typename T>
+void Basis<T>::tabulate(double lower, double upper, double tolerance)
+{
+    if (!(lower<upper))
+        throw std::invalid_argument{"The table needs lower<upper."};
+    // The band around the threshold, in which the average of neighbouring
+    // points is used, is a part of its own.
+    const double threshold{helpers::threshold(pion_mass)};
+    std::vector<double> breaks{lower,threshold-minimal_distance,threshold,
+        threshold+minimal_distance,upper};
+    const auto knots{reconstruction==Reconstruction::linear
+        ? polygon_nodes(grid)
+        : grid.panel_boundaries()};
+    for (const auto t: knots) {
+        const auto x{grid.curve_func(t)};
+        if (x.imag()==0.0)
+            breaks.push_back(x.real());
+    }
+    breaks.erase(std::remove_if(breaks.begin(),breaks.end(),
+                [lower,upper](double x){return x<lower || x>upper;}),
+            breaks.end());
+    std::sort(breaks.begin(),breaks.end());
+    breaks.erase(std::unique(breaks.begin(),breaks.end()),breaks.end());
+
+    // The table is filled by evaluating the basis functions themselves.
+    _table.reset();
+    _table = Real_table{[this](const std::vector<double>& s)
+        {
+            return evaluate_all(std::vector<Complex>(s.cbegin(),s.cend()));
+        },breaks,tolerance};
+}
+
+template<typename T>
+rational::Rational Basis<T>::compress(const std::vector<Complex>& samples,
+        double tolerance, std::size_t max_support) const
+{
+    return rational::aaa(samples,evaluate_all(samples),tolerance,max_support);
+}
+
+template<typename T>
+void Basis<T>::tabulate(Real_table table)
+{
+    if (table.size()!=_basis.size())
+        throw std::invalid_argument{"The table needs to contain as many \
+functions as there are basis functions."};
+    _table = std::move(table);
 }
 } // kernel
 
@@ -13,16 +13,26 @@ namespace khuri_treiman {
 using grid::Curve;
 using grid::Point;
 using grid::Grid;
+using grid::Quadrature;
+using grid::Rule;
 
 using piecewise::Piecewise;
 using piecewise::Adaptive;
 using piecewise::Vector_decay;
 using piecewise::Real;
+using piecewise::Path;
+using piecewise::Smooth_adaptive;
+using piecewise::Traced;
 
+using kernel::adaptive_grid;
 using kernel::Basis;
 using kernel::Complex;
 using kernel::CFunction;
+using kernel::CBatch_function;
 using kernel::Method;
+using kernel::Real_table;
+using kernel::Reconstruction;
+using kernel::refinement_error;
 } // khuri_treiman
 
 #endif // KHURI_TREIMAN_H
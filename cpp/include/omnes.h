@@ -57,6 +57,21 @@ public:
         ///< function to take care of the singularity in the integral.
         ///< @param config The settings for the integration routine.
 
+    Omnes(const gsl::Batch_function& phase, double threshold,
+            double minimal_distance, gsl::Settings config=gsl::Settings{});
+        ///< @brief Same as above, but `phase` is evaluated at all abscissae
+        ///< of a subinterval (or rule) of the integration routine at once.
+        ///<
+        ///< Cf. `gsl::Integration::batch`. The principal value integral
+        ///< along the cut still evaluates `phase` at single points.
+    Omnes(const gsl::Batch_function& phase, double threshold, double constant,
+            double cut, double minimal_distance,
+            gsl::Settings config=gsl::Settings{});
+        ///< @brief Same as above, but `phase` is evaluated at all abscissae
+        ///< of a subinterval (or rule) of the integration routine at once.
+        ///<
+        ///< Cf. `gsl::Integration::batch`.
+
     Complex operator()(Complex s) const;
         ///< Evaluate the Omnes function at `s`.
 
@@ -67,13 +82,22 @@ public:
         ///< Return the branch point.
 private:
     const gsl::Function phase_below; // phase below `cut`
+    const gsl::Batch_function phase_batch;
+        // vectorized version of `phase_below`, empty if not provided
     const double constant;
     const double threshold;
     const double cut;
     const double minimal_distance;
     const Integrate integrate;
+    const gsl::Principal_value principal_value;
     const double derivative;
 
+    Omnes(const gsl::Function& phase, const gsl::Batch_function& batch,
+            double threshold, double constant, double cut,
+            double minimal_distance, gsl::Settings config);
+        // The constructor all public constructors delegate to, `batch` may
+        // be empty.
+
     Complex upper(const Complex& s) const;
         // Evaluate the Omnes function in the upper half of the complex plane
     bool hits_cut(const Complex& s) const;
@@ -92,6 +116,13 @@ private:
     double abs_cut(double s) const;
         // Calculate the absolute value of the Omnes function along the branch
         // cut.
+    double integrate_phase(const gsl::Function& weight, double lower,
+            double upper) const;
+        // Integrate `phase_below` times `weight` in [`lower`,`upper`], using
+        // `phase_batch` if available.
+    Complex c_integrate_phase(const CFunction& weight, double lower,
+            double upper) const;
+        // Same as `integrate_phase` for complex valued weights.
 };
 
 inline double derivative_0(const gsl::Function& phase, double threshold,
@@ -106,25 +137,69 @@ inline double derivative_0(const gsl::Function& phase, double threshold,
     return (first + second)/constants::pi();
 }
 
+inline double derivative_0(const gsl::Batch_function& phase,
+        double threshold, double cut, double constant,
+        const gsl::Integration& integrate)
+    // Same as above for a vectorized `phase`.
+{
+    const auto integrand{[&phase](const std::vector<double>& x)
+        {
+            std::vector<double> result{phase(x)};
+            for (std::size_t i{0}; i<x.size(); ++i)
+                result[i] /= x[i]*x[i];
+            return result;
+        }};
+    double first{integrate.batch(integrand,threshold,cut).first};
+    double second{constant/cut};
+    return (first + second)/constants::pi();
+}
+
 template<typename T>
-Omnes<T>::Omnes(const gsl::Function& phase, double threshold,
+Omnes<T>::Omnes(const gsl::Function& phase, const gsl::Batch_function& batch,
+        double threshold, double constant, double cut,
         double minimal_distance, gsl::Settings config)
-: phase_below{phase},
-    constant{0.0}, // value of the `constant` is irrelevant if `cut` is infinity
-    threshold{threshold}, cut{std::numeric_limits<double>::infinity()},
+: phase_below{phase}, phase_batch{batch},
+    constant{constant}, threshold{threshold}, cut{cut},
     minimal_distance{minimal_distance},
     integrate{config},
-    derivative{derivative_0(phase,threshold,cut,constant,integrate)}
+    principal_value{config},
+    derivative{phase_batch
+        ? derivative_0(phase_batch,threshold,cut,constant,integrate)
+        : derivative_0(phase_below,threshold,cut,constant,integrate)}
+{
+}
+
+template<typename T>
+Omnes<T>::Omnes(const gsl::Function& phase, double threshold,
+        double minimal_distance, gsl::Settings config)
+    // value of the `constant` is irrelevant if `cut` is infinity
+: Omnes{phase,gsl::Batch_function{},threshold,0.0,
+    std::numeric_limits<double>::infinity(),minimal_distance,config}
 {
 }
 
 template<typename T>
 Omnes<T>::Omnes(const gsl::Function& phase, double threshold, double constant,
         double cut, double minimal_distance, gsl::Settings config)
-: phase_below{phase}, constant{constant}, threshold{threshold}, cut{cut},
-    minimal_distance{minimal_distance},
-    integrate{config},
-    derivative{derivative_0(phase,threshold,cut,constant,integrate)}
+: Omnes{phase,gsl::Batch_function{},threshold,constant,cut,minimal_distance,
+    config}
+{
+}
+
+template<typename T>
+Omnes<T>::Omnes(const gsl::Batch_function& phase, double threshold,
+        double minimal_distance, gsl::Settings config)
+: Omnes{facilities::scalarize(phase),phase,threshold,0.0,
+    std::numeric_limits<double>::infinity(),minimal_distance,config}
+{
+}
+
+template<typename T>
+Omnes<T>::Omnes(const gsl::Batch_function& phase, double threshold,
+        double constant, double cut, double minimal_distance,
+        gsl::Settings config)
+: Omnes{facilities::scalarize(phase),phase,threshold,constant,cut,
+    minimal_distance,config}
 {
 }
 
@@ -168,9 +243,8 @@ Complex Omnes<T>::ordinary_prescription(
         const Complex& s) const
 {
     Complex above_cut{std::log(1.0-s/cut)};
-    auto integral{std::get<0>(cauchy::c_integrate(
-                [&s,this](double z){return phase_below(z)/(z*(z-s));},
-                threshold,cut,integrate))};
+    auto integral{c_integrate_phase(
+                [&s](Complex z){return 1.0/(z*(z-s));},threshold,cut)};
     return std::exp((s*integral-constant*above_cut)/constants::pi());
 }
 
@@ -190,6 +264,44 @@ double Omnes<T>::phase(double s) const
         return constant;
 }
 
+template<typename T>
+double Omnes<T>::integrate_phase(const gsl::Function& weight, double lower,
+        double upper) const
+{
+    if (!phase_batch)
+        return integrate([&weight,this](double z)
+                {
+                    return phase_below(z)*weight(z);
+                },lower,upper).first;
+    return integrate.batch([&weight,this](const std::vector<double>& z)
+            {
+                std::vector<double> result{phase_batch(z)};
+                for (std::size_t i{0}; i<z.size(); ++i)
+                    result[i] *= weight(z[i]);
+                return result;
+            },lower,upper).first;
+}
+
+template<typename T>
+Complex Omnes<T>::c_integrate_phase(const CFunction& weight, double lower,
+        double upper) const
+{
+    if (!phase_batch)
+        return std::get<0>(cauchy::c_integrate(
+                [&weight,this](double z){return phase_below(z)*weight(z);},
+                lower,upper,integrate));
+    const cauchy::Batch_curve integrand{
+        [&weight,this](const std::vector<double>& z)
+        {
+            const std::vector<double> phases{phase_batch(z)};
+            std::vector<Complex> result(z.size());
+            for (std::size_t i{0}; i<z.size(); ++i)
+                result[i] = phases[i]*weight(z[i]);
+            return result;
+        }};
+    return std::get<0>(cauchy::c_integrate(integrand,lower,upper,integrate));
+}
+
 inline double abs_helper(double s, double value)
     // Simplify the calculation of the absolute value of the Omnes
     // function along the cut.
@@ -201,14 +313,18 @@ inline double abs_helper(double s, double value)
 template<typename T>
 double Omnes<T>::abs_cut(double s) const
 {
-    double phase_at_s{phase(s)};
-    auto integral{integrate(
-                [&s,&phase_at_s,this](double z)
-                    {return (phase_below(z)-phase_at_s)/(z*(z-s));},
-                threshold,cut).first};
-    double a{s<cut ? constant-phase_at_s : 0.0};
-    return std::exp((s*integral + a*abs_helper(s,cut)
-            + phase_at_s*abs_helper(s,threshold))/constants::pi());
+    // `principal_value` requires a finite interval. Hence, for an infinite
+    // `cut`, the integral is split at the reflection of the threshold at `s`
+    // and the remainder is free of singularities.
+    const double split{std::isinf(cut) ? 2.0*s-threshold : cut};
+    double integral{principal_value(
+                [this](double z){return phase_below(z)/z;},
+                threshold,split,s).first};
+    if (split<cut)
+        integral += integrate_phase(
+                [&s](double z){return 1.0/(z*(z-s));},split,cut);
+    return std::exp((s*integral + constant*abs_helper(s,cut))
+            /constants::pi());
 }
 
 template<typename T>
@@ -4,8 +4,11 @@
 #include "facilities.h"
 #include "grid.h"
 #include "mandelstam.h"
+#include "singularity.h"
 
+#include <array>
 #include <numeric>
+#include <optional>
 #include <type_traits>
 
 /// @brief Facilities for the generation of a grid, whose associated curve in
@@ -15,6 +18,23 @@ using facilities::square;
 using grid::Complex;
 using grid::Curve;
 
+/// A rectangle containing all points that `hits` assigns to a segment.
+struct Box {
+    double real_lower;
+    double real_upper;
+    double imag_lower;
+    double imag_upper;
+
+    bool contains(const Complex& s) const noexcept
+    {
+        return s.real()>=real_lower && s.real()<=real_upper
+            && s.imag()>=imag_lower && s.imag()<=imag_upper;
+    }
+};
+
+Box bounding_box(const std::vector<Complex>& points, double margin);
+    ///< Return the smallest box containing `points`, enlarged by `margin`.
+
 /// a piecewise linear path in the complex plane
 class Piecewise : public Curve {
 public:
@@ -48,25 +68,37 @@ public:
         ///< @param knots The points in the complex plane that are connected
         ///< with straigt lines. The curve starts at the first element of knots
         ///< end ends at the last.
-    Complex curve_func(double x) const override;
+    Complex curve_func(double x) const final;
         ///< @brief Evaluate the piecewise linear curve at x.
         ///<
         ///< x=k corresponds to the k-th point (k=0,1,...).
-    Complex derivative_func(double x) const override;
+    Complex derivative_func(double x) const final;
+    void evaluate(const double* first, const double* last, Complex* values,
+            Complex* derivatives) const final;
     Segment hits(const Complex& s) const override;
     std::vector<double> boundaries() const override;
+    bool is_linear() const override;
     double lower() const noexcept {return 0.0;}
         ///< Return the parameter value corresponding to the start of the curve.
-    double upper() const noexcept {return pieces.size();}
+    double upper() const noexcept {return coefficients.size();}
         ///< Return the parameter value corresponding to the end of the curve.
     std::size_t piece_index(double x) const;
         ///< @brief Return the number of the segment corresponding to the
         ///< parameter value x.
 private:
     using CC = std::pair<Complex,Complex>;
+
+    /// Segment k is c_0+c_1 (x-k)+c_2 (x-k)^2 for both parametrisations.
+    struct Coefficients {
+        Complex constant;
+        Complex linear;
+        Complex quadratic;
+    };
+
     std::vector<Para> parametrisations;
-    std::vector<CC> pieces;
+    std::vector<Coefficients> coefficients;
     std::vector<CC> adjacent;
+    std::vector<Box> boxes;
 };
 
 /// linear curve along the real axis
@@ -89,6 +121,124 @@ class Adaptive : public Piecewise {
 public:
     Adaptive(double pion_mass, double virtuality, double cut);
 };
+
+/// @brief a smooth path in the complex plane glued together from straight
+/// lines, elliptic (in particular circular) arcs and cubic Bézier curves
+///
+/// Piece k is parametrised by x in [k,k+1]. In contrast to `Piecewise`,
+/// the pieces may be curved, such that corners can be avoided altogether.
+class Path : public Curve {
+public:
+    /// A single piece of a path, parametrised by u in [0,1].
+    class Piece {
+    public:
+        static Piece line(const Complex& start, const Complex& end);
+            ///< Return the straight line from `start` to `end`.
+        static Piece arc(const Complex& center, double radius,
+                double start_angle, double end_angle);
+            ///< @brief Return the circular arc around `center` from
+            ///< `start_angle` to `end_angle`.
+            ///<
+            ///< The arc runs counter-clockwise if `end_angle>start_angle`
+            ///< and clockwise otherwise.
+        static Piece elliptic_arc(const Complex& center,
+                double real_semi_axis, double imaginary_semi_axis,
+                double start_angle, double end_angle);
+            ///< @brief Return the arc center+a cos(phi)+i b sin(phi) of an
+            ///< ellipse with semi-axes a and b along the real and imaginary
+            ///< axis, where phi runs from `start_angle` to `end_angle`.
+        static Piece bezier(const Complex& start, const Complex& first_control,
+                const Complex& second_control, const Complex& end);
+            ///< Return the cubic Bézier curve with the given control points.
+
+        Complex value(double u) const;
+        Complex derivative(double u) const;
+        std::optional<double> locate(const Complex& s) const;
+            ///< @brief Return the parameter u with value(u)==s, if `s` lies
+            ///< on the piece.
+        bool is_line() const noexcept
+            {return kind==polynomial && c[2]==0.0 && c[3]==0.0;}
+    private:
+        enum Kind {
+            polynomial,
+            ellipse
+        };
+
+        Piece(Kind kind, std::array<Complex,4> c, double real_semi_axis,
+                double imaginary_semi_axis, double start_angle, double sweep);
+
+        Kind kind;
+        // Polynomials are c_0+c_1 u+c_2 u^2+c_3 u^3, ellipses are centered
+        // at c_0.
+        std::array<Complex,4> c;
+        double real_semi_axis;
+        double imaginary_semi_axis;
+        double start_angle;
+        double sweep;
+        Box box;
+    };
+
+    Path(std::vector<Piece> pieces);
+        ///< @brief The end of each piece needs to coincide with the start of
+        ///< the next one.
+    Complex curve_func(double x) const final;
+    Complex derivative_func(double x) const final;
+    void evaluate(const double* first, const double* last, Complex* values,
+            Complex* derivatives) const final;
+    Segment hits(const Complex& s) const override;
+        ///< @brief Determine whether `s` hits the path.
+        ///<
+        ///< Note that the kernel can currently handle hits only on straight
+        ///< pieces along the real axis.
+    std::vector<double> boundaries() const override;
+    bool is_linear() const override;
+    double lower() const noexcept {return 0.0;}
+        ///< Return the parameter value corresponding to the start of the path.
+    double upper() const noexcept {return pieces.size();}
+        ///< Return the parameter value corresponding to the end of the path.
+    std::size_t piece_index(double x) const;
+        ///< @brief Return the number of the piece corresponding to the
+        ///< parameter value x.
+private:
+    std::vector<Piece> pieces;
+};
+
+/// @brief the shortest polygon with a given number of sides that leads around
+/// the singular region, followed by the real axis
+///
+/// In contrast to `Adaptive`, the actual boundary of the region where
+/// Mandelstam t hits the two-pion threshold is traced (cf.
+/// `singularity::lower_curve`) instead of bounding it by the rectangle of
+/// `mandelstam::Critical`. The polygon leaves the two-pion threshold
+/// vertically like `Adaptive`, keeps the distance `margin` from the singular
+/// region and returns to the real axis in between the region and s_greater.
+/// Its remaining corners and the point of return are chosen such that the
+/// curve is as short as possible. The singular region lies to the right of
+/// the threshold only for virtualities above 9 pion masses squared, hence the
+/// constructor throws std::invalid_argument for smaller virtualities.
+class Traced : public Piecewise {
+public:
+    Traced(double pion_mass, double virtuality, double cut,
+            std::size_t sides=3, double margin=1.0);
+        ///< @param sides The number of sides of the polygon that leads
+        ///< around the singular region.
+        ///< @param margin The minimal distance from the singular region in
+        ///< units of the squared pion mass. It is reduced to half the distance
+        ///< between the threshold and the singular region if necessary.
+};
+
+/// @brief same as `Adaptive`, but the critical region is avoided by a half
+/// ellipse instead of three sides of a rectangle
+///
+/// The ellipse starts vertically at the two-pion threshold and returns to the
+/// real axis to the right of the critical region. It passes through the
+/// corners of the rectangle that bounds the critical region (cf.
+/// `mandelstam::Critical`), whose right side is shifted by the squared pion
+/// mass as for `Adaptive`. The remainder of the curve runs along the real axis.
+class Smooth_adaptive : public Path {
+public:
+    Smooth_adaptive(double pion_mass, double virtuality, double cut);
+};
 } // piecewise
 
 #endif // PIECEWISE_H
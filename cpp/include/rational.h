@@ -0,0 +1,85 @@
+#ifndef RATIONAL_KHURI_HEADER
+#define RATIONAL_KHURI_HEADER
+
+#include "type_aliases.h"
+
+#include "Eigen/Dense"
+
+#include <cstddef>
+#include <vector>
+
+/// @brief Rational approximations in barycentric form via the AAA algorithm.
+///
+/// A function sampled in some region of the complex plane, e.g. a basis
+/// function of the KT equations or an Omnes function, is replaced by a
+/// rational function, which is cheap to evaluate and continues the function
+/// analytically beyond the samples.
+namespace rational {
+using type_aliases::Complex;
+using Matrix =
+    Eigen::Matrix<Complex,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
+using Vector = Eigen::VectorXcd;
+
+/// @brief Rational functions in barycentric form with common support points
+/// and weights.
+///
+/// Function i reads
+/// \f[r_i(s)=\sum_j\frac{w_jf_{ij}}{s-z_j}\Big/\sum_j\frac{w_j}{s-z_j},\f]
+/// with the support points \f$z_j\f$, the weights \f$w_j\f$ and
+/// \f$r_i(z_j)=f_{ij}\f$. The support points, the weights and the values
+/// \f$f_{ij}\f$ are all there is to store.
+class Rational {
+public:
+    Rational(std::vector<Complex> support_points, std::vector<Complex> weights,
+            Matrix values, double error=0.0);
+        ///< @param values row i contains \f$r_i\f$ at `support_points`
+        ///< @param error the accuracy of the approximation, if known
+    Complex operator()(std::size_t i, const Complex& s) const;
+        ///< Evaluate function `i` at `s`.
+    Vector evaluate_all(const Complex& s) const;
+        ///< Evaluate all functions at `s`.
+    std::vector<Complex> poles() const;
+        ///< @brief Return the poles shared by all functions, i.e. the zeros of
+        ///< the denominator.
+    std::size_t size() const noexcept {return _values.rows();}
+        ///< Return the number of functions.
+    std::size_t degree() const noexcept {return _support_points.size()-1;}
+        ///< Return the degree of the numerators and the denominator.
+    const std::vector<Complex>& support_points() const noexcept
+        {return _support_points;}
+    const std::vector<Complex>& weights() const noexcept {return _weights;}
+    const Matrix& values() const noexcept {return _values;}
+    double error() const noexcept {return _error;}
+        ///< @brief Return the largest deviation from the approximated
+        ///< functions at their samples, relative to the largest modulus of
+        ///< the respective function (cf. `aaa`).
+private:
+    std::vector<Complex> _support_points;
+    std::vector<Complex> _weights;
+    Matrix _values;
+    double _error;
+};
+
+Rational aaa(const std::vector<Complex>& z, const Matrix& f,
+        double tolerance=1e-12, std::size_t max_support=100);
+    ///< @brief Approximate the functions sampled at `z` by rational functions
+    ///< with common support points and weights.
+    ///<
+    ///< Row i of `f` contains function i at `z`. Following the AAA algorithm
+    ///< by Nakatsukasa, Sete and Trefethen, the sample with the largest
+    ///< deviation becomes the next support point and the weights minimise the
+    ///< linearised deviation at the remaining samples, summed over all
+    ///< functions. This stops once the deviation is below `tolerance`
+    ///< relative to the largest modulus of each function, or once there are
+    ///< `max_support` support points.
+    ///<
+    ///< The approximation is reliable in the region the samples represent,
+    ///< e.g. points along its boundary. Where the functions have a branch
+    ///< cut, the poles line up along the cut.
+
+Rational aaa(const std::vector<Complex>& z, const std::vector<Complex>& f,
+        double tolerance=1e-12, std::size_t max_support=100);
+    ///< Same as above for a single function.
+} // rational
+
+#endif // RATIONAL_KHURI_HEADER
@@ -0,0 +1,61 @@
+#ifndef SINGULARITY_H
+#define SINGULARITY_H
+
+#include "type_aliases.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// @brief The singularities of the angular integration in the Khuri-Treiman
+/// equations, i.e. the values of Mandelstam s at which Mandelstam t hits the
+/// two-pion threshold.
+///
+/// Native counterpart of `khuri/singularity.py`.
+namespace singularity {
+using type_aliases::Complex;
+
+std::array<Complex,3> cubic_roots(const std::array<double,4>& coefficients);
+    ///< @brief Return the three roots of
+    ///< c[0]+c[1]*x+c[2]*x^2+c[3]*x^3, where c[3] must not vanish.
+    ///<
+    ///< The roots obtained in closed form are polished by Newton's method.
+
+std::array<double,4> coefficients(double cos2, double decay_mass_2,
+        double mass_2);
+    ///< @brief Return the coefficients of the cubic equation determining the
+    ///< singularities.
+    ///<
+    ///< @param cos2 The squared cosine of the scattering angle.
+    ///< @param decay_mass_2 The squared mass of the decaying particle.
+    ///< @param mass_2 The squared mass of one of the equal-mass particles in
+    ///< the final state.
+
+std::array<Complex,3> singularities(double cos2, double decay_mass_2,
+        double mass_2);
+    ///< @brief Return the three singularities for 0<`cos2`<1.
+    ///<
+    ///< Unlike `cubic_roots`, this remains accurate for cos2 close to one.
+
+std::vector<Complex> singularity_curve(double decay_mass_2, double mass_2,
+        std::size_t number, std::size_t points=200, double eps=1e-6);
+    ///< @brief Return the values of the singularity curve `number` as
+    ///< parametrised by `points` values of the squared cosine, equally spaced
+    ///< in [eps,1-eps].
+    ///<
+    ///< This mirrors `singularity_curve` of `khuri/singularity.py`, including
+    ///< the numbering of the roots of `cubic_roots`.
+
+std::vector<Complex> lower_curve(double decay_mass_2, double mass_2,
+        std::size_t points=200);
+    ///< @brief Return the boundary of the singular region in the lower half
+    ///< plane.
+    ///<
+    ///< The curve runs from (decay_mass_2-mass_2)/2 at cos2=1 to
+    ///< decay_mass_2-5 mass_2 at cos2=0, where both endpoints are exact. The
+    ///< inner points are equally spaced in the scattering angle, at each of
+    ///< them the singularity with the smallest imaginary part is chosen.
+    ///< All points are real if there is no singular region off the real axis.
+} // singularity
+
+#endif // SINGULARITY_H
@@ -0,0 +1,427 @@
+#ifndef SPLINE_H
+#define SPLINE_H
+
+#include "type_aliases.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/// @brief Native piecewise cubic interpolation of real and complex data.
+///
+/// In contrast to `gsl::Interpolate`, the classes below own plain vectors
+/// only: copying and moving does not allocate GSL objects nor initialize the
+/// spline again and evaluation does not modify any state, such that an
+/// instance can be evaluated by several threads at once.
+namespace spline {
+using type_aliases::Complex;
+
+enum class Method {
+    linear,
+    cubic,  ///< natural cubic spline
+    akima,
+    steffen ///< monotonic cubic interpolation according to Steffen
+};
+
+std::size_t min_size(Method m) noexcept;
+    ///< Return the minimal number of required points, such that the method
+    ///< can be used for interpolation (the same as for the GSL routines).
+
+/// @brief Strictly ascending knots with a fast lookup of the interval that
+/// contains a given point.
+///
+/// The range [`front()`,`back()`] is divided into as many buckets of equal
+/// width as there are intervals, each bucket stores the first interval it
+/// overlaps with. A lookup thus needs a constant number of steps if the
+/// knots are distributed uniformly or if they are an affine map of the same
+/// pattern repeated several times (such as Gauss-Legendre knots on segments
+/// of equal length).
+class Knots {
+public:
+    explicit Knots(std::vector<double> x);
+        ///< `x` needs to contain at least 2 elements and needs to be sorted in
+        ///< strictly ascending order.
+
+    std::size_t locate(double x) const noexcept;
+        ///< @brief Return the index i of the interval [x_i,x_{i+1}] that
+        ///< contains `x`.
+        ///<
+        ///< Values outside [`front()`,`back()`] are assigned to the first and
+        ///< last interval respectively.
+
+    double operator[](std::size_t i) const noexcept {return knots[i];}
+    double front() const noexcept {return knots.front();}
+    double back() const noexcept {return knots.back();}
+    std::size_t size() const noexcept {return knots.size();}
+    const std::vector<double>& values() const noexcept {return knots;}
+private:
+    std::vector<double> knots;
+    std::vector<std::size_t> buckets;
+    double inverse_width;
+};
+
+/// @brief Interpolation of data provided as pairs (x_i,y_i) by piecewise cubic
+/// Hermite polynomials.
+///
+/// The derivatives at the knots are determined by `Method`. For complex data,
+/// these are determined for the real and imaginary part separately.
+///
+/// @tparam Number is either `double` or `Complex`.
+template<typename Number>
+class Spline {
+public:
+    Spline(const std::vector<double>& x, const std::vector<Number>& y,
+            Method m);
+        ///< The sizes of `x` and `y` need to be the same and at least
+        ///< `min_size(m)`. `x` needs to be sorted in strictly ascending order.
+
+    Number operator()(double x) const noexcept;
+        ///< @brief Return the value of the (interpolated) data at point `x`.
+        ///<
+        ///< If evaluated outside the interval [`front()`,`back()`], the
+        ///< boundary values are returned.
+
+    void operator()(const double* first, const double* last, Number* out)
+        const noexcept;
+        ///< @brief Evaluate the interpolation at all points in
+        ///< [`first`,`last`) and write the results to `out`.
+        ///<
+        ///< Consecutive points are looked up by walking along the knots, such
+        ///< that sorted points need a single pass over the knots. Unsorted
+        ///< points are allowed, but cost a lookup for every jump backwards.
+    std::vector<Number> operator()(const std::vector<double>& x) const;
+        ///< Return the values of the interpolation at all elements of `x`.
+
+    double front() const noexcept {return knots.front();}
+    double back() const noexcept {return knots.back();}
+    std::size_t size() const noexcept {return knots.size();}
+    Method method() const noexcept {return method_;}
+private:
+    static_assert(std::is_same<Number,double>::value
+            || std::is_same<Number,Complex>::value,
+            "spline::Spline supports double and Complex only");
+
+    Knots knots;
+    std::vector<Number> data;
+        // value and derivative at each knot stored next to each other, i.e.
+        // y_0, y'_0, y_1, y'_1, ..., such that an evaluation reads a single
+        // contiguous block
+    Method method_;
+
+    std::size_t next(std::size_t i, double x) const noexcept;
+        // Return the interval containing `x`, assuming it is `i` or the one
+        // following it.
+    Number linear(std::size_t i, double x) const noexcept;
+    Number hermite(std::size_t i, double x) const noexcept;
+        // Evaluate the interpolating polynomial of the interval `i` at `x`.
+};
+
+// -- Derivatives at the knots ------------------------------------------------
+
+namespace detail {
+
+inline std::vector<double> secants(const Knots& x, const std::vector<double>& y)
+    // Return the slopes (y_{i+1}-y_i)/(x_{i+1}-x_i).
+{
+    std::vector<double> result(y.size()-1);
+    for (std::size_t i{0}; i<result.size(); ++i)
+        result[i] = (y[i+1]-y[i])/(x[i+1]-x[i]);
+    return result;
+}
+
+inline std::vector<double> cubic_derivatives(const Knots& x,
+        const std::vector<double>& y)
+    // Derivatives of the natural cubic spline, obtained from the second
+    // derivatives via the Thomas algorithm.
+{
+    const std::size_t n{y.size()};
+    const auto s{secants(x,y)};
+
+    std::vector<double> second(n,0.0);
+    std::vector<double> diagonal(n,0.0);
+    std::vector<double> rhs(n,0.0);
+    for (std::size_t i{1}; i+1<n; ++i) {
+        const double h_before{x[i]-x[i-1]};
+        const double h_after{x[i+1]-x[i]};
+        diagonal[i] = 2.0*(h_before+h_after);
+        rhs[i] = 6.0*(s[i]-s[i-1]);
+        if (i>1) {
+            const double factor{h_before/diagonal[i-1]};
+            diagonal[i] -= factor*h_before;
+            rhs[i] -= factor*rhs[i-1];
+        }
+    }
+    for (std::size_t i{n-2}; i>0; --i)
+        second[i] = (rhs[i]-(x[i+1]-x[i])*second[i+1])/diagonal[i];
+
+    std::vector<double> result(n);
+    for (std::size_t i{0}; i+1<n; ++i) {
+        const double h{x[i+1]-x[i]};
+        result[i] = s[i]-h*(2.0*second[i]+second[i+1])/6.0;
+    }
+    const double h{x[n-1]-x[n-2]};
+    result[n-1] = s[n-2]+h*(second[n-2]+2.0*second[n-1])/6.0;
+    return result;
+}
+
+inline std::vector<double> akima_derivatives(const Knots& x,
+        const std::vector<double>& y)
+    // Akima's derivatives with the secants extrapolated quadratically at
+    // the boundaries, as done by GSL.
+{
+    const std::size_t n{y.size()};
+    const auto s{secants(x,y)};
+
+    // m[k+2] corresponds to the secant s_k, k=-2,...,n
+    std::vector<double> m(n+3);
+    std::copy(s.cbegin(),s.cend(),m.begin()+2);
+    m[1] = 2.0*s[0]-s[1];
+    m[0] = 3.0*s[0]-2.0*s[1];
+    m[n+1] = 2.0*s[n-2]-s[n-3];
+    m[n+2] = 3.0*s[n-2]-2.0*s[n-3];
+
+    std::vector<double> result(n);
+    for (std::size_t i{0}; i<n; ++i) {
+        const double w_before{std::abs(m[i+3]-m[i+2])};
+        const double w_after{std::abs(m[i+1]-m[i])};
+        const double sum{w_before+w_after};
+        result[i] = sum==0.0
+            ? 0.5*(m[i+1]+m[i+2])
+            : (w_before*m[i+1]+w_after*m[i+2])/sum;
+    }
+    return result;
+}
+
+inline double steffen_boundary(double s_near, double s_far, double h_near,
+        double h_far)
+    // Derivative at a boundary according to Steffen, limited such that the
+    // interpolation stays monotonic.
+{
+    const double p{s_near*(1.0+h_near/(h_near+h_far))
+        - s_far*h_near/(h_near+h_far)};
+    if (p*s_near<=0.0)
+        return 0.0;
+    if (std::abs(p)>2.0*std::abs(s_near))
+        return 2.0*s_near;
+    return p;
+}
+
+inline std::vector<double> steffen_derivatives(const Knots& x,
+        const std::vector<double>& y)
+{
+    const std::size_t n{y.size()};
+    const auto s{secants(x,y)};
+
+    std::vector<double> result(n);
+    for (std::size_t i{1}; i+1<n; ++i) {
+        const double h_before{x[i]-x[i-1]};
+        const double h_after{x[i+1]-x[i]};
+        const double p{(s[i-1]*h_after+s[i]*h_before)/(h_before+h_after)};
+        const double bound{std::min({std::abs(s[i-1]),std::abs(s[i]),
+                0.5*std::abs(p)})};
+        result[i] = (std::copysign(1.0,s[i-1])+std::copysign(1.0,s[i]))*bound;
+    }
+    result[0] = steffen_boundary(s[0],s[1],x[1]-x[0],x[2]-x[1]);
+    result[n-1] = steffen_boundary(s[n-2],s[n-3],x[n-1]-x[n-2],
+            x[n-2]-x[n-3]);
+    return result;
+}
+
+inline std::vector<double> derivatives(const Knots& x,
+        const std::vector<double>& y, Method m)
+{
+    switch (m) {
+        case Method::linear:
+            break;
+        case Method::cubic:
+            return cubic_derivatives(x,y);
+        case Method::akima:
+            return akima_derivatives(x,y);
+        case Method::steffen:
+            return steffen_derivatives(x,y);
+    }
+    return std::vector<double>(y.size(),0.0);
+}
+
+inline std::vector<double> derivatives_real(const Knots& x,
+        const std::vector<double>& y, Method m)
+{
+    return derivatives(x,y,m);
+}
+
+inline std::vector<Complex> derivatives_real(const Knots& x,
+        const std::vector<Complex>& y, Method m)
+    // The nonlinear methods (Akima, Steffen) act on the real and imaginary
+    // part separately.
+{
+    std::vector<double> real_part(y.size());
+    std::vector<double> imaginary_part(y.size());
+    for (std::size_t i{0}; i<y.size(); ++i) {
+        real_part[i] = y[i].real();
+        imaginary_part[i] = y[i].imag();
+    }
+    const auto d_real{derivatives(x,real_part,m)};
+    const auto d_imag{derivatives(x,imaginary_part,m)};
+
+    std::vector<Complex> result(y.size());
+    for (std::size_t i{0}; i<y.size(); ++i)
+        result[i] = Complex{d_real[i],d_imag[i]};
+    return result;
+}
+} // detail
+
+// -- Implementation ----------------------------------------------------------
+
+inline std::size_t min_size(Method m) noexcept
+{
+    switch (m) {
+        case Method::linear:
+            return 2;
+        case Method::cubic:
+            return 3;
+        case Method::akima:
+            return 5;
+        case Method::steffen:
+            return 3;
+    }
+    return 2;
+}
+
+inline Knots::Knots(std::vector<double> x)
+    : knots{std::move(x)}
+{
+    if (knots.size()<2)
+        throw std::invalid_argument("spline::Knots needs at least 2 knots");
+    const bool ascending{std::adjacent_find(knots.cbegin(),knots.cend(),
+            std::greater_equal<double>{})==knots.cend()};
+    if (!ascending)
+        throw std::invalid_argument("spline::Knots need to be sorted in \
+strictly ascending order");
+
+    const std::size_t intervals{knots.size()-1};
+    const double width{(back()-front())/intervals};
+    inverse_width = 1.0/width;
+    buckets.resize(intervals);
+    std::size_t i{0};
+    for (std::size_t b{0}; b<intervals; ++b) {
+        const double left{front()+b*width};
+        while (i+1<intervals && knots[i+1]<=left)
+            ++i;
+        buckets[b] = i;
+    }
+}
+
+inline std::size_t Knots::locate(double x) const noexcept
+{
+    const std::size_t last{buckets.size()-1};
+    if (!(x>front()))
+        return 0;
+    if (!(x<back()))
+        return last;
+    const std::size_t b{std::min(
+            static_cast<std::size_t>((x-front())*inverse_width),last)};
+    std::size_t i{buckets[b]};
+    // The bucket is only a guess due to rounding, correct it in both
+    // directions.
+    while (i>0 && x<knots[i])
+        --i;
+    while (i<last && knots[i+1]<=x)
+        ++i;
+    return i;
+}
+
+template<typename Number>
+Spline<Number>::Spline(const std::vector<double>& x,
+        const std::vector<Number>& y, Method m)
+    : knots{x}, data(2*y.size()), method_{m}
+{
+    if (x.size()!=y.size())
+        throw std::invalid_argument("x and y need to have the same size");
+    if (y.size()<min_size(m))
+        throw std::invalid_argument("not enough data points for the choosen \
+interpolation method");
+
+    const auto d{detail::derivatives_real(knots,y,m)};
+    for (std::size_t i{0}; i<y.size(); ++i) {
+        data[2*i] = y[i];
+        data[2*i+1] = d[i];
+    }
+}
+
+template<typename Number>
+Number Spline<Number>::operator()(double x) const noexcept
+{
+    x = std::clamp(x,front(),back());
+    const std::size_t i{knots.locate(x)};
+    return method_==Method::linear ? linear(i,x) : hermite(i,x);
+}
+
+template<typename Number>
+void Spline<Number>::operator()(const double* first, const double* last,
+        Number* out) const noexcept
+{
+    std::size_t i{0};
+    // The method is dispatched once, such that the loops consist of the
+    // lookup and straight-line arithmetic only.
+    if (method_==Method::linear) {
+        for (; first!=last; ++first, ++out) {
+            const double x{std::clamp(*first,front(),back())};
+            i = next(i,x);
+            *out = linear(i,x);
+        }
+    }
+    else {
+        for (; first!=last; ++first, ++out) {
+            const double x{std::clamp(*first,front(),back())};
+            i = next(i,x);
+            *out = hermite(i,x);
+        }
+    }
+}
+
+template<typename Number>
+std::vector<Number> Spline<Number>::operator()(const std::vector<double>& x)
+    const
+{
+    std::vector<Number> result(x.size());
+    (*this)(x.data(),x.data()+x.size(),result.data());
+    return result;
+}
+
+template<typename Number>
+std::size_t Spline<Number>::next(std::size_t i, double x) const noexcept
+{
+    if (knots[i]<=x && x<knots[i+1])
+        return i;
+    if (i+2<knots.size() && knots[i+1]<=x && x<knots[i+2])
+        return i+1;
+    return knots.locate(x);
+}
+
+template<typename Number>
+Number Spline<Number>::linear(std::size_t i, double x) const noexcept
+{
+    const double t{(x-knots[i])/(knots[i+1]-knots[i])};
+    const Number* p{data.data()+2*i};
+    return p[0]+t*(p[2]-p[0]);
+}
+
+template<typename Number>
+Number Spline<Number>::hermite(std::size_t i, double x) const noexcept
+{
+    const double h{knots[i+1]-knots[i]};
+    const double t{(x-knots[i])/h};
+    const double u{1.0-t};
+    const Number* p{data.data()+2*i};
+    // p[0]=y_i, p[1]=y'_i, p[2]=y_{i+1}, p[3]=y'_{i+1}
+    return u*u*((1.0+2.0*t)*p[0]+h*t*p[1])
+        + t*t*((3.0-2.0*t)*p[2]-h*u*p[3]);
+}
+} // spline
+
+#endif // SPLINE_H
@@ -3,10 +3,14 @@
 
 #include <complex>
 #include <functional>
+#include <vector>
 
 namespace type_aliases {
 using Complex = std::complex<double>;
 using CFunction = std::function<Complex(Complex)>;
+using CBatch_function = std::function<std::vector<Complex>(
+        const std::vector<Complex>&)>;
+    // evaluates a function elementwise at many arguments at once
 } // type_aliases
 
 #endif // TYPE_ALIASES_H
@@ -1,5 +1,8 @@
 #include "cauchy.h"
 
+#include <cmath>
+#include <numeric>
+
 namespace cauchy {
 // -- Basic facilities --------------------------------------------------------
 
@@ -35,17 +38,80 @@ std::vector<double> imag(const std::vector<Complex>& vec)
 
 // -- Integration -------------------------------------------------------------
 
+// The parts refer to `c` instead of copying it, such that the resulting
+// `gsl::Function` fits into the small buffer of `std::function` and no memory
+// is allocated per integration.
+
+auto real_part_of(const Curve& c)
+{
+    return [&c](double x){return c(x).real();};
+}
+
+auto imaginary_part_of(const Curve& c)
+{
+    return [&c](double x){return c(x).imag();};
+}
+
+std::tuple<Complex,double,double> c_integrate(const Curve& c,
+        double lower, double upper, const gsl::Integration& integrate)
+{
+    gsl::Value real_part{integrate(real_part_of(c),lower,upper)};
+    gsl::Value imaginary_part{integrate(imaginary_part_of(c),lower,upper)};
+    Complex result{real_part.first,imaginary_part.first};
+    return std::make_tuple(result,real_part.second,imaginary_part.second);
+}
+
 std::tuple<Complex,double,double> c_integrate(const Curve& c,
+        const Interval& points, const gsl::Integration& integrate)
+{
+    gsl::Value real_part{integrate(real_part_of(c),points)};
+    gsl::Value imaginary_part{integrate(imaginary_part_of(c),points)};
+    Complex result{real_part.first,imaginary_part.first};
+    return std::make_tuple(result,real_part.second,imaginary_part.second);
+}
+
+std::tuple<Complex,double,double> c_integrate(const Batch_curve& c,
         double lower, double upper, const gsl::Integration& integrate)
 {
-    gsl::Value real_part{
-            integrate(facilities::compose(real_specified,c),lower,upper)};
+    const auto part{[&c](auto part_of)
+        {
+            return [&c,part_of](const std::vector<double>& x)
+            {
+                const std::vector<Complex> values{c(x)};
+                std::vector<double> result(values.size());
+                std::transform(values.cbegin(),values.cend(),result.begin(),
+                        part_of);
+                return result;
+            };
+        }};
+    gsl::Value real_part{integrate.batch(part(real_specified),lower,upper)};
     gsl::Value imaginary_part{
-            integrate(facilities::compose(imag_specified,c),lower,upper)};
+            integrate.batch(part(imag_specified),lower,upper)};
     Complex result{real_part.first,imaginary_part.first};
     return std::make_tuple(result,real_part.second,imaginary_part.second);
 }
 
+std::tuple<Complex,double,double> c_integrate(const Batch_curve& c,
+        const Interval& points, const gsl::Integration& integrate)
+{
+    if (points.size()<2)
+        throw std::invalid_argument{"integration requires at least two \
+points"};
+    Complex result{0.0,0.0};
+    double real_error{0.0};
+    double imaginary_error{0.0};
+    for (std::size_t i{1}; i<points.size(); ++i) {
+        if (points[i-1]==points[i])
+            continue;
+        const auto [value,re,im] = c_integrate(c,points[i-1],points[i],
+                integrate);
+        result += value;
+        real_error += re;
+        imaginary_error += im;
+    }
+    return std::make_tuple(result,real_error,imaginary_error);
+}
+
 std::tuple<Complex,double,double> c_integrate(const Complex_function& f,
         const Curve& c, const Curve& c_derivative, double lower, double upper,
         const gsl::Integration& integrate)
@@ -58,22 +124,637 @@ std::tuple<Complex,double,double> c_integrate(const Complex_function& f,
             lower,upper,integrate);
 }
 
-// -- Interpolation -----------------------------------------------------------
+std::tuple<Complex,double,double> c_principal_value(const Curve& c,
+        double lower, double upper, double singularity,
+        const gsl::Principal_value& integrate)
+{
+    gsl::Value real_part{integrate(real_part_of(c),lower,upper,singularity)};
+    gsl::Value imaginary_part{
+            integrate(imaginary_part_of(c),lower,upper,singularity)};
+    Complex result{real_part.first,imaginary_part.first};
+    return std::make_tuple(result,real_part.second,imaginary_part.second);
+}
 
-Interpolate::Interpolate(const Interval& x,
-        const std::vector<Complex>& y, gsl::Interpolation_method m)
-    : real_part{x,real(y),m},
-    imaginary_part{x,imag(y),m}
+// -- Closed form integrals ---------------------------------------------------
+
+// The logarithms below are written in terms of w=(z_b-z_a)/(z_a-s), which
+// avoids the cancellations between large terms if s is far from the piece
+// [z_a,z_b].
+
+Complex log1p(const Complex& w)
+    // Return log(1+w), accurate for small w as well (Kahan's trick).
+{
+    const Complex u{1.0+w};
+    if (u==1.0)
+        return w;
+    return std::log(u)*w/(u-1.0);
+}
+
+Complex log1p_remainder(const Complex& w)
+    // Return (w-log(1+w))/w.
+{
+    constexpr double series_radius{0.1};
+    if (std::abs(w)>=series_radius)
+        return (w-log1p(w))/w;
+    // (w-log(1+w))/w = w/2-w^2/3+w^3/4-..., 17 terms suffice for |w|<0.1
+    Complex result{0.0,0.0};
+    Complex power{1.0,0.0};
+    for (int k{2}; k<19; ++k) {
+        power *= -w;
+        result -= power/static_cast<double>(k);
+    }
+    return result;
+}
+
+Complex linear_over_pole(const Complex& za, const Complex& zb,
+        const Complex& fa, const Complex& fb, const Complex& s)
+    // Return the integral of f(z)/(z-s) from za to zb along a straight line,
+    // f being linear with f(za)=fa and f(zb)=fb, and s not on the line.
+{
+    const Complex w{(zb-za)/(za-s)};
+    return fa*log1p(w)+(fb-fa)*log1p_remainder(w);
+}
+
+double log_distance(const Complex& z, const Complex& s)
+    // log|z-s|, where the divergence at z=s is dropped: it cancels between
+    // adjacent pieces of a principal value integral.
+{
+    const double distance{std::abs(z-s)};
+    return distance==0.0 ? 0.0 : std::log(distance);
+}
+
+Complex linear_over_pole_pv(const Complex& za, const Complex& zb,
+        const Complex& fa, const Complex& fb, const Complex& s)
+    // Same as `linear_over_pole`, but s lies on the line through za and zb,
+    // such that the principal value is taken.
+{
+    const Complex slope{(fb-fa)/(zb-za)};
+    const Complex fs{fa+slope*(s-za)};
+    return slope*(zb-za)+fs*(log_distance(zb,s)-log_distance(za,s));
+}
+
+Complex linear_over_power(const Complex& za, const Complex& zb,
+        const Complex& fa, const Complex& fb, int j)
+    // Return the integral of f(z)/z^(j+1) from za to zb along a straight line
+    // for j>=1, f being linear with f(za)=fa and f(zb)=fb.
+{
+    const Complex slope{(fb-fa)/(zb-za)};
+    const Complex offset{fa-slope*za};
+    const Complex constant_part{
+        offset*(std::pow(za,-j)-std::pow(zb,-j))/static_cast<double>(j)};
+    if (j==1)
+        return constant_part+slope*log1p((zb-za)/za);
+    return constant_part
+        + slope*(std::pow(za,1-j)-std::pow(zb,1-j))/static_cast<double>(j-1);
+}
+
+Complex polygon_integral(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, const Complex& s, int subtractions,
+        std::pair<std::size_t,std::size_t> principal)
+{
+    if (z.size()!=f.size())
+        throw std::invalid_argument{"polygon_integral requires as many values \
+as vertices"};
+    // s^n/(z^n(z-s)) = 1/(z-s) - sum_{j=0}^{n-1} s^j/z^(j+1)
+    Complex result{0.0,0.0};
+    for (std::size_t k{0}; k+1<z.size(); ++k) {
+        const auto& za{z[k]};
+        const auto& zb{z[k+1]};
+        const auto& fa{f[k]};
+        const auto& fb{f[k+1]};
+        if (principal.first<=k && k<principal.second)
+            result += linear_over_pole_pv(za,zb,fa,fb,s);
+        else
+            result += linear_over_pole(za,zb,fa,fb,s);
+        Complex power{1.0,0.0};
+        for (int j{0}; j<subtractions; ++j) {
+            if (j==0)
+                result -= linear_over_pole(za,zb,fa,fb,0.0);
+            else
+                result -= power*linear_over_power(za,zb,fa,fb,j);
+            power *= s;
+        }
+    }
+    return result;
+}
+
+std::vector<Complex> polygon_moments(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, int subtractions)
+{
+    if (z.size()!=f.size())
+        throw std::invalid_argument{"polygon_moments requires as many values \
+as vertices"};
+    std::vector<Complex> result(std::max(subtractions,0));
+    for (std::size_t k{0}; k+1<z.size(); ++k)
+        for (int j{0}; j<subtractions; ++j)
+            result[j] += j==0
+                ? linear_over_pole(z[k],z[k+1],f[k],f[k+1],0.0)
+                : linear_over_power(z[k],z[k+1],f[k],f[k+1],j);
+    return result;
+}
+
+Complex polygon_integral(const std::vector<Complex>& z,
+        const std::vector<Complex>& f, const Complex& s,
+        const std::vector<Complex>& moments,
+        std::pair<std::size_t,std::size_t> principal)
+{
+    if (z.size()!=f.size())
+        throw std::invalid_argument{"polygon_integral requires as many values \
+as vertices"};
+    Complex result{0.0,0.0};
+    for (std::size_t k{0}; k+1<z.size(); ++k) {
+        if (principal.first<=k && k<principal.second)
+            result += linear_over_pole_pv(z[k],z[k+1],f[k],f[k+1],s);
+        else
+            result += linear_over_pole(z[k],z[k+1],f[k],f[k+1],s);
+    }
+    Complex power{1.0,0.0};
+    for (const auto& m: moments) {
+        result -= power*m;
+        power *= s;
+    }
+    return result;
+}
+
+std::vector<Complex> polygon_integrals(const std::vector<Complex>& z,
+        const std::vector<std::vector<Complex>>& f, const Complex& s,
+        const std::vector<std::vector<Complex>>& moments,
+        std::pair<std::size_t,std::size_t> principal)
+{
+    if (f.size()!=moments.size())
+        throw std::invalid_argument{"polygon_integrals requires moments for \
+each function"};
+    for (const auto& values: f)
+        if (z.size()!=values.size())
+            throw std::invalid_argument{"polygon_integrals requires as many \
+values as vertices"};
+    // The same expressions as in `linear_over_pole` and
+    // `linear_over_pole_pv`, where only the values of f differ between the
+    // functions.
+    std::vector<Complex> result(f.size());
+    for (std::size_t k{0}; k+1<z.size(); ++k) {
+        const auto& za{z[k]};
+        const auto& zb{z[k+1]};
+        if (principal.first<=k && k<principal.second) {
+            const double logarithm{log_distance(zb,s)-log_distance(za,s)};
+            for (std::size_t i{0}; i<f.size(); ++i) {
+                const Complex slope{(f[i][k+1]-f[i][k])/(zb-za)};
+                const Complex fs{f[i][k]+slope*(s-za)};
+                result[i] += slope*(zb-za)+fs*logarithm;
+            }
+            continue;
+        }
+        const Complex w{(zb-za)/(za-s)};
+        const Complex logarithm{log1p(w)};
+        const Complex remainder{log1p_remainder(w)};
+        for (std::size_t i{0}; i<f.size(); ++i)
+            result[i] += f[i][k]*logarithm+(f[i][k+1]-f[i][k])*remainder;
+    }
+    for (std::size_t i{0}; i<f.size(); ++i) {
+        Complex power{1.0,0.0};
+        for (const auto& m: moments[i]) {
+            result[i] -= power*m;
+            power *= s;
+        }
+    }
+    return result;
+}
+
+// -- Fast Cauchy sums --------------------------------------------------------
+
+// Expansions used below, with c the center and r the half width of a box:
+//
+//  multipole: sum_j q_j/(x_j-s) = -1/r sum_k a_k (r/(s-c))^(k+1),
+//      a_k = sum_j q_j ((x_j-c)/r)^k
+//  local: sum_j q_j/(x_j-s) = sum_l b_l ((s-c)/r)^l
+//
+// Boxes interacting via expansions are separated by at least one box, such
+// that the expansions converge at least as fast as
+// (sqrt(2)/(4-sqrt(2)))^k < 0.55^k.
+
+constexpr std::size_t max_depth{20};
+
+std::uint64_t spread_bits(std::uint64_t x)
+    // Insert a zero bit in front of each of the lower 32 bits of `x`.
+{
+    x &= 0xffffffff;
+    x = (x | (x << 16)) & 0x0000ffff0000ffff;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+    x = (x | (x << 2)) & 0x3333333333333333;
+    x = (x | (x << 1)) & 0x5555555555555555;
+    return x;
+}
+
+std::uint64_t compact_bits(std::uint64_t x)
+    // Inverse of `spread_bits`.
+{
+    x &= 0x5555555555555555;
+    x = (x | (x >> 1)) & 0x3333333333333333;
+    x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0f;
+    x = (x | (x >> 4)) & 0x00ff00ff00ff00ff;
+    x = (x | (x >> 8)) & 0x0000ffff0000ffff;
+    x = (x | (x >> 16)) & 0x00000000ffffffff;
+    return x;
+}
+
+std::uint64_t morton(std::uint64_t i, std::uint64_t j)
+{
+    return spread_bits(i) | (spread_bits(j) << 1);
+}
+
+std::pair<long,long> position(std::uint64_t box)
+{
+    return {static_cast<long>(compact_bits(box)),
+        static_cast<long>(compact_bits(box >> 1))};
+}
+
+std::size_t find_box(const std::vector<std::uint64_t>& boxes,
+        std::uint64_t box)
+    // Return the index of `box` in the sorted `boxes` or `boxes.size()`.
+{
+    const auto it{std::lower_bound(boxes.cbegin(),boxes.cend(),box)};
+    if (it==boxes.cend() || *it!=box)
+        return boxes.size();
+    return std::distance(boxes.cbegin(),it);
+}
+
+std::vector<std::size_t> group(const std::vector<std::uint64_t>& codes,
+        std::vector<std::uint64_t>& boxes, std::vector<std::size_t>& offsets)
+    // Sort the indices of `codes` by the code, return them and store the
+    // distinct codes in `boxes` and the offsets of their members in
+    // `offsets`.
+{
+    std::vector<std::size_t> order(codes.size());
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),
+            [&codes](std::size_t a, std::size_t b)
+            {
+                return codes[a]<codes[b];
+            });
+    boxes.clear();
+    offsets.clear();
+    for (std::size_t k{0}; k<order.size(); ++k)
+        if (k==0 || codes[order[k]]!=codes[order[k-1]]) {
+            boxes.push_back(codes[order[k]]);
+            offsets.push_back(k);
+        }
+    offsets.push_back(order.size());
+    return order;
+}
+
+std::vector<std::uint64_t> codes(const std::vector<Complex>& points,
+        const Complex& corner, double width, std::size_t level)
+    // Return the Morton codes of the boxes of `level` containing `points`.
+{
+    const double boxes{std::ldexp(1.0,static_cast<int>(level))};
+    const auto last{static_cast<std::uint64_t>(boxes)-1};
+    std::vector<std::uint64_t> result(points.size());
+    for (std::size_t k{0}; k<points.size(); ++k) {
+        const Complex u{(points[k]-corner)/width*boxes};
+        const auto i{std::min(static_cast<std::uint64_t>(
+                    std::max(u.real(),0.0)),last)};
+        const auto j{std::min(static_cast<std::uint64_t>(
+                    std::max(u.imag(),0.0)),last)};
+        result[k] = morton(i,j);
+    }
+    return result;
+}
+
+Cauchy_sum::Cauchy_sum(const std::vector<Complex>& nodes,
+        const std::vector<Complex>& targets, double tolerance)
+    : nodes{nodes}, targets{targets}
+{
+    if (!(tolerance>0.0 && tolerance<1.0))
+        throw std::invalid_argument{"Cauchy_sum requires a tolerance in \
+(0,1)"};
+    constexpr double convergence{0.55};
+    order = static_cast<std::size_t>(
+            std::ceil(std::log(tolerance)/std::log(convergence)))+1;
+    if (nodes.empty() || targets.empty())
+        return;
+
+    // the root box covering all nodes and targets
+    double left{nodes.front().real()};
+    double right{left};
+    double bottom{nodes.front().imag()};
+    double top{bottom};
+    for (const auto& points: {std::cref(nodes),std::cref(targets)})
+        for (const auto& z: points.get()) {
+            left = std::min(left,z.real());
+            right = std::max(right,z.real());
+            bottom = std::min(bottom,z.imag());
+            top = std::max(top,z.imag());
+        }
+    width = std::max(right-left,top-bottom);
+    width = width>0.0 ? 1.001*width : 1.0;
+    corner = Complex{0.5*(left+right),0.5*(bottom+top)}
+        - Complex{0.5*width,0.5*width};
+
+    // Clustered points, e.g. many values of t close to the same node, keep
+    // the leaves crowded down to very fine levels, where the expansions cost
+    // more than they save. Hence, the leaves are refined only as long as
+    // this lowers the estimated cost.
+    std::size_t leaf_level{2};
+    build(leaf_level);
+    double estimate{cost()};
+    while (leaf_level<max_depth) {
+        build(leaf_level+1);
+        const double finer{cost()};
+        if (finer>=estimate)
+            break;
+        estimate = finer;
+        ++leaf_level;
+    }
+    if (depth()!=leaf_level)
+        build(leaf_level);
+    const double direct_cost{static_cast<double>(nodes.size())
+        *static_cast<double>(targets.size())};
+    if (direct_cost<=estimate)
+        levels.clear();
+}
+
+double Cauchy_sum::radius(std::size_t level) const noexcept
 {
+    return std::ldexp(width,-static_cast<int>(level)-1);
 }
 
-Complex Interpolate::operator()(double x) const
+Complex Cauchy_sum::center(std::uint64_t box, std::size_t level) const
+    noexcept
+{
+    const auto [i,j] = position(box);
+    const double r{radius(level)};
+    return corner+Complex{(2*i+1)*r,(2*j+1)*r};
+}
+
+void Cauchy_sum::build(std::size_t leaf_level)
+{
+    levels.assign(leaf_level-1,Level{});
+
+    // leaves
+    auto& leaves{levels.back()};
+    node_order = group(codes(nodes,corner,width,leaf_level),leaves.sources,
+            node_offsets);
+    target_order = group(codes(targets,corner,width,leaf_level),
+            leaves.targets,target_offsets);
+
+    // coarser levels
+    for (std::size_t l{levels.size()-1}; l>0; --l) {
+        auto& child{levels[l]};
+        auto& parent{levels[l-1]};
+        const auto parents{[](const std::vector<std::uint64_t>& boxes,
+                std::vector<std::uint64_t>& result,
+                std::vector<std::size_t>& indices)
+            {
+                result.clear();
+                for (const auto box: boxes)
+                    if (result.empty() || result.back()!=(box>>2))
+                        result.push_back(box>>2);
+                indices.resize(boxes.size());
+                for (std::size_t k{0}; k<boxes.size(); ++k)
+                    indices[k] = find_box(result,boxes[k]>>2);
+            }};
+        parents(child.sources,parent.sources,child.source_parents);
+        parents(child.targets,parent.targets,child.target_parents);
+    }
+
+    // interaction lists
+    for (auto& level: levels) {
+        level.interaction_offsets.assign(1,0);
+        for (const auto box: level.targets) {
+            const auto [i,j] = position(box);
+            for (long pi{i/2-1}; pi<=i/2+1; ++pi)
+                for (long pj{j/2-1}; pj<=j/2+1; ++pj)
+                    for (long ci{2*pi}; ci<2*pi+2; ++ci)
+                        for (long cj{2*pj}; cj<2*pj+2; ++cj) {
+                            if (ci<0 || cj<0)
+                                continue;
+                            if (std::abs(ci-i)<2 && std::abs(cj-j)<2)
+                                continue;
+                            const auto k{find_box(level.sources,
+                                    morton(ci,cj))};
+                            if (k<level.sources.size())
+                                level.interactions.push_back(k);
+                        }
+            level.interaction_offsets.push_back(level.interactions.size());
+        }
+    }
+
+    // neighbours of the leaves
+    near_offsets.assign(1,0);
+    near.clear();
+    for (const auto box: leaves.targets) {
+        const auto [i,j] = position(box);
+        for (long ci{i-1}; ci<=i+1; ++ci)
+            for (long cj{j-1}; cj<=j+1; ++cj) {
+                if (ci<0 || cj<0)
+                    continue;
+                const auto k{find_box(leaves.sources,morton(ci,cj))};
+                if (k<leaves.sources.size())
+                    near.push_back(k);
+            }
+        near_offsets.push_back(near.size());
+    }
+
+    const std::size_t n{2*order};
+    binomials.assign(n*n,0.0);
+    for (std::size_t a{0}; a<n; ++a) {
+        binomials[a*n] = 1.0;
+        for (std::size_t b{1}; b<=a; ++b)
+            binomials[a*n+b] = binomials[(a-1)*n+b-1]+binomials[(a-1)*n+b];
+    }
+}
+
+double Cauchy_sum::cost() const
+{
+    const double p{static_cast<double>(order)};
+    double result{p*static_cast<double>(nodes.size()+targets.size())};
+    for (const auto& level: levels)
+        result += p*p*static_cast<double>(level.interactions.size()
+                +level.sources.size()+level.targets.size());
+    const auto& leaves{levels.back()};
+    for (std::size_t t{0}; t<leaves.targets.size(); ++t) {
+        double sources{0.0};
+        for (std::size_t k{near_offsets[t]}; k<near_offsets[t+1]; ++k)
+            sources += node_offsets[near[k]+1]-node_offsets[near[k]];
+        result += sources*(target_offsets[t+1]-target_offsets[t]);
+    }
+    return result;
+}
+
+std::vector<Complex> Cauchy_sum::direct(const std::vector<Complex>& charges)
+    const
+{
+    std::vector<Complex> result(targets.size());
+    for (std::size_t i{0}; i<targets.size(); ++i)
+        for (std::size_t j{0}; j<nodes.size(); ++j)
+            result[i] += charges[j]/(nodes[j]-targets[i]);
+    return result;
+}
+
+std::vector<Complex> Cauchy_sum::operator()(
+        const std::vector<Complex>& charges) const
+{
+    if (charges.size()!=nodes.size())
+        throw std::invalid_argument{"Cauchy_sum requires one charge per \
+node"};
+    if (is_direct())
+        return direct(charges);
+
+    const std::size_t p{order};
+    const std::size_t leaf_level{depth()};
+    std::vector<Complex> power(p);
+
+    // multipole expansions of the leaves
+    std::vector<std::vector<Complex>> multipoles(levels.size());
+    {
+        const auto& leaves{levels.back()};
+        auto& a{multipoles.back()};
+        a.assign(leaves.sources.size()*p,0.0);
+        const double r{radius(leaf_level)};
+        for (std::size_t b{0}; b<leaves.sources.size(); ++b) {
+            const Complex c{center(leaves.sources[b],leaf_level)};
+            for (std::size_t k{node_offsets[b]}; k<node_offsets[b+1]; ++k) {
+                const auto j{node_order[k]};
+                const Complex xi{(nodes[j]-c)/r};
+                Complex term{charges[j]};
+                for (std::size_t m{0}; m<p; ++m) {
+                    a[b*p+m] += term;
+                    term *= xi;
+                }
+            }
+        }
+    }
+
+    // upward pass
+    for (std::size_t l{levels.size()-1}; l>0; --l) {
+        const std::size_t child_level{l+2};
+        const auto& child{levels[l]};
+        auto& a{multipoles[l-1]};
+        a.assign(levels[l-1].sources.size()*p,0.0);
+        const double r{radius(child_level-1)};
+        for (std::size_t b{0}; b<child.sources.size(); ++b) {
+            const auto parent{child.source_parents[b]};
+            const Complex delta{(center(child.sources[b],child_level)
+                    -center(levels[l-1].sources[parent],child_level-1))/r};
+            // a_l = sum_k C(l,k) delta^(l-k) a_k/2^k
+            power[0] = 1.0;
+            for (std::size_t m{1}; m<p; ++m)
+                power[m] = power[m-1]*delta;
+            const Complex* child_a{multipoles[l].data()+b*p};
+            for (std::size_t m{0}; m<p; ++m) {
+                Complex sum{0.0,0.0};
+                double half{1.0};
+                for (std::size_t k{0}; k<=m; ++k) {
+                    sum += binomial(m,k)*half*power[m-k]*child_a[k];
+                    half *= 0.5;
+                }
+                a[parent*p+m] += sum;
+            }
+        }
+    }
+
+    // downward pass
+    std::vector<Complex> local;
+    std::vector<Complex> scaled(p);
+    for (std::size_t l{0}; l<levels.size(); ++l) {
+        const std::size_t level_number{l+2};
+        const auto& level{levels[l]};
+        const double r{radius(level_number)};
+        std::vector<Complex> next(level.targets.size()*p,0.0);
+        for (std::size_t t{0}; t<level.targets.size(); ++t) {
+            Complex* b{next.data()+t*p};
+            const Complex ct{center(level.targets[t],level_number)};
+
+            // shift the expansion of the parent
+            if (l>0) {
+                const auto parent{level.target_parents[t]};
+                const Complex* parent_b{local.data()+parent*p};
+                const Complex epsilon{(ct-center(levels[l-1].targets[parent],
+                            level_number-1))/(2.0*r)};
+                power[0] = 1.0;
+                for (std::size_t m{1}; m<p; ++m)
+                    power[m] = power[m-1]*epsilon;
+                double half{1.0};
+                for (std::size_t m{0}; m<p; ++m) {
+                    Complex sum{0.0,0.0};
+                    for (std::size_t k{m}; k<p; ++k)
+                        sum += binomial(k,m)*power[k-m]*parent_b[k];
+                    b[m] += half*sum;
+                    half *= 0.5;
+                }
+            }
+
+            // translate the multipole expansions of the interaction list
+            for (std::size_t k{level.interaction_offsets[t]};
+                    k<level.interaction_offsets[t+1]; ++k) {
+                const auto source{level.interactions[k]};
+                const Complex rho{r/(ct-center(level.sources[source],
+                            level_number))};
+                const Complex* a{multipoles[l].data()+source*p};
+                Complex rho_power{1.0,0.0};
+                for (std::size_t m{0}; m<p; ++m) {
+                    scaled[m] = a[m]*rho_power;
+                    rho_power *= rho;
+                }
+                // b_l = -(-rho)^l rho/r sum_k C(k+l,l) a_k rho^k
+                Complex factor{-rho/r};
+                for (std::size_t m{0}; m<p; ++m) {
+                    Complex sum{0.0,0.0};
+                    for (std::size_t n{0}; n<p; ++n)
+                        sum += binomial(n+m,m)*scaled[n];
+                    b[m] += factor*sum;
+                    factor *= -rho;
+                }
+            }
+        }
+        local = std::move(next);
+    }
+
+    // evaluation at the targets
+    std::vector<Complex> result(targets.size());
+    const auto& leaves{levels.back()};
+    const double r{radius(leaf_level)};
+    for (std::size_t t{0}; t<leaves.targets.size(); ++t) {
+        const Complex ct{center(leaves.targets[t],leaf_level)};
+        const Complex* b{local.data()+t*p};
+        for (std::size_t k{target_offsets[t]}; k<target_offsets[t+1]; ++k) {
+            const auto i{target_order[k]};
+            const Complex eta{(targets[i]-ct)/r};
+            Complex sum{0.0,0.0};
+            for (std::size_t m{p}; m>0; --m)
+                sum = sum*eta+b[m-1];
+            for (std::size_t n{near_offsets[t]}; n<near_offsets[t+1]; ++n) {
+                const auto source{near[n]};
+                for (std::size_t q{node_offsets[source]};
+                        q<node_offsets[source+1]; ++q) {
+                    const auto j{node_order[q]};
+                    sum += charges[j]/(nodes[j]-targets[i]);
+                }
+            }
+            result[i] = sum;
+        }
+    }
+    return result;
+}
+
+std::vector<Complex> cauchy_sum(const std::vector<Complex>& nodes,
+        const std::vector<Complex>& charges,
+        const std::vector<Complex>& targets, double tolerance)
+{
+    return Cauchy_sum{nodes,targets,tolerance}(charges);
+}
+
+// -- Interpolation -----------------------------------------------------------
+
+Interpolate::Interpolate(const Interval& x,
+        const std::vector<Complex>& y, spline::Method m)
+    : spline{x,y,m}
 {
-    return Complex{real_part(x),imaginary_part(x)};
 }
 
 Interpolate sample(const Complex_function& f, const Curve& c,
-        const Interval& i, gsl::Interpolation_method m)
+        const Interval& i, spline::Method m)
 {
     std::vector<Complex> y_values(i.size());
     std::transform(i.cbegin(),i.cend(),y_values.begin(),
@@ -82,9 +763,187 @@ Interpolate sample(const Complex_function& f, const Curve& c,
     return Interpolate{i,y_values,m};
 }
 
-Interpolate sample(const Curve& c, const Interval& i,
-        gsl::Interpolation_method m)
+Interpolate sample(const Curve& c, const Interval& i, spline::Method m)
 {
     return sample(facilities::identity<Complex>,c,i,m);
 }
+
+Legendre_interpolate::Legendre_interpolate(const Interval& boundaries,
+        const std::vector<std::size_t>& sizes, const std::vector<Complex>& y)
+    : boundaries{boundaries}, offsets{0}
+{
+    if (boundaries.size()!=sizes.size()+1)
+        throw std::invalid_argument{"Legendre_interpolate requires a number \
+of knots for each interval"};
+    if (std::adjacent_find(boundaries.cbegin(),boundaries.cend(),
+                std::greater_equal<double>{})!=boundaries.cend())
+        throw std::invalid_argument{"Legendre_interpolate requires strictly \
+ascending boundaries"};
+    if (std::find(sizes.cbegin(),sizes.cend(),0)!=sizes.cend())
+        throw std::invalid_argument{"Legendre_interpolate requires at least \
+one knot per interval"};
+    if (std::accumulate(sizes.cbegin(),sizes.cend(),std::size_t{0})
+            !=y.size())
+        throw std::invalid_argument{"Legendre_interpolate requires one value \
+per knot"};
+
+    knots.reserve(y.size());
+    weights.reserve(y.size());
+    barycentric.reserve(y.size());
+    values.reserve(y.size());
+    for (const auto n: sizes) {
+        const auto first{offsets.back()};
+        const gsl::Gauss_Legendre rule{n};
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(),order.end(),0);
+        std::vector<std::pair<double,double>> points(n);
+        for (std::size_t i{0}; i<n; ++i)
+            points[i] = rule.point(0.0,1.0,i);
+        std::sort(order.begin(),order.end(),[&](std::size_t i, std::size_t j)
+                {return points[i].first<points[j].first;});
+        // the barycentric weights of the Gauss-Legendre knots are
+        // (-1)^i sqrt((1-x_i^2) w_i) on [-1,1], up to a common factor
+        double sign{1.0};
+        for (const auto i: order) {
+            const auto [u,w] = points[i];
+            knots.push_back(u);
+            weights.push_back(w);
+            barycentric.push_back(sign*std::sqrt(u*(1.0-u)*w));
+            values.push_back(y[first+i]);
+            sign = -sign;
+        }
+        offsets.push_back(first+n);
+    }
+}
+
+std::size_t Legendre_interpolate::locate(double x) const noexcept
+{
+    const auto upper{std::upper_bound(std::next(boundaries.cbegin()),
+            std::prev(boundaries.cend()),x)};
+    return static_cast<std::size_t>(
+            std::distance(std::next(boundaries.cbegin()),upper));
+}
+
+template<typename U>
+Complex Legendre_interpolate::evaluate(std::size_t k, const U& u) const
+    noexcept
+{
+    Complex numerator{0.0,0.0};
+    U denominator{0.0};
+    for (std::size_t j{offsets[k]}; j<offsets[k+1]; ++j) {
+        const U difference{u-knots[j]};
+        if (difference==0.0)
+            return values[j];
+        const U r{barycentric[j]/difference};
+        numerator += r*values[j];
+        denominator += r;
+    }
+    return numerator/denominator;
+}
+
+Complex Legendre_interpolate::operator()(double x) const
+{
+    x = std::clamp(x,boundaries.front(),boundaries.back());
+    const auto k{locate(x)};
+    return evaluate(k,(x-boundaries[k])/(boundaries[k+1]-boundaries[k]));
+}
+
+void Legendre_interpolate::operator()(const double* first, const double* last,
+        Complex* out) const
+{
+    std::transform(first,last,out,[this](double x){return (*this)(x);});
+}
+
+std::vector<Complex> Legendre_interpolate::operator()(
+        const std::vector<double>& x) const
+{
+    std::vector<Complex> result(x.size());
+    (*this)(x.data(),x.data()+x.size(),result.data());
+    return result;
+}
+
+Complex Legendre_interpolate::piece_integral(std::size_t k, const Complex& za,
+        const Complex& zb, const Complex& s, int subtractions,
+        bool principal) const
+    // With z=za+(zb-za)u, the integral reads int_0^1 du g(u)/(u-t), where
+    // g(u)=f(u)(s/z)^n and s=z(t).
+{
+    const auto first{offsets[k]};
+    const auto last{offsets[k+1]};
+    const Complex t{(s-za)/(zb-za)};
+    const auto powers{[&](const Complex& z)
+        {
+            // return (s/z)^n and ((s/z)^n-1)/(u-t) for z=z(u)
+            const Complex v{s/z};
+            Complex power{1.0,0.0};
+            Complex sum{0.0,0.0};
+            for (int m{0}; m<subtractions; ++m) {
+                sum += power;
+                power *= v;
+            }
+            return std::make_pair(power,-(zb-za)/z*sum);
+        }};
+
+    // Far from the interval, the Gauss-Legendre rule converges like
+    // rho^(-2n), rho being the parameter of the Bernstein ellipse through t,
+    // while the subtraction below amplifies rounding errors by up to rho^n.
+    const std::size_t n{last-first};
+    const Complex x{2.0*t-1.0};
+    const double rho{std::abs(x+std::sqrt(x-1.0)*std::sqrt(x+1.0))};
+    constexpr double log_epsilon{36.8}; // -log(1e-16)
+    if (!principal && 3.0*n*std::log(rho)>log_epsilon) {
+        Complex result{0.0,0.0};
+        for (std::size_t j{first}; j<last; ++j)
+            result += weights[j]*values[j]
+                * powers(za+(zb-za)*knots[j]).first/(knots[j]-t);
+        return result;
+    }
+
+    // int g(u)/(u-t) = f(t) int du/(u-t) + int (g(u)-g(t))/(u-t), the second
+    // integrand is smooth and integrated by the Gauss-Legendre rule (exactly
+    // without subtractions). Close to knot j, f(u_j)-f(t) is computed from
+    // the barycentric formula without cancellations.
+    const Complex ft{evaluate(k,t)};
+    Complex result{principal
+        ? ft*(log_distance(zb,s)-log_distance(za,s))
+        : ft*log1p((zb-za)/(za-s))};
+    constexpr double close{1e-3};
+    for (std::size_t j{first}; j<last; ++j) {
+        const Complex d{knots[j]-t};
+        Complex slope;
+        if (std::abs(d)>close) {
+            slope = (values[j]-ft)/d;
+        } else {
+            Complex numerator{0.0,0.0};
+            Complex denominator{0.0,0.0};
+            for (std::size_t i{first}; i<last; ++i) {
+                if (i==j)
+                    continue;
+                const Complex r{barycentric[i]/(t-knots[i])};
+                numerator += r*(values[j]-values[i]);
+                denominator += r;
+            }
+            slope = numerator/(d*denominator-barycentric[j]);
+        }
+        const auto [power,power_slope] = powers(za+(zb-za)*knots[j]);
+        result += weights[j]*(power*slope+ft*power_slope);
+    }
+    return result;
+}
+
+Complex Legendre_interpolate::polygon_integral(const std::vector<Complex>& z,
+        const Complex& s, int subtractions,
+        std::pair<std::size_t,std::size_t> principal) const
+{
+    if (z.size()!=boundaries.size())
+        throw std::invalid_argument{"polygon_integral requires one vertex per \
+boundary"};
+    if (subtractions>0 && s==0.0)
+        return 0.0;
+    Complex result{0.0,0.0};
+    for (std::size_t k{0}; k+1<z.size(); ++k)
+        result += piece_integral(k,z[k],z[k+1],s,subtractions,
+                principal.first<=k && k<principal.second);
+    return result;
+}
 } // cauchy
@@ -23,17 +23,159 @@ std::vector<Complex> all_points(const grid::Curve& curve)
     return first_points(curve, curve.boundaries().size());
 }
 
-bool on_second_sheet(const std::vector<Complex>& points,
-        const Complex& mandelstam_s)
+double derivative_root(const grid::Curve& curve, double lower, double upper,
+        bool imaginary)
+    // Locate the sign change of the real or imaginary part of the derivative
+    // of `curve` between `lower` and `upper`.
 {
-    const auto size{points.size()};
-    if (size == 2)
+    const auto part{[&curve,imaginary](double x)
+        {
+            const auto d{curve.derivative_func(x)};
+            return imaginary ? d.imag() : d.real();
+        }};
+    const bool lower_sign{part(lower)<0.0};
+    for (int i{0}; i<100; ++i) {
+        const double middle{0.5*(lower+upper)};
+        if (middle==lower || middle==upper)
+            break;
+        if ((part(middle)<0.0)==lower_sign)
+            lower = middle;
+        else
+            upper = middle;
+    }
+    return 0.5*(lower+upper);
+}
+
+std::vector<double> monotonic_parameters(const grid::Curve& curve,
+        const std::vector<double>& x)
+    // Insert the parameters, where the real or the imaginary part of `curve`
+    // has an extremum, between neighbouring elements of `x`. In between the
+    // resulting parameters, both parts are monotonic unless they have several
+    // extrema between neighbouring elements of `x`.
+{
+    std::vector<Complex> values(x.size());
+    std::vector<Complex> derivatives(x.size());
+    curve.evaluate(x.data(),x.data()+x.size(),values.data(),
+            derivatives.data());
+    std::vector<double> result{x.front()};
+    for (std::size_t i{1}; i<x.size(); ++i) {
+        std::vector<double> extrema;
+        const auto& a{derivatives[i-1]};
+        const auto& b{derivatives[i]};
+        if (a.real()*b.real()<0.0)
+            extrema.push_back(derivative_root(curve,x[i-1],x[i],false));
+        if (a.imag()*b.imag()<0.0)
+            extrema.push_back(derivative_root(curve,x[i-1],x[i],true));
+        std::sort(extrema.begin(),extrema.end());
+        for (const auto e: extrema)
+            if (e>result.back() && e<x[i])
+                result.push_back(e);
+        result.push_back(x[i]);
+    }
+    return result;
+}
+
+Region::Region(const grid::Curve& curve, std::size_t samples,
+        Curve_function curve_func)
+    : curve_func{std::move(curve_func)}
+{
+    if (samples==0)
+        throw std::invalid_argument{"Each piece needs at least one edge."};
+    std::vector<Complex> points;
+    std::vector<double> x;
+    const bool curved{!curve.is_linear()};
+    if (curved) {
+        const auto boundaries{curve.boundaries()};
+        x.reserve((boundaries.size()-1)*samples+1);
+        for (std::size_t i{0}; i+1<boundaries.size(); ++i)
+            for (std::size_t k{0}; k<samples; ++k)
+                x.push_back(boundaries[i]
+                        +(boundaries[i+1]-boundaries[i])*k/samples);
+        x.push_back(boundaries.back());
+        x = monotonic_parameters(curve,x);
+        points.resize(x.size());
+        std::vector<Complex> derivatives(x.size());
+        curve.evaluate(x.data(),x.data()+x.size(),points.data(),
+                derivatives.data());
+    } else {
+        points = all_points(curve);
+    }
+    // The polygon is closed along the real axis, which is horizontal.
+    real_lower = points.front().real();
+    real_upper = points.front().real();
+    imag_lower = 0.0;
+    for (std::size_t i{1}; i<points.size(); ++i) {
+        const auto& a{points[i-1]};
+        const auto& b{points[i]};
+        real_lower = std::min(real_lower,b.real());
+        real_upper = std::max(real_upper,b.real());
+        imag_lower = std::min(imag_lower,b.imag());
+        if (a.imag()==b.imag())
+            continue;
+        Edge e{std::min(a.imag(),b.imag()),std::max(a.imag(),b.imag()),
+            a.real(),a.imag(),(b.real()-a.real())/(b.imag()-a.imag())};
+        if (curved) {
+            e.piece = pieces.size();
+            pieces.push_back({x[i-1],x[i],b,std::min(a.real(),b.real()),
+                    std::max(a.real(),b.real())});
+        }
+        edges.push_back(e);
+    }
+    const auto& last{points.back()};
+    if (last.imag()!=0.0)
+        edges.push_back({std::min(last.imag(),0.0),std::max(last.imag(),0.0),
+                last.real(),last.imag(),0.0});
+}
+
+bool Region::crosses_curve(const Edge& e, const Piece& p,
+        const Complex& s) const
+{
+    // The piece of the curve is monotonic in both parts, such that it lies in
+    // the box spanned by the ends of any of its parts. Bisection shrinks the
+    // part containing the crossing until `s` lies outside of its box.
+    double lower{p.parameter_start};
+    double upper{p.parameter_end};
+    Complex start{e.real_start,e.imag_start};
+    Complex end{p.end};
+    const bool start_above{start.imag()>s.imag()};
+    while (true) {
+        const double middle{0.5*(lower+upper)};
+        if (middle==lower || middle==upper)
+            return s.real()<0.5*(start.real()+end.real());
+        const Complex value{curve_func(middle)};
+        if ((value.imag()>s.imag())==start_above) {
+            lower = middle;
+            start = value;
+        } else {
+            upper = middle;
+            end = value;
+        }
+        if (s.real()<std::min(start.real(),end.real()))
+            return true;
+        if (s.real()>=std::max(start.real(),end.real()))
+            return false;
+    }
+}
+
+bool Region::contains(const Complex& s) const
+{
+    if (!in_bounds(s))
         return false;
-    if (size > 3)
-        return points[0].real() < mandelstam_s.real()
-            && mandelstam_s.real() < points[3].real()
-            && points[1].imag() < mandelstam_s.imag()
-            && mandelstam_s.imag() < 0.0;
-    throw std::runtime_error{"Don't know how to handle this case"};
+    bool inside{false};
+    for (const auto& e: edges)
+        inside ^= crosses(e,s);
+    return inside;
+}
+
+std::vector<bool> Region::contains(const std::vector<Complex>& s) const
+{
+    std::vector<char> inside(s.size(),0);
+    for (const auto& e: edges)
+        for (std::size_t k{0}; k<s.size(); ++k)
+            inside[k] ^= crosses(e,s[k]);
+    std::vector<bool> result(s.size());
+    for (std::size_t k{0}; k<s.size(); ++k)
+        result[k] = inside[k] && in_bounds(s[k]);
+    return result;
 }
 } // curved_omnes
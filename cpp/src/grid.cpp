@@ -1,5 +1,7 @@
 #include "grid.h"
 
+#include "Eigen/Dense"
+
 namespace grid {
 std::vector<Complex> boundary_points(const Curve& c)
 {
@@ -11,7 +13,44 @@ std::vector<Complex> boundary_points(const Curve& c)
     return points;
 }
 
-Knots generate_knots(double start, double end, std::size_t points)
+void Curve::evaluate(const double* first, const double* last,
+        Complex* values, Complex* derivatives) const
+{
+    for (; first!=last; ++first, ++values, ++derivatives) {
+        *values = curve_func(*first);
+        *derivatives = derivative_func(*first);
+    }
+}
+
+Sampling_points<Complex> sample_curve(const Curve& c,
+        const std::vector<double>& boundaries,
+        const std::vector<std::size_t>& points, const std::vector<Rule>& rules)
+{
+    if (boundaries.size() != points.size()+1)
+        throw std::invalid_argument{"Each segment requires a number of knots."};
+    if (rules.size() != points.size())
+        throw std::invalid_argument{"Each segment requires a rule."};
+    Sampling_points<Complex> result;
+    std::vector<double> parameters;
+    std::vector<Complex> values;
+    std::vector<Complex> derivatives;
+    for (std::size_t i{0}; i<points.size(); ++i) {
+        const auto knots{generate_knots(boundaries[i],boundaries[i+1],
+                points[i],rules[i])};
+        parameters.resize(knots.size());
+        values.resize(knots.size());
+        derivatives.resize(knots.size());
+        for (std::size_t k{0}; k<knots.size(); ++k)
+            parameters[k] = knots[k].first;
+        c.evaluate(parameters.data(),parameters.data()+parameters.size(),
+                values.data(),derivatives.data());
+        for (std::size_t k{0}; k<knots.size(); ++k)
+            result.emplace_back(values[k],knots[k].second,derivatives[k]);
+    }
+    return result;
+}
+
+Knots gauss_legendre_knots(double start, double end, std::size_t points)
 {
     const gsl::Gauss_Legendre g{points};
     Knots path(points);
@@ -19,4 +58,199 @@ Knots generate_knots(double start, double end, std::size_t points)
         path[i] = g.point(start,end,i);
     return path;
 }
+
+Knots fejer_knots(double start, double end, std::size_t points)
+{
+    // x_k = -cos(theta_k) with theta_k = k pi/(n+1), the weights follow from
+    // integrating the Chebyshev series of the interpolating polynomial.
+    const double pi{std::acos(-1.0)};
+    const double center{0.5*(start+end)};
+    const double half{0.5*(end-start)};
+    Knots path(points);
+    for (std::size_t k{1}; k<=points; ++k) {
+        const double theta{k*pi/(points+1)};
+        double sum{0.0};
+        for (std::size_t j{1}; 2*j-1<=points; ++j)
+            sum += std::sin((2*j-1)*theta)/(2*j-1);
+        path[k-1] = {center-half*std::cos(theta),
+            half*4.0*std::sin(theta)*sum/(points+1)};
+    }
+    return path;
+}
+
+Knots clenshaw_curtis_knots(double start, double end, std::size_t points)
+{
+    if (points<2)
+        throw std::invalid_argument{"Clenshaw-Curtis requires at least two \
+points"};
+    // x_k = -cos(theta_k) with theta_k = k pi/n, k=0,...,n
+    const double pi{std::acos(-1.0)};
+    const double center{0.5*(start+end)};
+    const double half{0.5*(end-start)};
+    const std::size_t n{points-1};
+    Knots path(points);
+    for (std::size_t k{0}; k<=n; ++k) {
+        const double theta{k*pi/n};
+        double sum{0.0};
+        for (std::size_t j{1}; 2*j<=n; ++j) {
+            const double b{2*j==n ? 1.0 : 2.0};
+            sum += b*std::cos(2*j*theta)/(4.0*j*j-1.0);
+        }
+        const double c{k==0 || k==n ? 1.0 : 2.0};
+        path[k] = {center-half*std::cos(theta),half*c*(1.0-sum)/n};
+    }
+    return path;
+}
+
+Knots gauss_jacobi_knots(double start, double end, std::size_t points,
+        double alpha, double beta)
+{
+    // Golub-Welsch for the weight (1-u)^alpha (1+u)^beta on [-1,1], the
+    // weight is divided out afterwards.
+    if (points==0)
+        return {};
+    const double ab{alpha+beta};
+    Eigen::VectorXd diagonal(points);
+    Eigen::VectorXd off_diagonal(points>1 ? points-1 : 0);
+    diagonal(0) = (beta-alpha)/(ab+2.0);
+    for (std::size_t n{1}; n<points; ++n) {
+        const double m{2.0*n+ab};
+        diagonal(n) = (beta*beta-alpha*alpha)/(m*(m+2.0));
+    }
+    if (points>1)
+        off_diagonal(0) = std::sqrt(4.0*(1.0+alpha)*(1.0+beta)
+                /((ab+2.0)*(ab+2.0)*(ab+3.0)));
+    for (std::size_t n{2}; n<points; ++n) {
+        const double m{2.0*n+ab};
+        off_diagonal(n-1) = std::sqrt(4.0*n*(n+alpha)*(n+beta)*(n+ab)
+                /(m*m*(m+1.0)*(m-1.0)));
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver;
+    solver.computeFromTridiagonal(diagonal,off_diagonal);
+    const double mu{std::exp((ab+1.0)*std::log(2.0)+std::lgamma(alpha+1.0)
+            +std::lgamma(beta+1.0)-std::lgamma(ab+2.0))};
+
+    const double center{0.5*(start+end)};
+    const double half{0.5*(end-start)};
+    Knots path(points);
+    for (std::size_t k{0}; k<points; ++k) {
+        const double u{solver.eigenvalues()(k)};
+        const double v{solver.eigenvectors()(0,k)};
+        path[k] = {center+half*u,half*mu*v*v
+            /(std::pow(1.0-u,alpha)*std::pow(1.0+u,beta))};
+    }
+    return path;
+}
+
+Knots graded_knots(double start, double end, std::size_t points,
+        std::size_t levels, double ratio, bool at_start)
+{
+    if (points<levels+1)
+        throw std::invalid_argument{"The graded rule requires at least one \
+point per interval"};
+    // the boundaries of the intervals relative to [0,1], refined at 0
+    std::vector<double> boundaries{0.0};
+    for (std::size_t l{levels}; l>0; --l)
+        boundaries.push_back(std::pow(ratio,l));
+    boundaries.push_back(1.0);
+    if (!at_start) {
+        std::reverse(boundaries.begin(),boundaries.end());
+        for (auto& b: boundaries)
+            b = 1.0-b;
+    }
+
+    Knots path;
+    const std::size_t intervals{levels+1};
+    const std::size_t extra{points%intervals};
+    for (std::size_t i{0}; i<intervals; ++i) {
+        // the longest intervals get the remaining points
+        const bool longer{at_start ? i+extra>=intervals : i<extra};
+        const auto part{gauss_legendre_knots(
+                start+(end-start)*boundaries[i],
+                start+(end-start)*boundaries[i+1],
+                points/intervals+(longer ? 1 : 0))};
+        path.insert(path.end(),part.cbegin(),part.cend());
+    }
+    return path;
+}
+
+Rule Rule::gauss_jacobi(double start_exponent, double end_exponent)
+{
+    if (start_exponent<=-1.0 || end_exponent<=-1.0)
+        throw std::invalid_argument{"The exponents of Gauss-Jacobi need to \
+be larger than -1"};
+    Rule r{Quadrature::gauss_jacobi};
+    r.start_exponent = start_exponent;
+    r.end_exponent = end_exponent;
+    return r;
+}
+
+Rule Rule::graded(std::size_t levels, double ratio, bool at_start)
+{
+    if (ratio<=0.0 || ratio>=1.0)
+        throw std::invalid_argument{"The ratio of the graded rule needs to \
+lie in (0,1)"};
+    Rule r{Quadrature::graded};
+    r.levels = levels;
+    r.ratio = ratio;
+    r.at_start = at_start;
+    return r;
+}
+
+Rule Rule::z_rule() const noexcept
+{
+    return _quadrature==Quadrature::fejer ? Rule{Quadrature::fejer} : Rule{};
+}
+
+Knots Rule::knots(double start, double end, std::size_t points) const
+{
+    switch (_quadrature) {
+        case Quadrature::gauss_legendre:
+            return gauss_legendre_knots(start,end,points);
+        case Quadrature::fejer:
+            return fejer_knots(start,end,points);
+        case Quadrature::gauss_jacobi:
+            // u=-1 corresponds to `start`
+            return gauss_jacobi_knots(start,end,points,end_exponent,
+                    start_exponent);
+        case Quadrature::graded:
+            return graded_knots(start,end,points,levels,ratio,at_start);
+        case Quadrature::clenshaw_curtis:
+            return clenshaw_curtis_knots(start,end,points);
+        default:
+            throw std::invalid_argument{"Unknown quadrature rule."};
+    }
+}
+
+Knots generate_knots(double start, double end, std::size_t points,
+        const Rule& rule)
+{
+    return rule.knots(start,end,points);
+}
+
+double legendre_tail(const Complex* values, std::size_t size)
+{
+    if (size<2)
+        throw std::invalid_argument{"legendre_tail requires at least two \
+values"};
+    // c_k = (2k+1)/2 sum_i w_i P_k(x_i) f(x_i) is exact for the interpolating
+    // polynomial, P_k is evaluated via the three-term recurrence.
+    const gsl::Gauss_Legendre g{size};
+    Complex last{0.0,0.0};
+    Complex second_last{0.0,0.0};
+    for (std::size_t i{0}; i<size; ++i) {
+        const auto [x,w] = g.point(-1.0,1.0,i);
+        double previous{1.0};
+        double current{x};
+        for (std::size_t k{1}; k+1<size; ++k) {
+            const double next{((2.0*k+1.0)*x*current-k*previous)/(k+1.0)};
+            previous = current;
+            current = next;
+        }
+        last += w*current*values[i];
+        second_last += w*previous*values[i];
+    }
+    return std::max((size-0.5)*std::abs(last),
+            (size-1.5)*std::abs(second_last));
+}
 } // grid
@@ -40,6 +40,103 @@ double unwrap(double x, void* p)
     return (*fp)(x);
 }
 
+Function finite_interval(const Function& f, double& lower, double& upper)
+    // If [`lower`,`upper`] is infinite, return the integrand for the change of
+    // variables mapping it onto [0,1] and adjust `lower` and `upper`
+    // accordingly. Otherwise return `f`.
+{
+    const bool lower_inf{std::isinf(lower)};
+    const bool upper_inf{std::isinf(upper)};
+
+    Function integrand{f};
+    if (lower_inf && upper_inf) {
+        integrand = [&f](double x){return (f((1-x)/x) + f((x-1)/x)) / (x*x);};
+        lower = 0.0;
+        upper = 1.0;
+    }
+    else if (lower_inf) {
+        integrand = [&f,upper](double x){return f(upper+(x-1)/x) / (x*x);};
+        lower = 0.0;
+        upper = 1.0;
+    }
+    else if (upper_inf) {
+        integrand = [&f,lower](double x){return f(lower+(1-x)/x) / (x*x);};
+        lower = 0.0;
+        upper = 1.0;
+    }
+    return integrand;
+}
+
+
+Batch_function finite_interval(const Batch_function& f, double& lower,
+        double& upper)
+    // Batch version of `finite_interval` for `Function`.
+{
+    const bool lower_inf{std::isinf(lower)};
+    const bool upper_inf{std::isinf(upper)};
+    if (!lower_inf && !upper_inf)
+        return f;
+
+    Batch_function integrand{
+        [&f,lower_inf,upper_inf,lower,upper](const std::vector<double>& x)
+        {
+            const std::size_t n{x.size()};
+            std::vector<double> mapped(lower_inf && upper_inf ? 2*n : n);
+            for (std::size_t i{0}; i<n; ++i) {
+                if (lower_inf && upper_inf) {
+                    mapped[i] = (1-x[i])/x[i];
+                    mapped[n+i] = (x[i]-1)/x[i];
+                }
+                else if (lower_inf)
+                    mapped[i] = upper+(x[i]-1)/x[i];
+                else
+                    mapped[i] = lower+(1-x[i])/x[i];
+            }
+            const std::vector<double> values{f(mapped)};
+            std::vector<double> result(n);
+            for (std::size_t i{0}; i<n; ++i) {
+                const double sum{lower_inf && upper_inf
+                    ? values[i]+values[n+i] : values[i]};
+                result[i] = sum/(x[i]*x[i]);
+            }
+            return result;
+        }};
+    lower = 0.0;
+    upper = 1.0;
+    return integrand;
+}
+
+void check_points(const Interval& points)
+    // Check the invariants of breakpoints passed to integration routines.
+{
+    if (points.size()<2)
+        throw std::invalid_argument{"integration requires at least two \
+points"};
+    if (!std::is_sorted(points.begin(),points.end()))
+        throw std::invalid_argument{"the points of integration need to be \
+sorted in ascending order"};
+}
+
+Value Integration::batch(const Batch_function& f, double lower,
+        double upper) const
+{
+    return (*this)(facilities::scalarize(f),lower,upper);
+}
+
+Value Integration::operator()(Function f, const Interval& points) const
+{
+    check_points(points);
+    Value result{0.0,0.0};
+    for (std::size_t i{1}; i<points.size(); ++i) {
+        if (points[i-1]==points[i])
+            continue;
+        const Value piece{(*this)(f,points[i-1],points[i])};
+        result.first += piece.first;
+        result.second += piece.second;
+    }
+    return result;
+}
+
 
 // -- Integration: Gauss-Legendre  --------------------------------------------
 
@@ -155,6 +252,26 @@ Value Qag::operator()(Function f, double lower, double upper) const
     return Value{sign*result,error};
 }
 
+Value Qag::operator()(Function f, const Interval& points) const
+{
+    check_points(points);
+    if (std::isinf(points.front()) || std::isinf(points.back()))
+        return Integration::operator()(f,points);
+
+    gsl_function wrapper;
+    wrapper.function = unwrap;
+    wrapper.params = &f;
+
+    double result{0.0};
+    double error{0.0};
+    // `gsl_integration_qagp` takes a mutable array including the endpoints.
+    Interval breakpoints{points};
+    call(gsl_integration_qagp,&wrapper,breakpoints.data(),breakpoints.size(),
+            absolute_precision,relative_precision,limit,workspace.data(),
+            &result,&error);
+    return Value{result,error};
+}
+
 void Qag::reserve(std::size_t space)
 {
     workspace.reserve(space);
@@ -172,28 +289,10 @@ Value Cquad::operator()(Function f, double lower, double upper) const
 {
     int sign{signed_interval(lower,upper) ? 1 : -1};
 
-    bool lower_inf{std::isinf(lower)};
-    bool upper_inf{std::isinf(upper)};
-
     // `gsl_integration_cquad` does not provide functions for the integration
     // of infinite intervals. Hence, the required change of variables is
     // performed explicitly.
-    Function integrand{f};
-    if (lower_inf && upper_inf) {
-        integrand = [&f](double x){return (f((1-x)/x) + f((x-1)/x)) / (x*x);};
-        lower = 0.0;
-        upper = 1.0;
-    }
-    else if (lower_inf) {
-        integrand = [&f,upper](double x){return f(upper+(x-1)/x) / (x*x);};
-        lower = 0.0;
-        upper = 1.0;
-    }
-    else if (upper_inf) {
-        integrand = [&f,lower](double x){return f(lower+(1-x)/x) / (x*x);};
-        lower = 0.0;
-        upper = 1.0;
-    }
+    Function integrand{finite_interval(f,lower,upper)};
 
     gsl_function wrapper;
     wrapper.function = unwrap;
@@ -212,6 +311,415 @@ void Cquad::reserve(std::size_t space)
     workspace.reserve(space);
 }
 
+Tanh_sinh::Tanh_sinh(const Settings& set)
+: absolute_precision{set.absolute_precision},
+    relative_precision{set.relative_precision},
+    evaluations{set.space}
+{
+}
+
+Value Tanh_sinh::operator()(Function f, double lower, double upper) const
+{
+    return batch(facilities::vectorize(std::move(f)),lower,upper);
+}
+
+Value Tanh_sinh::batch(const Batch_function& f, double lower,
+        double upper) const
+{
+    int sign{signed_interval(lower,upper) ? 1 : -1};
+    Batch_function integrand{finite_interval(f,lower,upper)};
+
+    // Beyond `t_max`, the abscissae are closer than 1e-37 (relative to the
+    // length of the interval) to the endpoints.
+    constexpr double t_max{4.0};
+    const double half_pi{std::acos(0.0)};
+    const double half{(upper-lower)/2.0};
+
+    std::size_t count{0};
+    std::vector<double> abscissae;
+    std::vector<double> weights;
+    const auto add_level{[&](double first, double step)
+        {
+            for (double t{first}; t<=t_max; t+=step) {
+                // The distance of the abscissae to the endpoints is computed
+                // directly to avoid cancellations in 1-tanh(u).
+                const double u{half_pi*std::sinh(t)};
+                const double complement{2.0/(1.0+std::exp(2.0*u))};
+                const double cosh_u{std::cosh(u)};
+                const double weight{half_pi*std::cosh(t)/(cosh_u*cosh_u)};
+                const double left{lower+half*complement};
+                const double right{upper-half*complement};
+                if (left>lower) {
+                    abscissae.push_back(left);
+                    weights.push_back(weight);
+                }
+                if (right<upper) {
+                    abscissae.push_back(right);
+                    weights.push_back(weight);
+                }
+            }
+        }};
+    const auto evaluate{[&]()
+        {
+            // All abscissae of one level are passed to `integrand` at once.
+            count += abscissae.size();
+            const std::vector<double> values{integrand(abscissae)};
+            const double sum{std::inner_product(weights.cbegin(),
+                    weights.cend(),values.cbegin(),0.0)};
+            abscissae.clear();
+            weights.clear();
+            return sum;
+        }};
+
+    abscissae.push_back(lower+half);
+    weights.push_back(half_pi);
+    add_level(1.0,1.0);
+    double sum{evaluate()};
+    double previous{sum*half};
+
+    double step{1.0};
+    while (true) {
+        step /= 2.0;
+        add_level(step,2.0*step);
+        sum += evaluate();
+        const double current{sum*step*half};
+        const double error{std::abs(current-previous)};
+        if (error<=std::max(absolute_precision,
+                    relative_precision*std::abs(current)))
+            return Value{sign*current,error};
+        if (count>evaluations)
+            throw Subdivision_error{"maximal number of function evaluations \
+exceeded"};
+        previous = current;
+    }
+}
+
+Gauss_Jacobi::Gauss_Jacobi(const Settings& set)
+: absolute_precision{set.absolute_precision},
+    relative_precision{set.relative_precision},
+    exponent_lower{set.lower_exponent},
+    exponent_upper{set.upper_exponent},
+    maximal_size{set.space}
+{
+    if (exponent_lower<=-1.0 || exponent_upper<=-1.0)
+        throw std::invalid_argument{"the exponents of the Gauss-Jacobi weight \
+function need to exceed -1"};
+}
+
+const Gauss_Jacobi::Rule& Gauss_Jacobi::rule(double at_lower,
+        double at_upper, std::size_t level) const
+{
+    auto family{std::find_if(families.begin(),families.end(),
+            [=](const Family& f)
+            {
+                return f.lower==at_lower && f.upper==at_upper;
+            })};
+    if (family==families.end()) {
+        families.push_back(Family{at_lower,at_upper,{}});
+        family = std::prev(families.end());
+    }
+
+    auto& rules{family->rules};
+    while (rules.size()<=level) {
+        const std::size_t n{smallest_rule<<rules.size()};
+        // The GSL weight function on [a,b] reads (b-x)^alpha (x-a)^beta.
+        const std::unique_ptr<gsl_integration_fixed_workspace,Fixed_deleter>
+            fixed{gsl_integration_fixed_alloc(gsl_integration_fixed_jacobi,n,
+                    -1.0,1.0,at_upper,at_lower)};
+        if (!fixed)
+            throw Allocation_error{"could not compute Gauss-Jacobi rule"};
+        const double* nodes{gsl_integration_fixed_nodes(fixed.get())};
+        const double* weights{gsl_integration_fixed_weights(fixed.get())};
+
+        Rule r{std::vector<double>(nodes,nodes+n),std::vector<double>(n)};
+        for (std::size_t i{0}; i<n; ++i) {
+            const double t{r.nodes[i]};
+            r.weights[i] = weights[i] / std::pow(1.0-t,at_upper)
+                / std::pow(1.0+t,at_lower);
+        }
+        rules.push_back(std::move(r));
+    }
+    return rules[level];
+}
+
+Value Gauss_Jacobi::operator()(Function f, double lower, double upper) const
+{
+    return integrate(facilities::vectorize(std::move(f)),lower,upper,
+            exponent_lower,exponent_upper);
+}
+
+Value Gauss_Jacobi::batch(const Batch_function& f, double lower,
+        double upper) const
+{
+    return integrate(f,lower,upper,exponent_lower,exponent_upper);
+}
+
+Value Gauss_Jacobi::operator()(Function f, const Interval& points) const
+{
+    check_points(points);
+    const Batch_function vectorized{facilities::vectorize(std::move(f))};
+    const std::size_t last{points.size()-1};
+    Value result{0.0,0.0};
+    for (std::size_t i{1}; i<=last; ++i) {
+        if (points[i-1]==points[i])
+            continue;
+        const Value piece{integrate(vectorized,points[i-1],points[i],
+                i==1 ? exponent_lower : 0.0,
+                i==last ? exponent_upper : 0.0)};
+        result.first += piece.first;
+        result.second += piece.second;
+    }
+    return result;
+}
+
+Value Gauss_Jacobi::integrate(const Batch_function& f, double lower,
+        double upper,
+        double at_lower, double at_upper) const
+{
+    int sign{signed_interval(lower,upper) ? 1 : -1};
+
+    // After the change of variables, the finite endpoint is mapped to 1, while
+    // nothing is known about the behaviour at 0.
+    if (std::isinf(lower) && std::isinf(upper))
+        at_lower = at_upper = 0.0;
+    else if (std::isinf(lower))
+        at_lower = 0.0;
+    else if (std::isinf(upper)) {
+        at_upper = at_lower;
+        at_lower = 0.0;
+    }
+    Batch_function integrand{finite_interval(f,lower,upper)};
+
+    const double half{(upper-lower)/2.0};
+    const auto apply{[&](const Rule& r)
+        {
+            std::vector<double> x(r.nodes.size());
+            std::transform(r.nodes.cbegin(),r.nodes.cend(),x.begin(),
+                    [&](double t)
+                    {
+                        return t<0.0 ? lower+half*(1.0+t) : upper-half*(1.0-t);
+                    });
+            const std::vector<double> values{integrand(x)};
+            return std::inner_product(r.weights.cbegin(),r.weights.cend(),
+                    values.cbegin(),0.0)*half;
+        }};
+
+    double previous{apply(rule(at_lower,at_upper,0))};
+    for (std::size_t level{1}; ; ++level) {
+        if (smallest_rule<<level > maximal_size)
+            throw Subdivision_error{"maximal number of points exceeded"};
+        const double current{apply(rule(at_lower,at_upper,level))};
+        const double error{std::abs(current-previous)};
+        if (error<=std::max(absolute_precision,
+                    relative_precision*std::abs(current)))
+            return Value{sign*current,error};
+        previous = current;
+    }
+}
+
+Value kronrod(const Batch_function& f, double lower, double upper)
+    // Apply the 15-point Gauss-Kronrod rule to [`lower`,`upper`], `f` is
+    // called once. Return the Kronrod estimate and the error estimate of
+    // QUADPACK's qk15, i.e. the difference to the embedded 7-point Gauss
+    // rule scaled by the deviation of `f` from its mean and bounded from
+    // below by the roundoff.
+{
+    constexpr std::array<double,8> nodes{
+        0.991455371120812639206854697526329,
+        0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926,
+        0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013,
+        0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245,
+        0.000000000000000000000000000000000};
+    constexpr std::array<double,8> kronrod_weights{
+        0.022935322010529224963732008058970,
+        0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518,
+        0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550,
+        0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649,
+        0.209482141084727828012999174891714};
+    // Gauss weights belonging to the odd entries of `nodes`.
+    constexpr std::array<double,4> gauss_weights{
+        0.129484966168869693270611432679082,
+        0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975,
+        0.417959183673469387755102040816327};
+
+    const double center{(lower+upper)/2.0};
+    const double half{(upper-lower)/2.0};
+
+    std::vector<double> x(15,center);
+    for (std::size_t i{0}; i<7; ++i) {
+        x[2*i] -= half*nodes[i];
+        x[2*i+1] += half*nodes[i];
+    }
+    const std::vector<double> values{f(x)};
+
+    double kronrod_sum{kronrod_weights[7]*values[14]};
+    double gauss_sum{gauss_weights[3]*values[14]};
+    for (std::size_t i{0}; i<7; ++i) {
+        const double sum{values[2*i] + values[2*i+1]};
+        kronrod_sum += kronrod_weights[i]*sum;
+        if (i%2)
+            gauss_sum += gauss_weights[i/2]*sum;
+    }
+
+    const double mean{kronrod_sum/2.0};
+    double absolute_sum{kronrod_weights[7]*std::abs(values[14])};
+    double deviation{kronrod_weights[7]*std::abs(values[14]-mean)};
+    for (std::size_t i{0}; i<7; ++i) {
+        absolute_sum += kronrod_weights[i]
+            *(std::abs(values[2*i])+std::abs(values[2*i+1]));
+        deviation += kronrod_weights[i]
+            *(std::abs(values[2*i]-mean)+std::abs(values[2*i+1]-mean));
+    }
+    absolute_sum *= std::abs(half);
+    deviation *= std::abs(half);
+
+    constexpr double epsilon{std::numeric_limits<double>::epsilon()};
+    double error{std::abs((kronrod_sum-gauss_sum)*half)};
+    if (deviation!=0.0 && error!=0.0)
+        error = deviation*std::min(1.0,std::pow(200.0*error/deviation,1.5));
+    if (absolute_sum>std::numeric_limits<double>::min()/(50.0*epsilon))
+        error = std::max(50.0*epsilon*absolute_sum,error);
+    return Value{kronrod_sum*half,error};
+}
+
+Warm_start::Warm_start(const Settings& set)
+: absolute_precision{set.absolute_precision},
+    relative_precision{set.relative_precision},
+    limit{set.space}
+{
+}
+
+std::vector<double>& Warm_start::partition(double lower, double upper,
+        double mapped_lower, double mapped_upper) const
+{
+    auto cached{std::find_if(partitions.begin(),partitions.end(),
+            [=](const Partition& p)
+            {
+                return p.lower==lower && p.upper==upper;
+            })};
+    if (cached!=partitions.end())
+        return cached->points;
+
+    if (partitions.size()>=cached_intervals)
+        partitions.erase(partitions.begin());
+    partitions.push_back(Partition{lower,upper,{mapped_lower,mapped_upper}});
+    return partitions.back().points;
+}
+
+Value Warm_start::operator()(Function f, double lower, double upper) const
+{
+    return batch(facilities::vectorize(std::move(f)),lower,upper);
+}
+
+Value Warm_start::batch(const Batch_function& f, double lower,
+        double upper) const
+{
+    int sign{signed_interval(lower,upper) ? 1 : -1};
+    const double key_lower{lower};
+    const double key_upper{upper};
+    Batch_function integrand{finite_interval(f,lower,upper)};
+    std::vector<double>& points{partition(key_lower,key_upper,lower,upper)};
+
+    struct Panel {
+        double lower;
+        double upper;
+        Value estimate;
+    };
+    std::vector<Panel> panels;
+    panels.reserve(points.size()-1);
+    for (std::size_t i{1}; i<points.size(); ++i)
+        panels.push_back(Panel{points[i-1],points[i],
+                kronrod(integrand,points[i-1],points[i])});
+
+    double value{0.0};
+    double error{0.0};
+    double tolerance{0.0};
+    while (true) {
+        value = error = 0.0;
+        for (const auto& p: panels) {
+            value += p.estimate.first;
+            error += p.estimate.second;
+        }
+        tolerance = std::max(absolute_precision,
+                relative_precision*std::abs(value));
+        if (error<=tolerance)
+            break;
+        if (panels.size()>=limit)
+            throw Subdivision_error{"maximal number of subintervals \
+exceeded"};
+
+        // Bisect the subinterval with the largest error.
+        const auto worst{std::max_element(panels.begin(),panels.end(),
+                [](const Panel& a, const Panel& b)
+                {
+                    return a.estimate.second<b.estimate.second;
+                })};
+        const double a{worst->lower};
+        const double b{worst->upper};
+        const double middle{(a+b)/2.0};
+        if (middle<=a || middle>=b)
+            throw Roundoff_error{"subintervals cannot be bisected any further"};
+        *worst = Panel{a,middle,kronrod(integrand,a,middle)};
+        panels.insert(std::next(worst),
+                Panel{middle,b,kronrod(integrand,middle,b)});
+    }
+
+    // Merge neighbours with negligible errors, such that the cached partition
+    // does not only grow along a scan.
+    const double negligible{tolerance/(16.0*panels.size())};
+    points.assign(1,panels.front().lower);
+    for (std::size_t i{0}; i<panels.size(); ++i) {
+        if (i+1<panels.size() && panels[i].estimate.second
+                +panels[i+1].estimate.second<negligible)
+            ++i;
+        points.push_back(panels[i].upper);
+    }
+    return Value{sign*value,error};
+}
+
+// -- Integration: principal values -------------------------------------------
+
+Principal_value::Principal_value(const Settings& set)
+: absolute_precision{set.absolute_precision},
+    relative_precision{set.relative_precision},
+    limit{set.space},
+    workspace{set.space}
+{
+}
+
+Value Principal_value::operator()(Function f, double lower, double upper,
+        double singularity) const
+{
+    if (std::isinf(lower) || std::isinf(upper))
+        throw std::invalid_argument{"principal value integrals require a \
+finite interval"};
+
+    gsl_function wrapper;
+    wrapper.function = unwrap;
+    wrapper.params = &f;
+
+    double result{0.0};
+    double error{0.0};
+    // `gsl_integration_qawc` takes care of the orientation of the interval.
+    call(gsl_integration_qawc,&wrapper,lower,upper,singularity,
+            absolute_precision,relative_precision,limit,workspace.data(),
+            &result,&error);
+    return Value{result,error};
+}
+
+void Principal_value::reserve(std::size_t space)
+{
+    workspace.reserve(space);
+    limit = space;
+}
+
 // -- Interpolation -----------------------------------------------------------
 
 Interpolate::Interpolate(const std::vector<double>& x,
@@ -292,6 +800,18 @@ double Interpolate::operator()(double x) const
     return result;
 }
 
+std::vector<double> Interpolate::operator()(const std::vector<double>& x)
+    const
+{
+    std::vector<double> result(x.size());
+    for (std::size_t i{0}; i<x.size(); ++i) {
+        const double point{tolerant ? std::clamp(x[i],front(),back()) : x[i]};
+        call(gsl_interp_eval_e,spline,x_data.data(),y_data.data(),point,acc,
+                &result[i]);
+    }
+    return result;
+}
+
 Interpolate::~Interpolate() noexcept
 {
     gsl_interp_free(spline);
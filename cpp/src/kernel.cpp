@@ -1,8 +1,197 @@
 #include "kernel.h"
 
+#include <type_traits>
+
 namespace kernel {
-Vector iteration(const Matrix& kernel, const Vector& start, double accuracy,
-        facilities::On_off_stream status)
+Vector sample_on_grid(const CurvedOmnes& o, const Kinematic_grid& g)
+{
+    const auto values{o(g.t())};
+    return Eigen::Map<const Vector>(values.data(),values.size());
+}
+
+Grid_samples::Grid_samples(const CurvedOmnes& o,
+        const std::vector<Complex>& pi_pi, const Kinematic_grid& g)
+    : pi_pi{pi_pi},
+    omnes_x(g.x_size()),
+    omnes_t{sample_on_grid(o,g)}
+{
+    for (std::size_t j{0}; j<g.x_size(); ++j)
+        omnes_x[j] = o.original()(g.x()[j]);
+}
+
+std::vector<Complex> generate_x_dependent(const OmnesF& o,
+    const std::vector<Complex>& pi_pi, const Kinematic_grid& g,
+    int subtractions)
+{
+    const auto& x{g.x()};
+    std::vector<Complex> x_dependent(x.size());
+    for (std::size_t j{0}; j<x.size(); ++j)
+        x_dependent[j] = pi_pi[j]/o(x[j])
+            *phase_space::sigma(g.pion_mass(),x[j])
+            /std::pow(x[j],subtractions);
+    return x_dependent;
+}
+
+std::vector<Complex> generate_x_dependent(const Grid_samples& samples,
+    const Kinematic_grid& g, int subtractions)
+{
+    const auto& x{g.x()};
+    std::vector<Complex> x_dependent(x.size());
+    for (std::size_t j{0}; j<x.size(); ++j)
+        x_dependent[j] = samples.pi_pi[j]/samples.omnes_x[j]
+            *phase_space::sigma(g.pion_mass(),x[j])
+            /std::pow(x[j],subtractions);
+    return x_dependent;
+}
+
+Matrix generate_kernel(const CurvedOmnes& o, const std::vector<Complex>& pi_pi,
+    const Kinematic_grid& g, int subtractions)
+{
+    return generate_kernel(Grid_samples{o,pi_pi,g},g,subtractions);
+}
+
+template<typename S>
+S kernel_scalar(const Complex& z)
+    // Return `z` for complex kernels and its real part for real ones.
+{
+    if constexpr (std::is_same_v<S,double>)
+        return z.real();
+    else
+        return z;
+}
+
+template<typename M>
+M fill_kernel(const Grid_samples& samples, const Kinematic_grid& g,
+    int subtractions)
+    // The integration kernel with the scalar type of `M`.
+{
+    using S = typename M::Scalar;
+    const std::size_t n_x{g.x_size()};
+    const std::size_t n{g.size()};
+    const auto& offsets{g.offsets()};
+    M result(n,n);
+
+    // x_j dependent terms
+    const auto x_terms{generate_x_dependent(samples,g,subtractions)};
+    const double coeff{1.5/constants::pi()};
+    std::vector<S> x_dependent(n_x);
+    std::vector<S> x(n_x);
+    for (std::size_t j{0}; j<n_x; ++j) {
+        x_dependent[j] = kernel_scalar<S>(
+                x_terms[j]*coeff*g.x_weights()[j]*g.x_derivatives()[j]);
+        x[j] = kernel_scalar<S>(g.x()[j]);
+    }
+
+    // z_b dependent terms
+    std::vector<double> z_dependent(n);
+    for (std::size_t b{0}; b<n; ++b)
+        z_dependent[b] = g.z_weights()[b]*g.angular()[b];
+
+    // create the matrix
+    const auto& t{g.t()};
+    for (std::size_t in{0}; in<n; ++in) {
+        const S t_term{kernel_scalar<S>(
+                samples.omnes_t(in)*std::pow(t[in],subtractions))};
+        const S t_in{kernel_scalar<S>(t[in])};
+        for (std::size_t j{0}; j<n_x; ++j) {
+            // `cauchy` is the only term that couples columns and rows.
+            const S cauchy{x[j]-t_in};
+            const S factor{t_term*x_dependent[j]/cauchy};
+            for (std::size_t b{offsets[j]}; b<offsets[j+1]; ++b)
+                result(in,b) = factor*z_dependent[b];
+        }
+    }
+    return result;
+}
+
+Matrix generate_kernel(const Grid_samples& samples, const Kinematic_grid& g,
+    int subtractions)
+{
+    return fill_kernel<Matrix>(samples,g,subtractions);
+}
+
+template<typename V>
+bool negligible_imaginary_parts(const V& values, double tolerance)
+    // Return true if all imaginary parts are below `tolerance` relative to
+    // the largest modulus.
+{
+    double imaginary{0.0};
+    double modulus{0.0};
+    for (const Complex& z: values) {
+        imaginary = std::max(imaginary,std::abs(z.imag()));
+        modulus = std::max(modulus,std::abs(z));
+    }
+    return imaginary<=tolerance*modulus;
+}
+
+bool is_real(const Grid_samples& samples, const Kinematic_grid& g,
+    int subtractions, double tolerance)
+{
+    if (!negligible_imaginary_parts(g.x(),tolerance)
+            || !negligible_imaginary_parts(g.t(),tolerance)
+            || !negligible_imaginary_parts(g.x_derivatives(),tolerance)
+            || !negligible_imaginary_parts(
+                generate_x_dependent(samples,g,subtractions),tolerance))
+        return false;
+    // The Omnes function at t enters both the kernel and the
+    // inhomogeneities.
+    std::vector<Complex> t_terms(g.size());
+    for (std::size_t k{0}; k<t_terms.size(); ++k)
+        t_terms[k] = samples.omnes_t(k)*std::pow(g.t()[k],subtractions);
+    return negligible_imaginary_parts(samples.omnes_t,tolerance)
+        && negligible_imaginary_parts(t_terms,tolerance);
+}
+
+Real_matrix generate_real_kernel(const Grid_samples& samples,
+    const Kinematic_grid& g, int subtractions)
+{
+    return fill_kernel<Real_matrix>(samples,g,subtractions);
+}
+
+Kernel_operator::Kernel_operator(const CurvedOmnes& o,
+        const std::vector<Complex>& pi_pi, const Kinematic_grid& g,
+        int subtractions, double tolerance)
+    : Kernel_operator{Grid_samples{o,pi_pi,g},g,subtractions,tolerance}
+{
+}
+
+Kernel_operator::Kernel_operator(const Grid_samples& samples,
+        const Kinematic_grid& g, int subtractions, double tolerance)
+    : offsets{g.offsets()},
+    x_terms{generate_x_dependent(samples,g,subtractions)},
+    z_terms(g.size()),
+    t_terms{g.t()},
+    cauchy_sum{g.x(),g.t(),tolerance}
+{
+    const double coeff{1.5/constants::pi()};
+    for (std::size_t j{0}; j<x_terms.size(); ++j)
+        x_terms[j] *= coeff*g.x_weights()[j]*g.x_derivatives()[j];
+    for (std::size_t b{0}; b<z_terms.size(); ++b)
+        z_terms[b] = g.z_weights()[b]*g.angular()[b];
+    for (std::size_t k{0}; k<t_terms.size(); ++k)
+        t_terms[k] = samples.omnes_t(k)*std::pow(t_terms[k],subtractions);
+}
+
+Vector Kernel_operator::operator*(const Vector& v) const
+{
+    std::vector<Complex> charges(x_terms.size());
+    for (std::size_t j{0}; j<charges.size(); ++j) {
+        Complex angular_sum{0.0,0.0};
+        for (std::size_t b{offsets[j]}; b<offsets[j+1]; ++b)
+            angular_sum += z_terms[b]*v(b);
+        charges[j] = x_terms[j]*angular_sum;
+    }
+    const auto sums{cauchy_sum(charges)};
+    Vector result(sums.size());
+    for (std::size_t i{0}; i<sums.size(); ++i)
+        result(i) = t_terms[i]*sums[i];
+    return result;
+}
+
+template<typename K>
+Vector iterate(const K& kernel, const Vector& start, double accuracy,
+        facilities::On_off_stream& status)
+    // The iteration shared by stored and matrix free kernels.
 {
     Vector previous{start};
     Vector next{start + kernel*start};
@@ -17,10 +206,286 @@ Vector iteration(const Matrix& kernel, const Vector& start, double accuracy,
     return next;
 }
 
+Vector iteration(const Matrix& kernel, const Vector& start, double accuracy,
+        facilities::On_off_stream status)
+{
+    return iterate(kernel,start,accuracy,status);
+}
+
+Vector iteration(const Kernel_operator& kernel, const Vector& start,
+        double accuracy, facilities::On_off_stream status)
+{
+    return iterate(kernel,start,accuracy,status);
+}
+
 Vector inverse(const Matrix& kernel, const Vector& start)
 {
     const auto n{kernel.rows()};
     const Matrix identity{Matrix::Identity(n,n)};
     return (identity-kernel).partialPivLu().solve(start);
 }
+
+Vector inverse(const Real_matrix& kernel, const Vector& start)
+{
+    const auto n{kernel.rows()};
+    const Real_matrix identity{Real_matrix::Identity(n,n)};
+    const Eigen::VectorXd solution{(identity-kernel).partialPivLu()
+        .solve(start.real())};
+    return solution.cast<Complex>();
+}
+
+std::vector<Vector> basis(const Grid_samples& samples,
+        const Kinematic_grid& g, int subtractions, Method method,
+        std::optional<double> accuracy)
+{
+    std::vector<Vector> starts;
+    for (int i{0}; i<subtractions; ++i) {
+        auto polynomial{[i](const Complex& s){return std::pow(s,i);}};
+        Vector start{sample_on_grid(polynomial,g)};
+        starts.push_back(start.cwiseProduct(samples.omnes_t));
+    }
+
+    std::vector<Vector> result;
+    switch (method) {
+        case Method::iteration: {
+            // The iteration needs the kernel applied to vectors only.
+            const Kernel_operator kernel{samples,g,subtractions};
+            constexpr double default_value{1e-8};
+            const double precision{accuracy ? *accuracy : default_value};
+            for (const auto& start: starts)
+                result.push_back(iteration(kernel,start,precision));
+            break; }
+        case Method::inverse: {
+            // Real kernels need a quarter of the operations and half of the
+            // memory.
+            if (is_real(samples,g,subtractions)) {
+                const Real_matrix kernel{
+                    generate_real_kernel(samples,g,subtractions)};
+                for (const auto& start: starts)
+                    result.push_back(inverse(kernel,start));
+                break;
+            }
+            const Matrix kernel{generate_kernel(samples,g,subtractions)};
+            for (const auto& start: starts)
+                result.push_back(inverse(kernel,start));
+            break; }
+        default:
+            throw Unknown_method{};
+    }
+    return result;
+}
+
+std::vector<spline::Spline<Complex>> row_splines(
+        const std::vector<double>& x, const Matrix& y)
+    // Interpolate each row of `y` by a natural cubic spline.
+{
+    std::vector<spline::Spline<Complex>> result;
+    result.reserve(y.rows());
+    std::vector<Complex> row(x.size());
+    for (Eigen::Index i{0}; i<y.rows(); ++i) {
+        for (std::size_t k{0}; k<x.size(); ++k)
+            row[k] = y(i,k);
+        result.emplace_back(x,row,spline::Method::cubic);
+    }
+    return result;
+}
+
+Matrix join_columns(const std::vector<Vector>& columns)
+    // Return the matrix with the columns `columns`.
+{
+    Matrix result(columns.front().size(),columns.size());
+    for (std::size_t k{0}; k<columns.size(); ++k)
+        result.col(k) = columns[k];
+    return result;
+}
+
+double largest_deviation(const std::vector<spline::Spline<Complex>>& splines,
+        double s, const Vector& exact, const Eigen::VectorXd& scale)
+    // Return the largest deviation of the splines from `exact` at `s`,
+    // relative to `scale`.
+{
+    double result{0.0};
+    for (Eigen::Index i{0}; i<exact.size(); ++i) {
+        const double d{std::abs(splines[i](s)-exact(i))};
+        result = std::max(result,scale(i)>0.0 ? d/scale(i) : d);
+    }
+    return result;
+}
+
+Real_table::Real_table(const Real_batch& f, std::vector<double> breaks,
+        double tolerance, std::size_t max_levels)
+    : breaks{std::move(breaks)}
+{
+    const auto& b{this->breaks};
+    if (b.size()<2 || std::adjacent_find(b.cbegin(),b.cend(),
+                std::greater_equal<double>{})!=b.cend())
+        throw std::invalid_argument{"The break points need to be sorted in \
+strictly ascending order."};
+    if (!(tolerance>0.0))
+        throw std::invalid_argument{"The tolerance needs to be positive."};
+
+    // Per part the knots, the functions at the knots and, for every interval
+    // between neighbouring knots, the deviation found at its last check.
+    // Relative to the length of the part, the one-sided limits are taken at
+    // the distance `resolution` from the break points, which is also the
+    // length of the shortest intervals.
+    constexpr std::size_t initial{4};
+    constexpr double resolution{1e-8};
+    const std::size_t n_parts{b.size()-1};
+    std::vector<std::vector<double>> x(n_parts);
+    std::vector<std::vector<Vector>> y(n_parts);
+    std::vector<std::vector<double>> estimates(n_parts,
+            std::vector<double>(initial,
+                std::numeric_limits<double>::infinity()));
+    std::vector<double> points;
+    for (std::size_t p{0}; p<n_parts; ++p) {
+        for (std::size_t k{0}; k<initial; ++k)
+            x[p].push_back(b[p]+(b[p+1]-b[p])*k/initial);
+        x[p].push_back(b[p+1]);
+        points.insert(points.end(),x[p].cbegin(),x[p].cend());
+        // The one-sided limits at the break points, where `f` itself may be
+        // singular.
+        const double inside{resolution*(b[p+1]-b[p])};
+        points[points.size()-initial-1] += inside;
+        points.back() -= inside;
+    }
+    Matrix values{f(points)};
+    if (static_cast<std::size_t>(values.cols())!=points.size())
+        throw std::invalid_argument{"The tabulated function returned the \
+wrong number of values."};
+    _size = values.rows();
+    Eigen::VectorXd scale{values.cwiseAbs().rowwise().maxCoeff()};
+    for (std::size_t p{0}, k{0}; p<n_parts; ++p)
+        for (std::size_t j{0}; j<=initial; ++j)
+            y[p].push_back(values.col(k++));
+
+    const auto unresolved{[&](std::size_t p, std::size_t j)
+        {
+            return estimates[p][j]>tolerance
+                && x[p][j+1]-x[p][j]>2.0*resolution*(b[p+1]-b[p]);
+        }};
+
+    // All midpoints of the intervals not resolved yet are evaluated at once.
+    for (std::size_t level{0}; level<max_levels; ++level) {
+        points.clear();
+        for (std::size_t p{0}; p<n_parts; ++p)
+            for (std::size_t j{0}; j<estimates[p].size(); ++j)
+                if (unresolved(p,j))
+                    points.push_back(0.5*(x[p][j]+x[p][j+1]));
+        if (points.empty())
+            break;
+        values = f(points);
+        scale = scale.cwiseMax(values.cwiseAbs().rowwise().maxCoeff());
+
+        std::size_t k{0};
+        for (std::size_t p{0}; p<n_parts; ++p) {
+            const auto& e{estimates[p]};
+            std::size_t j{0};
+            while (j<e.size() && !unresolved(p,j))
+                ++j;
+            if (j==e.size())
+                continue;
+            const auto splines{row_splines(x[p],join_columns(y[p]))};
+            std::vector<double> refined_x;
+            std::vector<Vector> refined_y;
+            std::vector<double> refined_estimates;
+            for (j=0; j<e.size(); ++j) {
+                refined_x.push_back(x[p][j]);
+                refined_y.push_back(y[p][j]);
+                if (!unresolved(p,j)) {
+                    refined_estimates.push_back(e[j]);
+                    continue;
+                }
+                const Vector exact{values.col(k)};
+                const double d{largest_deviation(splines,points[k],exact,
+                        scale)};
+                refined_x.push_back(points[k]);
+                refined_y.push_back(exact);
+                refined_estimates.insert(refined_estimates.end(),2,d);
+                ++k;
+            }
+            refined_x.push_back(x[p].back());
+            refined_y.push_back(y[p].back());
+            x[p] = std::move(refined_x);
+            y[p] = std::move(refined_y);
+            estimates[p] = std::move(refined_estimates);
+        }
+    }
+
+    for (std::size_t p{0}; p<n_parts; ++p) {
+        for (const auto d: estimates[p])
+            _error = std::max(_error,d);
+        add_part(std::move(x[p]),join_columns(y[p]));
+    }
+}
+
+Real_table::Real_table(const std::vector<double>& points, const Matrix& values)
+    : _size(values.rows())
+{
+    if (points.empty()
+            || static_cast<std::size_t>(values.cols())!=points.size())
+        throw std::invalid_argument{"A table needs as many columns of values \
+as points."};
+    std::size_t first{0};
+    for (std::size_t k{1}; k<=points.size(); ++k) {
+        // A repeated point separates two parts.
+        if (k<points.size() && points[k]!=points[k-1])
+            continue;
+        std::vector<double> x(points.cbegin()+first,points.cbegin()+k);
+        if (breaks.empty())
+            breaks.push_back(x.front());
+        breaks.push_back(x.back());
+        add_part(std::move(x),values.middleCols(first,k-first));
+        first = k;
+    }
+}
+
+Complex Real_table::operator()(std::size_t i, double s) const
+{
+    return part(s).splines.at(i)(s);
+}
+
+Vector Real_table::evaluate_all(double s) const
+{
+    const auto& splines{part(s).splines};
+    Vector result(_size);
+    for (std::size_t i{0}; i<_size; ++i)
+        result(i) = splines[i](s);
+    return result;
+}
+
+std::vector<double> Real_table::points() const
+{
+    std::vector<double> result;
+    for (const auto& p: parts)
+        result.insert(result.end(),p.x.cbegin(),p.x.cend());
+    return result;
+}
+
+Matrix Real_table::values() const
+{
+    Eigen::Index size{0};
+    for (const auto& p: parts)
+        size += p.y.cols();
+    Matrix result(_size,size);
+    Eigen::Index first{0};
+    for (const auto& p: parts) {
+        result.middleCols(first,p.y.cols()) = p.y;
+        first += p.y.cols();
+    }
+    return result;
+}
+
+void Real_table::add_part(std::vector<double> x, Matrix y)
+{
+    auto splines{row_splines(x,y)};
+    parts.push_back(Part{std::move(x),std::move(y),std::move(splines)});
+}
+
+const Real_table::Part& Real_table::part(double s) const noexcept
+{
+    const auto first{std::next(breaks.cbegin())};
+    const auto it{std::upper_bound(first,std::prev(breaks.cend()),s)};
+    return parts[std::distance(first,it)];
+}
 } // kernel
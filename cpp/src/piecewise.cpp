@@ -1,6 +1,29 @@
 #include "piecewise.h"
 
+#include "constants.h"
+
+#include <limits>
+
 namespace piecewise {
+Box bounding_box(const std::vector<Complex>& points, double margin)
+{
+    if (points.empty())
+        throw std::invalid_argument{"Cannot bound an empty set of points."};
+    Box box{points[0].real(),points[0].real(),points[0].imag(),
+        points[0].imag()};
+    for (const auto& p: points) {
+        box.real_lower = std::min(box.real_lower,p.real());
+        box.real_upper = std::max(box.real_upper,p.real());
+        box.imag_lower = std::min(box.imag_lower,p.imag());
+        box.imag_upper = std::max(box.imag_upper,p.imag());
+    }
+    box.real_lower -= margin;
+    box.real_upper += margin;
+    box.imag_lower -= margin;
+    box.imag_upper += margin;
+    return box;
+}
+
 Piecewise::Piecewise(const std::vector<Complex>& knots,
         const std::vector<Para>& parametrisations)
     : parametrisations{parametrisations}
@@ -13,12 +36,29 @@ Piecewise::Piecewise(const std::vector<Complex>& knots,
     std::vector<Complex> differences(knots.size());
     std::adjacent_difference(knots.cbegin(),knots.cend(),differences.begin());
 
-    pieces.resize(s);
+    coefficients.resize(s);
     adjacent.resize(s);
+    boxes.resize(s);
 
+    constexpr double minimal_distance{1e-10};
     for (std::size_t i{0}; i<s; ++i) {
-        pieces[i] = std::make_pair(differences[i+1],knots[i]);
+        switch (parametrisations[i]) {
+            case linear:
+                coefficients[i] = {knots[i],differences[i+1],0.0};
+                break;
+            case quadratic:
+                coefficients[i] = {knots[i],0.0,differences[i+1]};
+                break;
+            default:
+                throw Unknown_para{};
+        }
         adjacent[i] = std::make_pair(knots[i],knots[i+1]);
+        // `in_between` accepts an ellipse with foci at the knots, whose
+        // major axis exceeds the distance of the knots by `minimal_distance`.
+        const double length{std::abs(differences[i+1])};
+        const double margin{
+            std::sqrt(minimal_distance*(2.0*length+minimal_distance))};
+        boxes[i] = bounding_box({knots[i],knots[i+1]},margin);
     }
 }
 
@@ -43,28 +83,27 @@ std::size_t Piecewise::piece_index(double x) const
 Complex Piecewise::curve_func(double x) const
 {
     const auto k{piece_index(x)};
-    const auto& p{pieces.at(k)};
-    switch (parametrisations[k]) {
-        case linear:
-            return p.first*(x-k) + p.second;
-        case quadratic:
-            return p.first*square(x-k) + p.second;
-        default:
-            throw Unknown_para{};
-    }
+    const auto& c{coefficients[k]};
+    const double u{x-k};
+    return c.constant + u*(c.linear+u*c.quadratic);
 }
 
 Complex Piecewise::derivative_func(double x) const
 {
     const auto k{piece_index(x)};
-    const auto& p{pieces.at(k)};
-    switch (parametrisations[k]) {
-        case linear:
-            return p.first;
-        case quadratic:
-            return 2.0*p.first*(x-k);
-        default:
-            throw Unknown_para{};
+    const auto& c{coefficients[k]};
+    return c.linear + 2.0*(x-k)*c.quadratic;
+}
+
+void Piecewise::evaluate(const double* first, const double* last,
+        Complex* values, Complex* derivatives) const
+{
+    for (; first!=last; ++first, ++values, ++derivatives) {
+        const auto k{piece_index(*first)};
+        const auto& c{coefficients[k]};
+        const double u{*first-k};
+        *values = c.constant + u*(c.linear+u*c.quadratic);
+        *derivatives = c.linear + 2.0*u*c.quadratic;
     }
 }
 
@@ -79,22 +118,30 @@ bool in_between(const Complex& x, const Complex& a, const Complex& b)
 
 Piecewise::Segment Piecewise::hits(const Complex& s) const
 {
-    auto position{std::find_if(adjacent.cbegin(),adjacent.cend(),
-            [s](const auto& p){return in_between(s,p.first,p.second);})};
-    if (position==adjacent.cend())
-        return std::nullopt;
-    double lower = std::distance(adjacent.cbegin(),position);
-    double upper{lower+1.0};
-    return std::make_pair(lower,upper);
+    // The bounding boxes reject most segments without computing distances.
+    for (std::size_t k{0}; k<adjacent.size(); ++k) {
+        if (!boxes[k].contains(s)
+                || !in_between(s,adjacent[k].first,adjacent[k].second))
+            continue;
+        const double lower = k;
+        return std::make_pair(lower,lower+1.0);
+    }
+    return std::nullopt;
 }
 
 std::vector<double> Piecewise::boundaries() const
 {
-    std::vector<double> result(pieces.size()+1);
+    std::vector<double> result(coefficients.size()+1);
     std::iota(result.begin(),result.end(),lower());
     return result;
 }
 
+bool Piecewise::is_linear() const
+{
+    return std::all_of(parametrisations.cbegin(),parametrisations.cend(),
+            [](Para p){return p==linear;});
+}
+
 std::vector<Complex> vector_decay_points(double pion_mass, double virtuality,
         double cut)
 {
@@ -144,4 +191,434 @@ Adaptive::Adaptive(double pion_mass, double virtuality, double cut)
     : Piecewise{adaptive_points(pion_mass,virtuality,cut)}
 {
 }
+
+// The maximal distance of a point from a piece of a path that still counts as
+// a hit.
+constexpr double path_tolerance{1e-10};
+
+std::pair<double,double> cos_sin(double phi)
+    // Return cos(phi) and sin(phi), where rounding errors at multiples of pi/2
+    // are removed, such that arcs start and end exactly on the axes.
+{
+    constexpr double tiny{4.0*std::numeric_limits<double>::epsilon()};
+    const auto clean{[](double x){return std::abs(x)<tiny ? 0.0 : x;}};
+    return {clean(std::cos(phi)),clean(std::sin(phi))};
+}
+
+Path::Piece::Piece(Kind kind, std::array<Complex,4> c, double real_semi_axis,
+        double imaginary_semi_axis, double start_angle, double sweep)
+    : kind{kind}, c{c}, real_semi_axis{real_semi_axis},
+    imaginary_semi_axis{imaginary_semi_axis}, start_angle{start_angle},
+    sweep{sweep}, box{}
+{
+}
+
+Path::Piece Path::Piece::line(const Complex& start, const Complex& end)
+{
+    Piece p{polynomial,{start,end-start,0.0,0.0},0.0,0.0,0.0,0.0};
+    p.box = bounding_box({start,end},path_tolerance);
+    return p;
+}
+
+Path::Piece Path::Piece::arc(const Complex& center, double radius,
+        double start_angle, double end_angle)
+{
+    return elliptic_arc(center,radius,radius,start_angle,end_angle);
+}
+
+Path::Piece Path::Piece::elliptic_arc(const Complex& center,
+        double real_semi_axis, double imaginary_semi_axis, double start_angle,
+        double end_angle)
+{
+    if (real_semi_axis<=0.0 || imaginary_semi_axis<=0.0)
+        throw std::invalid_argument{"The semi-axes need to be positive."};
+    Piece p{ellipse,{center,0.0,0.0,0.0},real_semi_axis,imaginary_semi_axis,
+        start_angle,end_angle-start_angle};
+    // The entire ellipse is a cheap, albeit loose, bound.
+    const Complex diagonal{real_semi_axis,imaginary_semi_axis};
+    p.box = bounding_box({center-diagonal,center+diagonal},path_tolerance);
+    return p;
+}
+
+Path::Piece Path::Piece::bezier(const Complex& start,
+        const Complex& first_control, const Complex& second_control,
+        const Complex& end)
+{
+    Piece p{polynomial,
+        {start,
+        3.0*(first_control-start),
+        3.0*(second_control-2.0*first_control+start),
+        end-3.0*second_control+3.0*first_control-start},
+        0.0,0.0,0.0,0.0};
+    // A Bézier curve lies within the convex hull of its control points.
+    p.box = bounding_box({start,first_control,second_control,end},
+            path_tolerance);
+    return p;
+}
+
+Complex Path::Piece::value(double u) const
+{
+    if (kind==polynomial)
+        return c[0]+u*(c[1]+u*(c[2]+u*c[3]));
+    const auto [cosine,sine] = cos_sin(start_angle+u*sweep);
+    return c[0]+Complex{real_semi_axis*cosine,imaginary_semi_axis*sine};
+}
+
+Complex Path::Piece::derivative(double u) const
+{
+    if (kind==polynomial)
+        return c[1]+u*(2.0*c[2]+3.0*u*c[3]);
+    const auto [cosine,sine] = cos_sin(start_angle+u*sweep);
+    return sweep*Complex{-real_semi_axis*sine,imaginary_semi_axis*cosine};
+}
+
+std::optional<double> Path::Piece::locate(const Complex& s) const
+{
+    if (!box.contains(s))
+        return std::nullopt;
+
+    double u{0.0};
+    if (kind==ellipse) {
+        const Complex w{s-c[0]};
+        const double phi{std::atan2(w.imag()/imaginary_semi_axis,
+                w.real()/real_semi_axis)};
+        // Bring the angle into the range swept by the arc.
+        double relative{std::remainder(phi-start_angle,2.0*constants::pi())};
+        if (sweep>0.0 && relative<0.0)
+            relative += 2.0*constants::pi();
+        if (sweep<0.0 && relative>0.0)
+            relative -= 2.0*constants::pi();
+        u = relative/sweep;
+    } else if (is_line()) {
+        u = std::real((s-c[0])/c[1]);
+    } else {
+        // Start Newton's method for the closest point at the closest sample.
+        constexpr std::size_t samples{32};
+        double closest{std::numeric_limits<double>::infinity()};
+        for (std::size_t k{0}; k<=samples; ++k) {
+            const double v{static_cast<double>(k)/samples};
+            const double distance{std::abs(value(v)-s)};
+            if (distance<closest) {
+                closest = distance;
+                u = v;
+            }
+        }
+        for (std::size_t iteration{0}; iteration<20; ++iteration) {
+            const Complex difference{value(u)-s};
+            const Complex d{derivative(u)};
+            const Complex second{2.0*c[2]+6.0*u*c[3]};
+            const double gradient{std::real(std::conj(difference)*d)};
+            const double curvature{std::norm(d)
+                + std::real(std::conj(difference)*second)};
+            if (curvature<=0.0)
+                break;
+            const double next{std::clamp(u-gradient/curvature,0.0,1.0)};
+            if (std::abs(next-u)<1e-15)
+                break;
+            u = next;
+        }
+    }
+    // Points close to the ends may be mapped to the wrong end of the range.
+    for (const double candidate: {std::clamp(u,0.0,1.0),0.0,1.0})
+        if (std::abs(value(candidate)-s)<path_tolerance)
+            return candidate;
+    return std::nullopt;
+}
+
+Path::Path(std::vector<Piece> pieces)
+    : pieces{std::move(pieces)}
+{
+    if (this->pieces.empty())
+        throw std::invalid_argument{"A path needs at least one piece."};
+    for (std::size_t k{1}; k<this->pieces.size(); ++k) {
+        const auto end{this->pieces[k-1].value(1.0)};
+        const auto start{this->pieces[k].value(0.0)};
+        if (std::abs(end-start)>path_tolerance*std::max(1.0,std::abs(start)))
+            throw std::invalid_argument{
+                "The pieces of a path need to be connected."};
+    }
+}
+
+std::size_t Path::piece_index(double x) const
+{
+    if (x<lower() || x>upper())
+        throw std::out_of_range{
+            "Tried to evaluate path outside domain of definition."};
+    const auto index{static_cast<std::size_t>(x)};
+    return index==upper() ? index-1 : index;
+}
+
+Complex Path::curve_func(double x) const
+{
+    const auto k{piece_index(x)};
+    return pieces[k].value(x-k);
+}
+
+Complex Path::derivative_func(double x) const
+{
+    const auto k{piece_index(x)};
+    return pieces[k].derivative(x-k);
+}
+
+void Path::evaluate(const double* first, const double* last,
+        Complex* values, Complex* derivatives) const
+{
+    for (; first!=last; ++first, ++values, ++derivatives) {
+        const auto k{piece_index(*first)};
+        const double u{*first-k};
+        *values = pieces[k].value(u);
+        *derivatives = pieces[k].derivative(u);
+    }
+}
+
+Path::Segment Path::hits(const Complex& s) const
+{
+    for (std::size_t k{0}; k<pieces.size(); ++k) {
+        if (!pieces[k].locate(s))
+            continue;
+        const double lower = k;
+        return std::make_pair(lower,lower+1.0);
+    }
+    return std::nullopt;
+}
+
+std::vector<double> Path::boundaries() const
+{
+    std::vector<double> result(pieces.size()+1);
+    std::iota(result.begin(),result.end(),lower());
+    return result;
+}
+
+bool Path::is_linear() const
+{
+    return std::all_of(pieces.cbegin(),pieces.cend(),
+            [](const Piece& p){return p.is_line();});
+}
+
+double left_distance(const std::vector<Complex>& obstacle,
+        const Complex& direction, const Complex& point)
+    // Return the signed distance of `obstacle` from the line through `point`
+    // along the unit vector `direction`, which is positive if the obstacle is
+    // to the left of the line.
+{
+    double result{std::numeric_limits<double>::infinity()};
+    for (const auto& p: obstacle)
+        result = std::min(result,std::imag(std::conj(direction)*(p-point)));
+    return result;
+}
+
+template<typename F>
+double boundary_angle(const F& feasible, double infeasible_angle,
+        double feasible_angle)
+    // Bisect between the two angles, where `feasible` changes its value only
+    // once in between.
+{
+    for (int iteration{0}; iteration<60; ++iteration) {
+        const double middle{0.5*(infeasible_angle+feasible_angle)};
+        if (feasible(middle))
+            feasible_angle = middle;
+        else
+            infeasible_angle = middle;
+    }
+    return feasible_angle;
+}
+
+template<typename F>
+double minimum(const F& f, double lower, double upper)
+    // Return the minimum of the unimodal function `f` in [lower,upper] via
+    // golden section search.
+{
+    const double ratio{0.5*(std::sqrt(5.0)-1.0)};
+    double a{upper-ratio*(upper-lower)};
+    double b{lower+ratio*(upper-lower)};
+    double fa{f(a)};
+    double fb{f(b)};
+    for (int iteration{0}; iteration<40; ++iteration) {
+        if (fa<fb) {
+            upper = b;
+            b = a;
+            fb = fa;
+            a = upper-ratio*(upper-lower);
+            fa = f(a);
+        } else {
+            lower = a;
+            a = b;
+            fa = fb;
+            b = lower+ratio*(upper-lower);
+            fb = f(b);
+        }
+    }
+    return 0.5*(lower+upper);
+}
+
+std::vector<Complex> polygon(const std::vector<Complex>& obstacle,
+        const std::vector<double>& angles, const Complex& start,
+        const Complex& end, double margin)
+    // Return the polygon from `start` to `end`, whose sides point along
+    // `angles`. The first and last side pass through `start` and `end`, the
+    // others keep the distance `margin` from `obstacle`.
+{
+    const auto sides{angles.size()};
+    std::vector<Complex> directions(sides);
+    std::vector<double> offsets(sides);
+    for (std::size_t i{0}; i<sides; ++i) {
+        directions[i] = std::polar(1.0,angles[i]);
+        // A line consists of all z with Im(conj(direction)*z)==offset.
+        offsets[i] = std::imag(std::conj(directions[i])*start)
+            + left_distance(obstacle,directions[i],start)-margin;
+    }
+    offsets.front() = std::imag(std::conj(directions.front())*start);
+    offsets.back() = std::imag(std::conj(directions.back())*end);
+
+    std::vector<Complex> result{start};
+    for (std::size_t i{1}; i<sides; ++i) {
+        const auto& d{directions[i-1]};
+        const auto& e{directions[i]};
+        const double determinant{std::imag(std::conj(d)*e)};
+        result.emplace_back(
+                (offsets[i-1]*e.real()-d.real()*offsets[i])/determinant,
+                (offsets[i-1]*e.imag()-d.imag()*offsets[i])/determinant);
+    }
+    result.push_back(end);
+    return result;
+}
+
+double length(const std::vector<Complex>& points)
+{
+    double result{0.0};
+    for (std::size_t i{1}; i<points.size(); ++i)
+        result += std::abs(points[i]-points[i-1]);
+    return result;
+}
+
+std::vector<Complex> traced_points(double pion_mass, double virtuality,
+        double cut, std::size_t sides, double margin)
+{
+    if (sides<2)
+        throw std::invalid_argument{"The polygon needs at least two sides."};
+    const auto m2{square(pion_mass)};
+    if (!(virtuality>9.0*m2))
+        throw std::invalid_argument{"The singular region lies to the right of \
+the two-pion threshold only for virtualities above 9 pion masses squared."};
+    const auto obstacle{singularity::lower_curve(virtuality,m2,800)};
+    const double threshold{4.0*m2};
+    const double left{obstacle.front().real()};
+    const double right{obstacle.back().real()};
+    if (!(left>threshold))
+        throw std::invalid_argument{"The singular region needs to lie to the \
+right of the two-pion threshold."};
+    margin = std::min(margin*m2,0.5*(left-threshold));
+    const double greater{mandelstam::s_greater(pion_mass,virtuality)};
+    const double pi{constants::pi()};
+
+    // The obstacle is to the left of all sides. As for `Adaptive`, the first
+    // one points straight downwards and the others do not point downwards
+    // at all: a polygon that cuts the corner at the threshold does not
+    // reproduce the basis functions obtained with the other curves, even
+    // though `curved_omnes::Region` follows the slanted side exactly (cf.
+    // the test Contours.TracedAgreesWithAdaptive).
+    const double first{-0.5*pi};
+    const auto detour{[&](double end)
+        {
+            const double last{boundary_angle(
+                    [&](double angle)
+                    {
+                        return left_distance(obstacle,std::polar(1.0,angle),
+                                end) >= margin;
+                    },0.0,0.5*pi)};
+            std::vector<double> angles(sides,last);
+            angles.front() = first;
+            for (std::size_t i{1}; i+1<sides; ++i)
+                angles[i] = last*(i-1)/(sides-2);
+            // Coordinate descent, each inner angle is bounded by its
+            // neighbours.
+            for (int sweep{0}; sweep<8 && sides>2; ++sweep)
+                for (std::size_t i{1}; i+1<sides; ++i)
+                    angles[i] = minimum([&](double angle)
+                        {
+                            auto trial{angles};
+                            trial[i] = angle;
+                            return length(polygon(obstacle,trial,threshold,
+                                        end,margin));
+                        },i==1? 0.0 : angles[i-1],angles[i+1]);
+            return polygon(obstacle,angles,threshold,end,margin);
+        }};
+
+    // The real axis from the end of the detour on is part of the curve as
+    // well, such that the total length changes as length(detour)-end.
+    const double lowest{right+margin};
+    const double highest{std::max(lowest,greater)};
+    const auto objective{[&](double e){return length(detour(e))-e;}};
+    double end{minimum(objective,lowest,highest)};
+    // Typically, the optimum is at s_greater, which is a boundary anyway.
+    if (highest-end<margin || objective(highest)<=objective(end))
+        end = highest;
+
+    auto result{detour(end)};
+    if (cut <= result.back().real())
+        return result;
+    if (greater > result.back().real()) {
+        result.emplace_back(greater);
+        if (cut <= result.back().real())
+            return result;
+    }
+    result.emplace_back(cut);
+    return result;
+}
+
+Traced::Traced(double pion_mass, double virtuality, double cut,
+        std::size_t sides, double margin)
+    : Piecewise{traced_points(pion_mass,virtuality,cut,sides,margin)}
+{
+}
+
+std::vector<Path::Piece> smooth_adaptive_pieces(double pion_mass,
+        double virtuality, double cut)
+{
+    const auto m2{square(pion_mass)};
+    const mandelstam::Critical critical{pion_mass,virtuality};
+    const double radius{critical.imaginary_radius()};
+    const double left{critical.left()};
+    const double right{critical.right()+m2};
+    const double threshold{4.0*m2};
+    const double greater{mandelstam::s_greater(pion_mass,virtuality)};
+
+    // The center is placed such that the right corners of the critical
+    // rectangle sit at 1/sqrt(2) of the horizontal semi-axis, which yields
+    // an ellipse that is only moderately deeper than the rectangle. The
+    // ellipse must not extend beyond s_greater, though.
+    const double ratio{1.0/std::sqrt(2.0)};
+    const double end{std::min(
+            (2.0*right+(ratio-1.0)*threshold)/(1.0+ratio),greater)};
+    const double center{0.5*(threshold+end)};
+    const double semi_axis{center-threshold};
+    const double relative{
+        std::max(right-center,center-left)/semi_axis};
+    if (!(relative<1.0))
+        throw std::invalid_argument{
+            "The critical region cannot be enclosed by a half ellipse."};
+    const double depth{radius/std::sqrt(1.0-square(relative))};
+
+    std::vector<Path::Piece> result;
+    result.push_back(Path::Piece::elliptic_arc(center,semi_axis,depth,
+                constants::pi(),2.0*constants::pi()));
+    if (cut <= end)
+        return result;
+    double last{end};
+    for (const double next: {greater,cut}) {
+        if (next <= last)
+            continue;
+        result.push_back(Path::Piece::line(last,next));
+        if (cut <= next)
+            return result;
+        last = next;
+    }
+    return result;
+}
+
+Smooth_adaptive::Smooth_adaptive(double pion_mass, double virtuality,
+        double cut)
+    : Path{smooth_adaptive_pieces(pion_mass,virtuality,cut)}
+{
+}
 } // piecewise
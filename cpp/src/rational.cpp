@@ -0,0 +1,199 @@
+#include "rational.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rational {
+Complex cauchy_weight(const Complex& weight, const Complex& difference)
+    // Same as weight/difference. The general complex division also guards
+    // against overflow, which would dominate the cost of an evaluation.
+{
+    return weight*std::conj(difference)/std::norm(difference);
+}
+
+Rational::Rational(std::vector<Complex> support_points,
+        std::vector<Complex> weights, Matrix values, double error)
+    : _support_points{std::move(support_points)},
+    _weights{std::move(weights)},
+    _values{std::move(values)},
+    _error{error}
+{
+    if (_support_points.empty())
+        throw std::invalid_argument{"A rational function needs at least one \
+support point."};
+    if (_weights.size()!=_support_points.size()
+            || static_cast<std::size_t>(_values.cols())!=_support_points.size())
+        throw std::invalid_argument{"A rational function needs one weight \
+and one value per function for each support point."};
+}
+
+Complex Rational::operator()(std::size_t i, const Complex& s) const
+{
+    if (i>=size())
+        throw std::out_of_range{"There is no such function."};
+    Complex numerator{0.0,0.0};
+    Complex denominator{0.0,0.0};
+    for (std::size_t j{0}; j<_support_points.size(); ++j) {
+        const Complex difference{s-_support_points[j]};
+        if (difference==0.0)
+            return _values(i,j);
+        const Complex c{cauchy_weight(_weights[j],difference)};
+        numerator += c*_values(i,j);
+        denominator += c;
+    }
+    return numerator/denominator;
+}
+
+Vector Rational::evaluate_all(const Complex& s) const
+{
+    Vector c(_support_points.size());
+    for (std::size_t j{0}; j<_support_points.size(); ++j) {
+        const Complex difference{s-_support_points[j]};
+        if (difference==0.0)
+            return _values.col(j);
+        c(j) = cauchy_weight(_weights[j],difference);
+    }
+    return _values*c/c.sum();
+}
+
+std::vector<Complex> Rational::poles() const
+{
+    // The zeros of sum_j w_j/(s-z_j) are the eigenvalues of
+    // (1-e w^T/sum_j w_j) diag(z_j-z_0), shifted by z_0, where e contains only
+    // ones. The additional eigenvalue 0 belongs to w^T and is dropped.
+    const auto m{static_cast<Eigen::Index>(_support_points.size())};
+    if (m<2)
+        return {};
+    Vector w(m);
+    Vector shifted(m);
+    for (Eigen::Index j{0}; j<m; ++j) {
+        w(j) = _weights[j];
+        shifted(j) = _support_points[j]-_support_points.front();
+    }
+    const Eigen::MatrixXcd a{shifted.asDiagonal().toDenseMatrix()
+        -Vector::Ones(m)*(w.cwiseProduct(shifted)).transpose()/w.sum()};
+    const Vector eigenvalues{Eigen::ComplexEigenSolver<Eigen::MatrixXcd>(a,
+            false).eigenvalues()};
+    Eigen::Index spurious{0};
+    eigenvalues.cwiseAbs().minCoeff(&spurious);
+    std::vector<Complex> result;
+    result.reserve(m-1);
+    for (Eigen::Index j{0}; j<m; ++j)
+        if (j!=spurious)
+            result.push_back(eigenvalues(j)+_support_points.front());
+    return result;
+}
+
+Rational aaa(const std::vector<Complex>& z, const Matrix& f,
+        double tolerance, std::size_t max_support)
+{
+    const auto n{f.rows()};
+    const auto size{static_cast<Eigen::Index>(z.size())};
+    if (n==0 || size==0 || f.cols()!=size)
+        throw std::invalid_argument{"aaa requires the values of at least one \
+function at each sample."};
+    if (max_support==0)
+        throw std::invalid_argument{"aaa requires at least one support \
+point."};
+
+    // Every function is normalised to its largest modulus, such that all of
+    // them are approximated to the same relative accuracy.
+    Eigen::VectorXd scale{f.cwiseAbs().rowwise().maxCoeff()};
+    for (Eigen::Index i{0}; i<n; ++i)
+        if (scale(i)==0.0)
+            scale(i) = 1.0;
+    const Matrix normalised{scale.cwiseInverse().cast<Complex>().asDiagonal()
+        *f};
+
+    std::vector<Eigen::Index> support;
+    std::vector<bool> chosen(size,false);
+    Vector weights;
+    // the current approximation, starting from the mean values
+    Matrix approximation{normalised.rowwise().mean().replicate(1,size)};
+    double error{0.0};
+    while (true) {
+        Eigen::Index next{0};
+        error = 0.0;
+        for (Eigen::Index k{0}; k<size; ++k) {
+            if (chosen[k])
+                continue;
+            const double deviation{(normalised.col(k)-approximation.col(k))
+                .cwiseAbs().maxCoeff()};
+            if (deviation>=error) {
+                error = deviation;
+                next = k;
+            }
+        }
+        if (error<=tolerance || support.size()==max_support)
+            break;
+        support.push_back(next);
+        chosen[next] = true;
+
+        // The Loewner matrix of all functions stacked on top of each other,
+        // its right singular vector to the smallest singular value contains
+        // the weights.
+        const auto m{static_cast<Eigen::Index>(support.size())};
+        const auto rest{size-m};
+        std::vector<Eigen::Index> others;
+        others.reserve(rest);
+        for (Eigen::Index k{0}; k<size; ++k)
+            if (!chosen[k])
+                others.push_back(k);
+        Eigen::MatrixXcd cauchy(rest,m);
+        for (Eigen::Index r{0}; r<rest; ++r)
+            for (Eigen::Index j{0}; j<m; ++j)
+                cauchy(r,j) = 1.0/(z[others[r]]-z[support[j]]);
+        if (rest==0) {
+            weights = Vector::Ones(m);
+        } else {
+            Eigen::MatrixXcd loewner(n*rest,m);
+            for (Eigen::Index i{0}; i<n; ++i)
+                for (Eigen::Index r{0}; r<rest; ++r)
+                    for (Eigen::Index j{0}; j<m; ++j)
+                        loewner(i*rest+r,j) = cauchy(r,j)
+                            *(normalised(i,others[r])
+                                    -normalised(i,support[j]));
+            // With fewer rows than columns, only the full V contains the
+            // null space.
+            const Eigen::BDCSVD<Eigen::MatrixXcd> svd{loewner,
+                Eigen::ComputeFullV};
+            weights = svd.matrixV().col(m-1);
+        }
+
+        Eigen::MatrixXcd values(n,m);
+        for (Eigen::Index j{0}; j<m; ++j)
+            values.col(j) = normalised.col(support[j]);
+        const Vector denominator{cauchy*weights};
+        const Eigen::MatrixXcd numerators{values*weights.asDiagonal()
+            *cauchy.transpose()};
+        for (Eigen::Index r{0}; r<rest; ++r)
+            approximation.col(others[r]) = numerators.col(r)/denominator(r);
+        for (const auto k: support)
+            approximation.col(k) = normalised.col(k);
+    }
+
+    if (support.empty()) {
+        // The functions are constant to the requested accuracy.
+        support.push_back(0);
+        weights = Vector::Ones(1);
+    }
+    std::vector<Complex> support_points;
+    std::vector<Complex> w;
+    Matrix values(n,support.size());
+    for (std::size_t j{0}; j<support.size(); ++j) {
+        support_points.push_back(z[support[j]]);
+        w.push_back(weights(j));
+        values.col(j) = f.col(support[j]);
+    }
+    return Rational{std::move(support_points),std::move(w),std::move(values),
+        error};
+}
+
+Rational aaa(const std::vector<Complex>& z, const std::vector<Complex>& f,
+        double tolerance, std::size_t max_support)
+{
+    const Matrix values{Eigen::Map<const Matrix>(f.data(),1,f.size())};
+    return aaa(z,values,tolerance,max_support);
+}
+} // rational
@@ -0,0 +1,117 @@
+#include "singularity.h"
+
+#include "constants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace singularity {
+std::array<Complex,3> cubic_roots(const std::array<double,4>& coefficients)
+{
+    const auto [c0,c1,c2,c3] = coefficients;
+    if (c3==0.0)
+        throw std::invalid_argument{"The equation is not cubic."};
+    const double delta0{c2*c2-3.0*c3*c1};
+    const double delta1{2.0*c2*c2*c2-9.0*c3*c2*c1+27.0*c3*c3*c0};
+    const Complex root{std::sqrt(Complex{delta1*delta1
+            -4.0*delta0*delta0*delta0})};
+    Complex delta{std::pow((delta1+root)/2.0,1.0/3.0)};
+    constexpr double threshold{1e-20};
+    if (std::abs(delta)<threshold)
+        delta = std::pow((delta1-root)/2.0,1.0/3.0);
+
+    const Complex unity{-0.5,0.5*std::sqrt(3.0)};
+    const auto polynomial{[&](const Complex& x)
+        {
+            return c0+x*(c1+x*(c2+x*c3));
+        }};
+    const auto derivative{[&](const Complex& x)
+        {
+            return c1+x*(2.0*c2+3.0*x*c3);
+        }};
+    std::array<Complex,3> result;
+    for (auto& x: result) {
+        // A triple root (delta==0) is -c2/(3 c3).
+        x = std::abs(delta)<threshold
+            ? -c2/(3.0*c3)
+            : -(c2+delta+delta0/delta)/(3.0*c3);
+        // Steps that do not decrease the residual are rejected, close to a
+        // double root they might jump to another root.
+        for (int iteration{0}; iteration<2; ++iteration) {
+            const Complex d{derivative(x)};
+            if (d==0.0)
+                break;
+            const Complex next{x-polynomial(x)/d};
+            if (!(std::abs(polynomial(next))<std::abs(polynomial(x))))
+                break;
+            x = next;
+        }
+        delta *= unity;
+    }
+    return result;
+}
+
+std::array<double,4> coefficients(double cos2, double decay_mass_2,
+        double mass_2)
+{
+    const double sum{decay_mass_2+3.0*mass_2};
+    const double difference{decay_mass_2-5.0*mass_2};
+    return {
+        -4.0*cos2*mass_2*std::pow(decay_mass_2-mass_2,2),
+        cos2*sum*sum-difference*difference,
+        2.0*(difference-cos2*sum),
+        cos2-1.0};
+}
+
+std::array<Complex,3> singularities(double cos2, double decay_mass_2,
+        double mass_2)
+{
+    const auto c{coefficients(cos2,decay_mass_2,mass_2)};
+    if (cos2<=0.5)
+        return cubic_roots(c);
+    // The cubic coefficient vanishes for cos2->1, where one root diverges
+    // and the closed form loses all precision. The equation for 1/s is well
+    // behaved there.
+    auto result{cubic_roots({c[3],c[2],c[1],c[0]})};
+    for (auto& x: result)
+        x = 1.0/x;
+    return result;
+}
+
+std::vector<Complex> singularity_curve(double decay_mass_2, double mass_2,
+        std::size_t number, std::size_t points, double eps)
+{
+    if (number>2)
+        throw std::invalid_argument{"There are only three singularities."};
+    if (points<2)
+        throw std::invalid_argument{"A curve needs at least two points."};
+    std::vector<Complex> result(points);
+    for (std::size_t i{0}; i<points; ++i) {
+        const double cos2{eps+(1.0-2.0*eps)*i/(points-1)};
+        result[i] = cubic_roots(coefficients(cos2,decay_mass_2,mass_2))[number];
+    }
+    return result;
+}
+
+std::vector<Complex> lower_curve(double decay_mass_2, double mass_2,
+        std::size_t points)
+{
+    if (points<2)
+        throw std::invalid_argument{"A curve needs at least two points."};
+    std::vector<Complex> result(points);
+    result.front() = 0.5*(decay_mass_2-mass_2);
+    result.back() = decay_mass_2-5.0*mass_2;
+    for (std::size_t i{1}; i+1<points; ++i) {
+        const double angle{0.5*constants::pi()*i/(points-1)};
+        const double cos2{std::pow(std::cos(angle),2)};
+        const auto roots{singularities(cos2,decay_mass_2,mass_2)};
+        result[i] = *std::min_element(roots.cbegin(),roots.cend(),
+                [](const Complex& a, const Complex& b)
+                {
+                    return a.imag()<b.imag();
+                });
+    }
+    return result;
+}
+} // singularity
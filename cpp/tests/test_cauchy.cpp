@@ -4,6 +4,9 @@
 #include "gsl_interface.h"
 #include "gtest/gtest.h"
 #include "test_common.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 #include <vector>
 
 using cauchy::Complex;
@@ -60,6 +63,278 @@ TEST(Integrate, AlongCircle)
     expect_near(value, {-2.0 / 3.0, 0.0}, tolerance);
 }
 
+TEST(Integrate, PrincipalValue)
+{
+    // The principal value of exp(ix)/x in [-1,1] equals 2i Si(1).
+    const auto integrate{gsl::Principal_value{}};
+    const auto result{cauchy::c_principal_value(circle, -1.0, 1.0, 0.0,
+            integrate)};
+    const auto value{std::get<0>(result)};
+    constexpr double tolerance{1e-12};
+    expect_near(value, {0.0, 1.8921661407343662}, tolerance);
+}
+
+TEST(Integrate, BatchPoints)
+{
+    const auto integrate{gsl::Warm_start{}};
+    const auto curve{[](const std::vector<double>& x)
+        {
+            std::vector<Complex> result(x.size());
+            for (std::size_t i{0}; i < x.size(); ++i)
+                result[i] = circle(x[i]) * std::abs(x[i] - 1.0);
+            return result;
+        }};
+    const auto result{cauchy::c_integrate(curve, {0.0, 1.0, 2.0 * pi()},
+            integrate)};
+    const auto value{std::get<0>(result)};
+    // int_0^{2pi} |x-1| e^{ix} dx = 2-2e^{i}+i(2-2pi)
+    const Complex expected{2.0 - 2.0 * std::cos(1.0),
+        2.0 - 2.0 * pi() - 2.0 * std::sin(1.0)};
+    constexpr double tolerance{1e-9};
+    expect_near(value, expected, tolerance);
+}
+
+TEST(PolygonIntegral, Constant)
+{
+    // int dz/(z-s) along a polygon equals log((b-s)/(a-s)) + 2 pi i times
+    // the winding number
+    const std::vector<Complex> z{{1.0, 0.0}, {1.0, -2.0}, {5.0, -2.0},
+        {5.0, 0.0}};
+    const std::vector<Complex> f(z.size(), 1.0);
+    const Complex s{3.0, 1.0};
+    const auto value{cauchy::polygon_integral(z, f, s, 0)};
+    constexpr double tolerance{1e-14};
+    expect_near(value, std::log((z.back() - s) / (z.front() - s)), tolerance);
+}
+
+TEST(PolygonIntegral, Subtractions)
+{
+    // for f(z)=z: s^2 int dz f/(z^2(z-s)) = s int dz (1/(z-s)-1/z)
+    const std::vector<Complex> z{{1.0, 0.0}, {2.0, -1.0}};
+    const std::vector<Complex> f{z};
+    const Complex s{-1.0, 0.5};
+    const auto value{cauchy::polygon_integral(z, f, s, 2)};
+    const Complex expected{s * std::log((z[1] - s) / (z[0] - s))
+        - s * std::log(z[1] / z[0])};
+    constexpr double tolerance{1e-14};
+    expect_near(value, expected, tolerance);
+}
+
+TEST(PolygonIntegral, PrincipalValue)
+{
+    // PV int_1^3 dx x/(x-2) = 2 + 2 log(1) = 2
+    const std::vector<Complex> z{1.0, 1.5, 2.0, 3.0};
+    const std::vector<Complex> f{z};
+    const auto value{cauchy::polygon_integral(z, f, 2.0, 0, {0, 3})};
+    constexpr double tolerance{1e-14};
+    expect_near(value, {2.0, 0.0}, tolerance);
+}
+
+TEST(PolygonIntegral, Moments)
+{
+    const std::vector<Complex> z{{1.0, 0.0}, {1.0, -2.0}, {5.0, -2.0},
+        {5.0, 0.0}, {9.0, 0.0}};
+    const std::vector<Complex> f{{1.0, 0.5}, {2.0, -1.0}, {0.0, 3.0},
+        {-1.0, 1.0}, {0.5, 0.0}};
+    constexpr double tolerance{1e-13};
+    for (const int n: {0, 1, 3}) {
+        const auto moments{cauchy::polygon_moments(z, f, n)};
+        ASSERT_EQ(moments.size(), static_cast<std::size_t>(n));
+        for (const Complex s: {Complex{3.0, 1.0}, Complex{-2.0, -0.5},
+                Complex{3.0, -1.0}})
+            expect_near(cauchy::polygon_integral(z, f, s, moments),
+                    cauchy::polygon_integral(z, f, s, n), tolerance);
+        expect_near(cauchy::polygon_integral(z, f, 7.0, moments, {3, 4}),
+                cauchy::polygon_integral(z, f, 7.0, n, {3, 4}), tolerance);
+    }
+}
+
+TEST(PolygonIntegral, SeveralFunctions)
+{
+    const std::vector<Complex> z{{1.0, 0.0}, {1.0, -2.0}, {5.0, -2.0},
+        {5.0, 0.0}, {9.0, 0.0}};
+    const std::vector<std::vector<Complex>> f{
+        {{1.0, 0.5}, {2.0, -1.0}, {0.0, 3.0}, {-1.0, 1.0}, {0.5, 0.0}},
+        {1.0, 2.0, 3.0, 4.0, 5.0}};
+    constexpr int n{2};
+    const std::vector<std::vector<Complex>> moments{
+        cauchy::polygon_moments(z, f[0], n),
+        cauchy::polygon_moments(z, f[1], n)};
+    for (const auto& [s, principal]: {
+            std::make_pair(Complex{3.0, 1.0}, std::make_pair(0ul, 0ul)),
+            std::make_pair(Complex{7.0, 0.0}, std::make_pair(3ul, 4ul))}) {
+        const auto values{
+            cauchy::polygon_integrals(z, f, s, moments, principal)};
+        ASSERT_EQ(values.size(), f.size());
+        for (std::size_t i{0}; i < f.size(); ++i)
+            EXPECT_EQ(values[i], cauchy::polygon_integral(z, f[i], s,
+                        moments[i], principal));
+    }
+    ASSERT_THROW(cauchy::polygon_integrals(z, f, 3.0, {moments[0]}),
+            std::invalid_argument);
+}
+
+std::vector<Complex> direct_sum(const std::vector<Complex>& nodes,
+        const std::vector<Complex>& charges,
+        const std::vector<Complex>& targets)
+{
+    std::vector<Complex> sums(targets.size());
+    for (std::size_t i{0}; i < targets.size(); ++i)
+        for (std::size_t j{0}; j < nodes.size(); ++j)
+            sums[i] += charges[j] / (nodes[j] - targets[i]);
+    return sums;
+}
+
+TEST(CauchySum, Direct)
+{
+    const std::vector<Complex> nodes{{0.0, 0.0}, {1.0, 0.5}, {2.0, -1.0}};
+    const std::vector<Complex> charges{{1.0, 0.0}, {0.5, 2.0}, {-1.0, 1.0}};
+    const std::vector<Complex> targets{{0.5, 1.0}, {3.0, 0.0}};
+    const cauchy::Cauchy_sum sum{nodes, targets};
+    EXPECT_TRUE(sum.is_direct());
+    const auto values{sum(charges)};
+    const auto expected{direct_sum(nodes, charges, targets)};
+    ASSERT_EQ(values.size(), expected.size());
+    constexpr double tolerance{1e-15};
+    for (std::size_t i{0}; i < values.size(); ++i)
+        expect_near(values[i], expected[i], tolerance);
+}
+
+TEST(CauchySum, Multipole)
+{
+    // nodes along a parabola, targets on a line slightly above the real axis
+    constexpr std::size_t n{3000};
+    std::vector<Complex> nodes(n);
+    std::vector<Complex> charges(n);
+    std::vector<Complex> targets(n);
+    for (std::size_t i{0}; i < n; ++i) {
+        const double x{static_cast<double>(i) / n};
+        nodes[i] = {x, x * x - 0.3};
+        charges[i] = {std::cos(10.0 * x), std::sin(3.0 * x)};
+        targets[i] = {1.3 * x - 0.1, 1e-3};
+    }
+    const cauchy::Cauchy_sum sum{nodes, targets};
+    EXPECT_FALSE(sum.is_direct());
+    EXPECT_EQ(sum.nodes_size(), n);
+    EXPECT_EQ(sum.targets_size(), n);
+    const auto values{sum(charges)};
+    const auto expected{direct_sum(nodes, charges, targets)};
+    ASSERT_EQ(values.size(), n);
+    for (std::size_t i{0}; i < n; ++i) {
+        double scale{0.0};
+        for (std::size_t j{0}; j < n; ++j)
+            scale += std::abs(charges[j] / (nodes[j] - targets[i]));
+        EXPECT_LT(std::abs(values[i] - expected[i]), 1e-12 * scale);
+    }
+}
+
+TEST(CauchySum, Throw)
+{
+    const std::vector<Complex> nodes{{0.0, 0.0}, {1.0, 0.0}};
+    const cauchy::Cauchy_sum sum{nodes, {{0.5, 0.5}}};
+    ASSERT_THROW(sum({1.0}), std::invalid_argument);
+}
+
+std::vector<Complex> sample_legendre(const std::vector<double>& boundaries,
+        const std::vector<std::size_t>& sizes,
+        const std::function<Complex(double)>& f)
+{
+    std::vector<Complex> result;
+    for (std::size_t k{0}; k < sizes.size(); ++k) {
+        const gsl::Gauss_Legendre rule{sizes[k]};
+        for (std::size_t i{0}; i < sizes[k]; ++i)
+            result.push_back(
+                    f(rule.point(boundaries[k], boundaries[k + 1], i).first));
+    }
+    return result;
+}
+
+TEST(LegendreInterpolate, Polynomial)
+{
+    const std::vector<double> boundaries{0.0, 1.0, 3.0};
+    const std::vector<std::size_t> sizes{4, 5};
+    const auto f{[](double x) { return Complex{x * x * x - 1.0, -2.0 * x}; }};
+    const cauchy::Legendre_interpolate interpolate{
+        boundaries, sizes, sample_legendre(boundaries, sizes, f)};
+    constexpr double tolerance{1e-13};
+    for (double x{0.0}; x < 3.0; x += 0.0913)
+        expect_near(interpolate(x), f(x), tolerance);
+    expect_near(interpolate(-1.0), f(0.0), tolerance);
+    expect_near(interpolate(4.0), f(3.0), tolerance);
+
+    const std::vector<double> x{2.5, 0.1, 1.0, 0.7};
+    const auto values{interpolate(x)};
+    for (std::size_t i{0}; i < x.size(); ++i)
+        EXPECT_EQ(values[i], interpolate(x[i]));
+}
+
+TEST(LegendreInterpolate, Accuracy)
+{
+    const std::vector<double> boundaries{0.0, 1.0, 2.0};
+    const std::vector<std::size_t> sizes{16, 16};
+    const auto f{[](double x) { return std::exp(Complex{0.0, 3.0 * x}); }};
+    const cauchy::Legendre_interpolate interpolate{
+        boundaries, sizes, sample_legendre(boundaries, sizes, f)};
+    constexpr double tolerance{1e-14};
+    for (double x{0.0}; x < 2.0; x += 0.0371)
+        expect_near(interpolate(x), f(x), tolerance);
+}
+
+Complex polygon(const std::vector<Complex>& vertices, double t)
+{
+    const auto k{std::min(static_cast<std::size_t>(t), vertices.size() - 2)};
+    return vertices[k] + (vertices[k + 1] - vertices[k]) * (t - k);
+}
+
+TEST(LegendreInterpolate, PolygonIntegral)
+{
+    // f(z) = z^2, such that
+    // int dz f(z)/(z-s) = [z^2/2 + s z + s^2 log(z-s)]
+    const std::vector<Complex> z{{1.0, 0.0}, {2.0, 0.0}, {3.0, 1.0}};
+    const std::vector<double> boundaries{0.0, 1.0, 2.0};
+    const std::vector<std::size_t> sizes{3, 4};
+    const cauchy::Legendre_interpolate f{boundaries, sizes,
+        sample_legendre(boundaries, sizes,
+                [&](double t) { return std::pow(polygon(z, t), 2); })};
+    const auto expected{[&](const Complex& s, int subtractions, bool pv)
+        {
+            Complex result{0.0, 0.0};
+            for (std::size_t k{0}; k + 1 < z.size(); ++k) {
+                const Complex log{pv && k == 0
+                    ? std::log(std::abs((z[1] - s) / (z[0] - s)))
+                    : std::log((z[k + 1] - s) / (z[k] - s))};
+                result += s * s * log;
+                if (subtractions == 0)
+                    result += (z[k + 1] * z[k + 1] - z[k] * z[k]) / 2.0
+                        + s * (z[k + 1] - z[k]);
+            }
+            return result;
+        }};
+
+    constexpr double tolerance{1e-13};
+    for (const Complex s: {Complex{1.5, 0.3}, Complex{2.5, 0.5 + 1e-9},
+            Complex{0.0, -1.0}, Complex{100.0, 50.0}, Complex{-3.0, 0.0}})
+        for (const int n: {0, 2})
+            expect_near(f.polygon_integral(z, s, n), expected(s, n, false),
+                    tolerance * std::max(1.0, std::norm(s)));
+    for (const int n: {0, 2})
+        expect_near(f.polygon_integral(z, 1.5, n, {0, 1}),
+                expected(1.5, n, true), tolerance);
+}
+
+TEST(LegendreInterpolate, Throw)
+{
+    const std::vector<Complex> y(5, 1.0);
+    ASSERT_THROW((cauchy::Legendre_interpolate{{0.0, 1.0}, {2, 3}, y}),
+            std::invalid_argument);
+    ASSERT_THROW((cauchy::Legendre_interpolate{{0.0, 1.0, 1.0}, {2, 3}, y}),
+            std::invalid_argument);
+    ASSERT_THROW((cauchy::Legendre_interpolate{{0.0, 1.0, 2.0}, {5, 0}, y}),
+            std::invalid_argument);
+    ASSERT_THROW((cauchy::Legendre_interpolate{{0.0, 1.0, 2.0}, {2, 2}, y}),
+            std::invalid_argument);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,6 +1,8 @@
+#include "constants.h"
 #include "gsl_interface.h"
 #include "gtest/gtest.h"
 #include <cmath>
+#include <limits>
 #include <vector>
 
 using gsl::Gauss_Legendre;
@@ -114,6 +116,162 @@ TEST(GaussLegendre, Resize)
     test_integration(g);
 }
 
+TEST(TanhSinh, SquareRoot)
+{
+    const gsl::Tanh_sinh integrate{};
+    constexpr double tolerance{1e-10};
+    const auto result{integrate([](double x){return std::sqrt(x);},0.0,1.0)};
+    EXPECT_NEAR(result.first,2.0/3.0,tolerance);
+}
+
+TEST(TanhSinh, EndpointSingularity)
+{
+    const gsl::Tanh_sinh integrate{};
+    constexpr double tolerance{1e-8};
+    const auto result{
+        integrate([](double x){return 1.0/std::sqrt(x);},0.0,1.0)};
+    EXPECT_NEAR(result.first,2.0,tolerance);
+}
+
+TEST(TanhSinh, Infinite)
+{
+    const gsl::Tanh_sinh integrate{};
+    constexpr double tolerance{1e-9};
+    const auto inf{std::numeric_limits<double>::infinity()};
+    const auto result{integrate([](double x){return std::exp(-x);},0.0,inf)};
+    EXPECT_NEAR(result.first,1.0,tolerance);
+}
+
+TEST(GaussJacobi, SquareRoot)
+{
+    gsl::Settings settings{};
+    settings.lower_exponent = 0.5;
+    settings.upper_exponent = 0.5;
+    const gsl::Gauss_Jacobi integrate{settings};
+    constexpr double tolerance{1e-12};
+    const auto f{[](double x){return std::sqrt((x-1.0)*(3.0-x))*x;}};
+    const auto result{integrate(f,1.0,3.0)};
+    EXPECT_NEAR(result.first,constants::pi(),tolerance);
+
+    const auto reversed{integrate(f,3.0,1.0)};
+    EXPECT_NEAR(reversed.first,-constants::pi(),tolerance);
+}
+
+TEST(GaussJacobi, InvalidExponent)
+{
+    gsl::Settings settings{};
+    settings.lower_exponent = -1.0;
+    ASSERT_THROW(gsl::Gauss_Jacobi{settings},std::invalid_argument);
+}
+
+TEST(WarmStart, Integrate)
+{
+    const gsl::Warm_start integrate{};
+    const auto f{[](double x){return std::exp(-x*x);}};
+    const double inf{std::numeric_limits<double>::infinity()};
+    EXPECT_NEAR(integrate(f,-inf,inf).first,std::sqrt(constants::pi()),1e-9);
+    EXPECT_NEAR(integrate(f,inf,0.0).first,-std::sqrt(constants::pi())/2.0,
+            1e-9);
+}
+
+TEST(WarmStart, ReusePartition)
+{
+    const gsl::Warm_start integrate{};
+    std::size_t evaluations{0};
+    const auto peak{[&evaluations](double width)
+        {
+            return [&evaluations,width](double x)
+            {
+                ++evaluations;
+                return width/(x*x+width*width);
+            };
+        }};
+
+    integrate(peak(1e-3),-1.0,1.0);
+    const std::size_t cold{evaluations};
+    evaluations = 0;
+    const double value{integrate(peak(1.1e-3),-1.0,1.0).first};
+    EXPECT_LT(evaluations,cold);
+    EXPECT_NEAR(value,2.0*std::atan(1.0/1.1e-3),1e-6);
+}
+
+TEST(Batch, AgreesWithScalar)
+{
+    const auto f{[](double x){return std::sqrt(x)*std::exp(-x);}};
+    const gsl::Batch_function batch{[&f](const std::vector<double>& x)
+        {
+            std::vector<double> result(x.size());
+            std::transform(x.begin(),x.end(),result.begin(),f);
+            return result;
+        }};
+
+    const gsl::Warm_start warm{};
+    const gsl::Tanh_sinh tanh_sinh{};
+    const gsl::Gauss_Jacobi gauss_jacobi{};
+    const gsl::Cquad cquad{};
+    const std::vector<const gsl::Integration*> routines{
+        &warm,&tanh_sinh,&gauss_jacobi,&cquad};
+    for (const auto* integrate: routines) {
+        EXPECT_NEAR(integrate->batch(batch,0.0,2.0).first,
+                (*integrate)(f,0.0,2.0).first,1e-12);
+    }
+}
+
+TEST(Batch, OneCallPerRule)
+{
+    std::size_t calls{0};
+    const gsl::Batch_function batch{[&calls](const std::vector<double>& x)
+        {
+            ++calls;
+            return std::vector<double>(x.size(),1.0);
+        }};
+    const gsl::Warm_start integrate{};
+    EXPECT_NEAR(integrate.batch(batch,0.0,3.0).first,3.0,1e-14);
+    EXPECT_EQ(calls,1u);
+}
+
+TEST(Breakpoints, Kink)
+{
+    const auto f{[](double x){return std::abs(x-1.0);}};
+    const gsl::Interval points{0.0,1.0,3.0};
+    EXPECT_NEAR(gsl::Qag{}(f,points).first,2.5,1e-12);
+    EXPECT_NEAR(gsl::Cquad{}(f,points).first,2.5,1e-12);
+    EXPECT_NEAR(gsl::Tanh_sinh{}(f,points).first,2.5,1e-12);
+}
+
+TEST(Breakpoints, GaussJacobi)
+{
+    // The square root is only present at the lower end of the interval.
+    const auto f{[](double x){return std::sqrt(x)*std::abs(x-1.0);}};
+    const gsl::Gauss_Jacobi integrate{};
+    const double expected{(8.0+4.0*std::sqrt(2.0))/15.0};
+    EXPECT_NEAR(integrate(f,{0.0,1.0,2.0}).first,expected,1e-10);
+}
+
+TEST(Breakpoints, Unsorted)
+{
+    const auto f{[](double x){return x;}};
+    ASSERT_THROW(gsl::Qag{}(f,{1.0,0.0}),std::invalid_argument);
+    ASSERT_THROW(gsl::Cquad{}(f,{1.0}),std::invalid_argument);
+}
+
+TEST(PrincipalValue, Polynomial)
+{
+    // x^2/(x-1) = x + 1 + 1/(x-1), the last term does not contribute
+    const gsl::Principal_value integrate{};
+    const auto f{[](double x){return x*x;}};
+    EXPECT_NEAR(integrate(f,0.0,2.0,1.0).first,4.0,1e-10);
+    EXPECT_NEAR(integrate(f,2.0,0.0,1.0).first,-4.0,1e-10);
+}
+
+TEST(PrincipalValue, Infinite)
+{
+    const gsl::Principal_value integrate{};
+    const auto f{[](double x){return std::exp(-x);}};
+    ASSERT_THROW(integrate(f,0.0,std::numeric_limits<double>::infinity(),1.0),
+            std::invalid_argument);
+}
+
 TEST(Interpolate, Sample)
 {
     std::vector<double> knots{1,2,3,4,5};
@@ -123,6 +281,18 @@ TEST(Interpolate, Sample)
     EXPECT_DOUBLE_EQ(f(x),i(x));
 }
 
+TEST(Interpolate, Batch)
+{
+    std::vector<double> knots{1,2,3,4,5};
+    auto f{[](double x){return x*x;}};
+    Interpolate i{gsl::sample(f,knots,gsl::Interpolation_method::cubic)};
+    const std::vector<double> x{0.5,1.5,2.5,4.2,3.1,6.0};
+    const auto values{i(x)};
+    ASSERT_EQ(values.size(),x.size());
+    for (std::size_t k{0}; k<x.size(); ++k)
+        EXPECT_EQ(values[k],i(x[k]));
+}
+
 TEST(Interpolate, Throw)
 {
     std::vector<double> knots{1};
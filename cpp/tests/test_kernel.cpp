@@ -0,0 +1,294 @@
+#include "kernel.h"
+#include "piecewise.h"
+#include "gtest/gtest.h"
+#include "test_common.h"
+#include <cmath>
+#include <vector>
+
+using namespace std::complex_literals;
+
+double elastic_phase(double s)
+{
+    if (s<=4.0)
+        return 0.0;
+    return std::atan2(3.0*std::pow(s/4.0-1.0,1.5)/std::sqrt(s),30.0-s);
+}
+
+Complex elastic_amplitude(Complex s)
+    // the amplitude with phase `elastic_phase`
+{
+    const Complex sigma{phase_space::sigma(1.0,s)};
+    return 3.0*s*sigma*sigma/8.0/(30.0-s-3.0i*s*sigma*sigma*sigma/8.0);
+}
+
+Complex shifted_amplitude(Complex s)
+    // an amplitude whose phase differs from `elastic_phase`
+{
+    return (1.0+0.1i)*elastic_amplitude(s);
+}
+
+class Kernel : public ::testing::Test {
+protected:
+    const omnes::OmnesF omnes{elastic_phase,4.0,M_PI,1e10,1e-10};
+    const piecewise::Real curve{4.0,100.0};
+    const grid::Grid<piecewise::Real> g{grid::make_grid(curve,{10},4)};
+    static constexpr int subtractions{2};
+
+    kernel::Grid_samples samples(const kernel::CFunction& pi_pi,
+            const kernel::Kinematic_grid& kinematics) const
+    {
+        const kernel::CurvedOmnes o(omnes,pi_pi,g);
+        return kernel::Grid_samples{o,kernel::sample_x(pi_pi,g),kinematics};
+    }
+};
+
+TEST_F(Kernel, IsReal)
+{
+    // scattering kinematics
+    const kernel::Kinematic_grid real{g,1.0,0.0};
+    EXPECT_TRUE(kernel::is_real(samples(elastic_amplitude,real),real,
+                subtractions));
+    EXPECT_FALSE(kernel::is_real(samples(shifted_amplitude,real),real,
+                subtractions));
+    // complex values of t
+    const kernel::Kinematic_grid decay{g,1.0,12.0};
+    EXPECT_FALSE(kernel::is_real(samples(elastic_amplitude,decay),decay,
+                subtractions));
+}
+
+TEST_F(Kernel, RealKernel)
+{
+    const kernel::Kinematic_grid kinematics{g,1.0,0.0};
+    const auto s{samples(elastic_amplitude,kinematics)};
+    const kernel::Matrix complex{kernel::generate_kernel(s,kinematics,
+            subtractions)};
+    const kernel::Real_matrix real{kernel::generate_real_kernel(s,kinematics,
+            subtractions)};
+    const double scale{complex.cwiseAbs().maxCoeff()};
+    EXPECT_LT((real-complex.real()).cwiseAbs().maxCoeff(),1e-13*scale);
+    EXPECT_LT(complex.imag().cwiseAbs().maxCoeff(),1e-13*scale);
+
+    kernel::Vector start(kinematics.size());
+    for (std::size_t k{0}; k<kinematics.size(); ++k)
+        start(k) = kinematics.t()[k]*s.omnes_t(k);
+    const kernel::Vector expected{kernel::inverse(complex,start)};
+    const kernel::Vector solution{kernel::inverse(real,start)};
+    EXPECT_LT((solution-expected).cwiseAbs().maxCoeff(),
+            1e-13*expected.cwiseAbs().maxCoeff());
+
+    // basis takes the real path and yields the same solution
+    const auto basis{kernel::basis(s,kinematics,subtractions)};
+    EXPECT_EQ(basis[1],solution);
+}
+
+TEST_F(Kernel, PanelZSizes)
+{
+    // Along the real axis, the basis converges quickly in the number of
+    // knots in the z-plane. Three knots on the first panel suffice, whereas
+    // three on the second one cause deviations of about 1e-3.
+    const std::vector<double> panels{0.0,0.25,1.0};
+    const std::vector<std::size_t> x_sizes{10,10};
+    const grid::Grid<piecewise::Real> reference{curve,panels,x_sizes,12};
+    const grid::Grid<piecewise::Real> mixed{curve,panels,x_sizes,
+        std::vector<std::size_t>{3,5}};
+    const std::vector<Complex> s{2.0,10.0+3.0i,-20.0,50.0+1.0i};
+    for (const auto method: {kernel::Method::inverse,
+            kernel::Method::iteration}) {
+        const kernel::Basis<piecewise::Real> expected{omnes,
+            elastic_amplitude,subtractions,reference,1.0,5.0,method,1e-14};
+        const kernel::Basis<piecewise::Real> b{omnes,elastic_amplitude,
+            subtractions,mixed,1.0,5.0,method,1e-14};
+        const kernel::Matrix values{b.evaluate_all(s)};
+        const kernel::Matrix expected_values{expected.evaluate_all(s)};
+        for (Eigen::Index i{0}; i<values.rows(); ++i)
+            for (Eigen::Index k{0}; k<values.cols(); ++k)
+                expect_near(values(i,k),expected_values(i,k),
+                        1e-4*std::abs(expected_values(i,k)));
+    }
+}
+
+TEST_F(Kernel, InhomogeneitiesPerPanel)
+{
+    // At the values of x of the grid, the angular averages use the values of
+    // t of the KT equations, i.e. the rule and size of the respective panel.
+    const std::vector<grid::Rule> rules{grid::Rule{},
+        grid::Rule{grid::Quadrature::fejer}};
+    const grid::Grid<piecewise::Real> mixed{curve,{0.0,0.25,1.0},{10,10},
+        {3,5},rules};
+    const kernel::Basis<piecewise::Real> b{omnes,elastic_amplitude,
+        subtractions,mixed,1.0,5.0};
+    for (const std::size_t j: {2,15}) {
+        const Complex x{mixed.x(j)};
+        const std::size_t z_size{mixed.z_size(j)};
+        const auto knots{grid::generate_knots(-1.0,1.0,z_size,
+                rules[j/10].z_rule())};
+        kernel::Vector expected{kernel::Vector::Zero(subtractions)};
+        for (std::size_t b_index{0}; b_index<z_size; ++b_index) {
+            const Complex t{mandelstam::t_photon_pion(x,
+                    mixed.z(j,b_index),1.0,5.0)};
+            const double weight{knots[b_index].second};
+            const double z{mixed.z(j,b_index)};
+            expected += 1.5*weight*(1.0-z*z)*b.evaluate_all(t);
+        }
+        const kernel::Vector values{b.inhomogeneities(x)};
+        for (Eigen::Index i{0}; i<subtractions; ++i)
+            expect_near(values(i),expected(i),1e-13*std::abs(expected(i)));
+    }
+}
+
+TEST_F(Kernel, ThresholdBand)
+{
+    // Points in the band around the threshold used to be shifted
+    // themselves, which recursed forever at half its width.
+    const double minimal_distance{1e-4};
+    const kernel::Basis<piecewise::Real> b{omnes,elastic_amplitude,
+        subtractions,g,1.0,5.0,kernel::Method::inverse,std::nullopt,
+        minimal_distance};
+    const double shift{1.1*minimal_distance};
+    for (const double s: {4.0-0.5*minimal_distance,4.0+0.5*minimal_distance}) {
+        const kernel::Vector values{b.evaluate_all(s)};
+        const kernel::Matrix batch{b.evaluate_all(std::vector<Complex>{s})};
+        for (int i{0}; i<subtractions; ++i) {
+            const Complex expected{(b(i,4.0-shift)+b(i,4.0+shift))/2.0};
+            const double tolerance{1e-13*std::abs(expected)};
+            expect_near(b(i,s),expected,tolerance);
+            expect_near(values(i),expected,tolerance);
+            expect_near(batch(i,0),expected,tolerance);
+        }
+    }
+}
+
+class Refinement : public ::testing::Test {
+protected:
+    const omnes::OmnesF omnes{elastic_phase,4.0,M_PI,300.0,1e-10};
+    const piecewise::Adaptive curve{1.0,60.0,300.0};
+    const grid::Grid<piecewise::Adaptive> coarse{curve,{3,3,3,3,5},3,
+        grid::Rule{grid::Quadrature::fejer}};
+    const grid::Grid<piecewise::Adaptive> fine{coarse.refined()};
+    const kernel::Kinematic_grid coarse_kinematics{coarse,1.0,60.0};
+    const kernel::Kinematic_grid fine_kinematics{fine,1.0,60.0};
+};
+
+TEST_F(Refinement, GridSamples)
+{
+    const kernel::CurvedOmnes o(omnes,elastic_amplitude,coarse);
+    const kernel::Grid_samples coarse_samples{o,
+        kernel::sample_x(elastic_amplitude,coarse),coarse_kinematics};
+    std::size_t calls{0};
+    const kernel::CFunction counted{[&calls](Complex s)
+        {
+            ++calls;
+            return elastic_amplitude(s);
+        }};
+    const kernel::Grid_samples refined{o,counted,fine_kinematics,coarse,
+        coarse_samples};
+    // only the new values of x are sampled
+    EXPECT_EQ(calls,fine.x_size()-coarse.x_size());
+
+    const kernel::Grid_samples expected{o,
+        kernel::sample_x(elastic_amplitude,fine),fine_kinematics};
+    ASSERT_EQ(refined.pi_pi.size(),expected.pi_pi.size());
+    ASSERT_EQ(refined.omnes_t.size(),expected.omnes_t.size());
+    for (std::size_t j{0}; j<fine.x_size(); ++j) {
+        expect_near(refined.pi_pi[j],expected.pi_pi[j],
+                1e-12*std::abs(expected.pi_pi[j]));
+        expect_near(refined.omnes_x[j],expected.omnes_x[j],
+                1e-12*std::abs(expected.omnes_x[j]));
+    }
+    for (Eigen::Index k{0}; k<expected.omnes_t.size(); ++k)
+        expect_near(refined.omnes_t(k),expected.omnes_t(k),
+                1e-12*std::abs(expected.omnes_t(k)));
+
+    const auto coarse_grid{grid::make_grid(curve,{3,3,3,3,5},3)};
+    EXPECT_THROW((kernel::Grid_samples{o,counted,fine_kinematics,coarse_grid,
+                coarse_samples}),std::invalid_argument);
+}
+
+TEST_F(Refinement, Error)
+{
+    // Mandelstam t agrees at the shared points, up to one perturbed value.
+    const auto& t_coarse{coarse_kinematics.t()};
+    const auto& t_fine{fine_kinematics.t()};
+    kernel::Vector coarse_values(t_coarse.size());
+    kernel::Vector fine_values(t_fine.size());
+    for (std::size_t k{0}; k<t_coarse.size(); ++k)
+        coarse_values(k) = t_coarse[k];
+    for (std::size_t k{0}; k<t_fine.size(); ++k)
+        fine_values(k) = t_fine[k];
+    const double scale{fine_values.cwiseAbs().maxCoeff()};
+    EXPECT_LT(kernel::refinement_error(coarse,coarse_values,fine,fine_values),
+            1e-13);
+    coarse_values(coarse.index(4,1)) += 1e-3*scale;
+    EXPECT_NEAR(kernel::refinement_error(coarse,coarse_values,fine,
+                fine_values),1e-3,1e-13);
+
+    // the basis, reusing the samples on the coarse grid or not
+    const kernel::CurvedOmnes o(omnes,elastic_amplitude,coarse);
+    const auto coarse_basis{kernel::basis(o,
+            kernel::sample_x(elastic_amplitude,coarse),2,coarse,1.0,60.0)};
+    const auto fine_basis{kernel::basis(o,
+            kernel::sample_x(elastic_amplitude,fine),2,fine,1.0,60.0)};
+    const double expected{std::max(
+            kernel::refinement_error(coarse,coarse_basis[0],fine,
+                fine_basis[0]),
+            kernel::refinement_error(coarse,coarse_basis[1],fine,
+                fine_basis[1]))};
+    const double error{kernel::refinement_error(omnes,elastic_amplitude,2,
+            coarse,1.0,60.0)};
+    EXPECT_GT(error,0.0);
+    EXPECT_NEAR(error,expected,1e-10);
+}
+
+TEST(KernelOperator, Multipole)
+{
+    // a realistic grid, on which the Cauchy sums are expanded by default
+    const omnes::OmnesF omnes{elastic_phase,4.0,M_PI,300.0,1e-10};
+    const piecewise::Adaptive curve{1.0,60.0,300.0};
+    const auto g{grid::make_grid(curve,{40,40,40,40,80},8)};
+    const kernel::Kinematic_grid kinematics{g,1.0,60.0};
+    const kernel::Grid_samples samples{
+        kernel::CurvedOmnes(omnes,elastic_amplitude,g),
+        kernel::sample_x(elastic_amplitude,g),kinematics};
+    const kernel::Kernel_operator kernel{samples,kinematics,2};
+    EXPECT_FALSE(kernel.is_direct());
+
+    const kernel::Matrix matrix{kernel::generate_kernel(samples,kinematics,
+            2)};
+    kernel::Vector v(kinematics.size());
+    for (Eigen::Index k{0}; k<v.size(); ++k)
+        v(k) = Complex{std::cos(0.1*k),std::sin(0.03*k)};
+    const kernel::Vector expected{matrix*v};
+    EXPECT_LT((kernel*v-expected).cwiseAbs().maxCoeff(),
+            1e-10*expected.cwiseAbs().maxCoeff());
+}
+
+template<typename C>
+kernel::Vector basis_at_two(const C& curve)
+    // both basis functions at s=2 for a virtuality of 60 pion masses squared
+{
+    const omnes::OmnesF omnes{elastic_phase,4.0,M_PI,300.0,1e-10};
+    std::vector<std::size_t> sizes(curve.boundaries().size()-1,8);
+    sizes.back() = 16;
+    const kernel::Basis<C> b{omnes,elastic_amplitude,2,
+        grid::make_grid(curve,sizes,6),1.0,60.0};
+    return b.evaluate_all(2.0);
+}
+
+TEST(Contours, TracedAgreesWithAdaptive)
+{
+    // The basis functions do not depend on the contour below the real axis.
+    // In particular, a first side of `Traced` that cuts the corner at the
+    // threshold does not reproduce the other contours.
+    const kernel::Vector traced{basis_at_two(piecewise::Traced{1.0,60.0,
+                300.0})};
+    for (const auto& other: {basis_at_two(piecewise::Adaptive{1.0,60.0,300.0}),
+            basis_at_two(piecewise::Smooth_adaptive{1.0,60.0,300.0})})
+        for (int i{0}; i<2; ++i)
+            expect_near(traced(i),other(i),3e-3*std::abs(other(i)));
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,121 @@
+#include "rational.h"
+#include "gtest/gtest.h"
+#include "test_common.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using rational::aaa;
+using rational::Matrix;
+using rational::Rational;
+
+std::vector<Complex> circle(Complex centre, double radius, std::size_t n)
+{
+    std::vector<Complex> z(n);
+    for (std::size_t k{0}; k<n; ++k)
+        z[k] = centre+std::polar(radius,2.0*M_PI*k/n);
+    return z;
+}
+
+Complex shifted_exponential(Complex z)
+{
+    return std::exp(z)/(z-2.0);
+}
+
+Matrix sample(const std::vector<Complex>& z)
+{
+    Matrix f(2,z.size());
+    for (std::size_t k{0}; k<z.size(); ++k) {
+        f(0,k) = shifted_exponential(z[k]);
+        f(1,k) = std::tan(z[k]);
+    }
+    return f;
+}
+
+double distance(const std::vector<Complex>& points, Complex z)
+{
+    double result{INFINITY};
+    for (const auto& p: points)
+        result = std::min(result,std::abs(p-z));
+    return result;
+}
+
+TEST(Rational, Reproduce)
+{
+    const auto z{circle(0.0,1.0,100)};
+    const Rational r{aaa(z,sample(z))};
+    EXPECT_EQ(r.size(),2u);
+    EXPECT_LT(r.error(),1e-12);
+    EXPECT_LT(r.degree(),30u);
+    // inside the circle, where both functions are analytic
+    for (const Complex s: {Complex{0.0,0.0},Complex{0.3,-0.5},
+            Complex{-0.7,0.1}}) {
+        expect_near(r(0,s),shifted_exponential(s),1e-12);
+        expect_near(r(1,s),std::tan(s),1e-12);
+        const auto all{r.evaluate_all(s)};
+        expect_near(all(0),r(0,s),1e-14);
+        expect_near(all(1),r(1,s),1e-14);
+    }
+    // at the support points, the values are reproduced exactly
+    EXPECT_EQ(r(1,r.support_points()[2]),r.values()(1,2));
+}
+
+TEST(Rational, Poles)
+{
+    const auto z{circle(0.0,1.0,100)};
+    const auto poles{aaa(z,sample(z)).poles()};
+    EXPECT_LT(distance(poles,2.0),1e-2);
+    EXPECT_LT(distance(poles,M_PI/2.0),1e-2);
+    EXPECT_LT(distance(poles,-M_PI/2.0),1e-2);
+}
+
+TEST(Rational, Single)
+{
+    const auto z{circle(0.0,1.0,100)};
+    std::vector<Complex> f(z.size());
+    for (std::size_t k{0}; k<z.size(); ++k)
+        f[k] = std::tan(z[k]);
+    const Rational single{aaa(z,f)};
+    EXPECT_EQ(single.size(),1u);
+    EXPECT_LE(single.degree(),aaa(z,sample(z)).degree());
+    expect_near(single(0,0.2),std::tan(0.2),1e-12);
+}
+
+TEST(Rational, Constant)
+{
+    const auto z{circle(0.0,1.0,10)};
+    const Rational r{aaa(z,std::vector<Complex>(z.size(),Complex{3.0,1.0}))};
+    EXPECT_EQ(r.degree(),0u);
+    EXPECT_EQ(r(0,0.5),(Complex{3.0,1.0}));
+    EXPECT_TRUE(r.poles().empty());
+}
+
+TEST(Rational, Restore)
+{
+    const auto z{circle(0.0,1.0,100)};
+    const Rational original{aaa(z,sample(z))};
+    const Rational restored{original.support_points(),original.weights(),
+        original.values(),original.error()};
+    for (const Complex s: {Complex{0.1,0.2},Complex{5.0,-3.0}})
+        EXPECT_EQ(restored.evaluate_all(s),original.evaluate_all(s));
+    EXPECT_EQ(restored.error(),original.error());
+}
+
+TEST(Rational, Throw)
+{
+    const auto z{circle(0.0,1.0,10)};
+    ASSERT_THROW(aaa(z,Matrix(2,5)),std::invalid_argument);
+    ASSERT_THROW(aaa(z,sample(z),1e-12,0),std::invalid_argument);
+    ASSERT_THROW((Rational{{},{},Matrix(1,0)}),std::invalid_argument);
+    ASSERT_THROW((Rational{{1.0,2.0},{1.0},Matrix(1,2)}),
+            std::invalid_argument);
+    const Rational r{aaa(z,sample(z))};
+    ASSERT_THROW(r(2,0.0),std::out_of_range);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+#include "spline.h"
+#include "gtest/gtest.h"
+#include "test_common.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using spline::Knots;
+using spline::Method;
+using spline::Spline;
+
+std::vector<double> uniform(double lower, double upper, std::size_t n)
+{
+    std::vector<double> x(n);
+    for (std::size_t i{0}; i<n; ++i)
+        x[i] = lower+(upper-lower)*i/(n-1);
+    return x;
+}
+
+std::vector<double> apply(double (*f)(double), const std::vector<double>& x)
+{
+    std::vector<double> y(x.size());
+    for (std::size_t i{0}; i<x.size(); ++i)
+        y[i] = f(x[i]);
+    return y;
+}
+
+TEST(Knots, Locate)
+{
+    const Knots knots{{0.0,0.1,0.15,0.9,1.0,3.0}};
+    EXPECT_EQ(knots.locate(-1.0),0u);
+    EXPECT_EQ(knots.locate(0.05),0u);
+    EXPECT_EQ(knots.locate(0.1),1u);
+    EXPECT_EQ(knots.locate(0.5),2u);
+    EXPECT_EQ(knots.locate(0.95),3u);
+    EXPECT_EQ(knots.locate(2.0),4u);
+    EXPECT_EQ(knots.locate(3.0),4u);
+    EXPECT_EQ(knots.locate(4.0),4u);
+}
+
+TEST(Knots, LocateUniform)
+{
+    const Knots knots{uniform(-1.0,2.0,31)};
+    for (std::size_t i{0}; i+1<knots.size(); ++i) {
+        EXPECT_EQ(knots.locate(knots[i]),i);
+        EXPECT_EQ(knots.locate(0.5*(knots[i]+knots[i+1])),i);
+    }
+}
+
+TEST(Knots, Throw)
+{
+    ASSERT_THROW(Knots{{1.0}},std::invalid_argument);
+    ASSERT_THROW((Knots{{1.0,1.0,2.0}}),std::invalid_argument);
+    ASSERT_THROW((Knots{{1.0,3.0,2.0}}),std::invalid_argument);
+}
+
+TEST(Spline, ReproduceLinear)
+{
+    const std::vector<double> x{0.0,0.3,0.5,1.2,2.0,2.1,3.0};
+    const auto f{[](double x){return 2.0*x-1.0;}};
+    std::vector<double> y(x.size());
+    for (std::size_t i{0}; i<x.size(); ++i)
+        y[i] = f(x[i]);
+
+    constexpr double tolerance{1e-14};
+    for (const auto m: {Method::linear,Method::cubic,Method::akima,
+            Method::steffen}) {
+        const Spline<double> s{x,y,m};
+        for (const double point: {0.1,0.5,0.77,2.05,2.9})
+            EXPECT_NEAR(s(point),f(point),tolerance);
+    }
+}
+
+TEST(Spline, Accuracy)
+{
+    const auto x{uniform(0.0,3.0,101)};
+    const auto y{apply(std::sin,x)};
+
+    const std::vector<std::pair<Method,double>> methods{
+        {Method::linear,2e-4},
+        {Method::cubic,1e-6},
+        {Method::akima,1e-5},
+        {Method::steffen,1e-4}};
+    for (const auto& [m,tolerance]: methods) {
+        const Spline<double> s{x,y,m};
+        for (double point{0.1}; point<2.9; point+=0.0731)
+            EXPECT_NEAR(s(point),std::sin(point),tolerance);
+    }
+}
+
+TEST(Spline, NaturalCubic)
+{
+    // S(x) = 3x/2-x^3/2 on [0,1] and mirrored on [1,2]
+    const Spline<double> s{{0.0,1.0,2.0},{0.0,1.0,0.0},Method::cubic};
+    const auto expected{[](double x){return 1.5*x-0.5*x*x*x;}};
+    constexpr double tolerance{1e-15};
+    for (const double point: {0.1,0.25,0.5,0.9}) {
+        EXPECT_NEAR(s(point),expected(point),tolerance);
+        EXPECT_NEAR(s(2.0-point),expected(point),tolerance);
+    }
+}
+
+TEST(Spline, Monotonic)
+{
+    const std::vector<double> x{0.0,1.0,2.0,3.0,4.0,5.0};
+    const std::vector<double> y{0.0,0.0,0.0,1.0,1.0,1.0};
+    const Spline<double> s{x,y,Method::steffen};
+    constexpr double tolerance{1e-15};
+    for (double point{0.0}; point<=5.0; point+=0.01) {
+        EXPECT_GE(s(point),-tolerance);
+        EXPECT_LE(s(point),1.0+tolerance);
+    }
+}
+
+TEST(Spline, Boundaries)
+{
+    const std::vector<double> x{1.0,2.0,3.0};
+    const Spline<double> s{x,{1.0,4.0,9.0},Method::cubic};
+    EXPECT_DOUBLE_EQ(s(0.0),1.0);
+    EXPECT_DOUBLE_EQ(s(1.0),1.0);
+    EXPECT_DOUBLE_EQ(s(3.0),9.0);
+    EXPECT_DOUBLE_EQ(s(5.0),9.0);
+}
+
+TEST(Spline, Complex)
+{
+    const auto x{uniform(0.0,2.0,21)};
+    std::vector<double> re(x.size());
+    std::vector<double> im(x.size());
+    std::vector<Complex> z(x.size());
+    for (std::size_t i{0}; i<x.size(); ++i) {
+        re[i] = std::exp(-x[i]);
+        im[i] = std::abs(x[i]-0.77);
+        z[i] = Complex{re[i],im[i]};
+    }
+
+    for (const auto m: {Method::linear,Method::cubic,Method::akima,
+            Method::steffen}) {
+        const Spline<Complex> complex{x,z,m};
+        const Spline<double> real_part{x,re,m};
+        const Spline<double> imaginary_part{x,im,m};
+        for (double point{0.0}; point<2.0; point+=0.037)
+            expect_near(complex(point),
+                    {real_part(point),imaginary_part(point)},1e-15);
+    }
+}
+
+TEST(Spline, Copy)
+{
+    const auto x{uniform(0.0,1.0,11)};
+    const auto y{apply(std::exp,x)};
+    const Spline<double> original{x,y,Method::akima};
+    Spline<double> copy{original};
+    const Spline<double> moved{std::move(copy)};
+    EXPECT_EQ(original(0.33),moved(0.33));
+}
+
+TEST(Spline, Batch)
+{
+    const std::vector<double> x{0.0,0.1,0.15,0.9,1.0,3.0};
+    std::vector<Complex> y(x.size());
+    for (std::size_t i{0}; i<x.size(); ++i)
+        y[i] = Complex{std::cos(x[i]),x[i]*x[i]};
+
+    const std::vector<double> sorted{-1.0,0.0,0.01,0.12,0.13,0.5,0.95,2.0,
+        3.0,3.5};
+    const std::vector<double> unsorted{2.0,0.01,3.5,0.5,-1.0,0.95,0.12};
+    for (const auto m: {Method::linear,Method::cubic,Method::akima,
+            Method::steffen}) {
+        const Spline<Complex> s{x,y,m};
+        for (const auto& points: {sorted,unsorted}) {
+            const auto values{s(points)};
+            ASSERT_EQ(values.size(),points.size());
+            for (std::size_t i{0}; i<points.size(); ++i)
+                EXPECT_EQ(values[i],s(points[i]));
+        }
+    }
+}
+
+TEST(Spline, Throw)
+{
+    const std::vector<double> x{0.0,1.0,2.0,3.0};
+    ASSERT_THROW((Spline<double>{x,{1.0,2.0},Method::linear}),
+            std::invalid_argument);
+    ASSERT_THROW((Spline<double>{x,{1.0,2.0,3.0,4.0},Method::akima}),
+            std::invalid_argument);
+    ASSERT_THROW((Spline<double>{{0.0,2.0,1.0},{1.0,2.0,3.0},Method::cubic}),
+            std::invalid_argument);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
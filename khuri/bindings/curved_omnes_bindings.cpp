@@ -5,6 +5,7 @@
 #include "pybind11/complex.h"
 #include "pybind11/functional.h"
 #include "pybind11/numpy.h"
+#include "pybind11/stl.h"
 
 #include <utility>
 
@@ -12,33 +13,60 @@ namespace py = pybind11;
 using omnes::OmnesF;
 using curved_omnes::CFunction;
 using curved_omnes::CurvedOmnes;
+using curved_omnes::Region;
+using curved_omnes::Complex;
 
 template<typename C>
-CurvedOmnes make_curved(omnes::OmnesF o, CFunction amplitude, C curve)
+CurvedOmnes make_curved(omnes::OmnesF o, CFunction amplitude, C curve,
+                        std::size_t samples)
 {
-    return CurvedOmnes(std::move(o), std::move(amplitude), std::move(curve));
+    return CurvedOmnes(std::move(o), std::move(amplitude), std::move(curve),
+                       samples);
 }
 
 template<typename C>
-void create_binding(py::module&m, const std::string& name)
+void create_binding(py::module&m, py::class_<Region>& region,
+                    const std::string& name)
 {
     m.def(("make_curved_" + name).c_str(),
           make_curved<C>,
           "generate a curved Omnes function",
           py::arg("omnes"),
           py::arg("amplitude"),
-          py::arg("curve"));
+          py::arg("curve"),
+          py::arg("samples")=64);
+    region.def(py::init<const C&, std::size_t>(),
+               py::arg("curve"),
+               py::arg("samples")=64);
 }
 
 PYBIND11_MODULE(_khuri_curved_omnes, m) {
     m.doc() = "The Omnes function with cut along a somewhat general curve.";
 
     py::class_<CurvedOmnes>(m, "_CurvedOmnes")
-        .def("__call__", py::vectorize(&CurvedOmnes::operator()),
+        .def("__call__",
+             py::vectorize([](const CurvedOmnes& c, Complex s) {
+                 return c(s);
+             }),
              py::arg("mandelstam_s"))
         .def("original", &CurvedOmnes::original);
 
-    create_binding<piecewise::Real>(m, "real");
-    create_binding<piecewise::Vector_decay>(m, "vector_decay");
-    create_binding<piecewise::Adaptive>(m, "adaptive");
+    py::class_<Region> region(m, "Region",
+                              "The region enclosed by a curve and the real"
+                              " axis in the lower half plane, where a curved"
+                              " Omnes function is evaluated on its second"
+                              " sheet.");
+    region
+        .def("contains",
+             py::overload_cast<const std::vector<Complex>&>(
+                 &Region::contains, py::const_),
+             "Determine for all `s` at once whether they lie inside the"
+             " region.",
+             py::arg("s"));
+
+    create_binding<piecewise::Real>(m, region, "real");
+    create_binding<piecewise::Vector_decay>(m, region, "vector_decay");
+    create_binding<piecewise::Adaptive>(m, region, "adaptive");
+    create_binding<piecewise::Smooth_adaptive>(m, region, "smooth_adaptive");
+    create_binding<piecewise::Traced>(m, region, "traced");
 }
@@ -8,8 +8,10 @@ PYBIND11_MODULE(_khuri_gsl, m) {
     m.doc() = "Interface to the gsl library.";
 
     py::class_<gsl::Settings>(m, "Settings")
-        .def(py::init<double, double, std::size_t>(),
+        .def(py::init<double, double, std::size_t, double, double>(),
              py::arg("absolute_precision") = 0.0,
              py::arg("relative_precision") = 1e-7,
-             py::arg("space") = 1000);
+             py::arg("space") = 1000,
+             py::arg("lower_exponent") = 0.5,
+             py::arg("upper_exponent") = 0.0);
 }
@@ -1,26 +1,35 @@
 #include "khuri_treiman.h"
 #include "omnes.h"
+#include "vectorized.h"
 
 #include "pybind11/pybind11.h"
 #include "pybind11/complex.h"
+#include "pybind11/eigen.h"
 #include "pybind11/functional.h"
 #include "pybind11/numpy.h"
 #include "pybind11/stl.h"
 
+#include <stdexcept>
 #include <vector>
 #include <tuple>
 #include <type_traits>
 
 namespace py = pybind11;
 
+using bindings::vectorized;
 using khuri_treiman::Basis;
 using khuri_treiman::Complex;
 using khuri_treiman::Curve;
 using khuri_treiman::CFunction;
 using khuri_treiman::Grid;
 using khuri_treiman::Method;
+using khuri_treiman::Path;
 using khuri_treiman::Piecewise;
 using khuri_treiman::Point;
+using khuri_treiman::Quadrature;
+using khuri_treiman::Real_table;
+using khuri_treiman::Rule;
+using khuri_treiman::Reconstruction;
 
 template<typename T>
 void create_grid_binding(py::module& m, const std::string& type_name)
@@ -38,7 +47,42 @@ void create_grid_binding(py::module& m, const std::string& type_name)
     py::class_<G, T>(m, name.c_str())
         .def(py::init<V, std::vector<std::size_t>, std::size_t>(),
              init_docstring.c_str())
+        .def(py::init<V, std::vector<std::size_t>,
+                      std::vector<std::size_t>, const Rule&>(),
+             "Same as above, but with `z_sizes[k]` knots along the line in the"
+             " z-plane for the x-values on segment k of the curve.",
+             py::arg("t"),
+             py::arg("x_sizes"),
+             py::arg("z_sizes"),
+             py::arg("rule")=Rule{})
         .def(py::init<V, double, std::size_t>())
+        .def(py::init<V, std::vector<double>, std::vector<std::size_t>,
+                      std::size_t, const Rule&>(),
+             "Same as above, but the quadrature rules are applied on the"
+             " panels bounded by the parameter values `panels`, which need to"
+             " contain all boundaries of `t`.",
+             py::arg("t"),
+             py::arg("panels"),
+             py::arg("x_sizes"),
+             py::arg("z_size"),
+             py::arg("rule")=Rule{})
+        .def(py::init<V, std::vector<double>, std::vector<std::size_t>,
+                      std::vector<std::size_t>, const Rule&>(),
+             "Same as above, but with `z_sizes[k]` knots along the line in the"
+             " z-plane for the x-values on panel k.",
+             py::arg("t"),
+             py::arg("panels"),
+             py::arg("x_sizes"),
+             py::arg("z_sizes"),
+             py::arg("rule")=Rule{})
+        .def(py::init<V, std::vector<double>, std::vector<std::size_t>,
+                      std::vector<std::size_t>, std::vector<Rule>>(),
+             "Same as above, but with rule `rules[k]` on panel k.",
+             py::arg("t"),
+             py::arg("panels"),
+             py::arg("x_sizes"),
+             py::arg("z_sizes"),
+             py::arg("rules"))
         .def("__call__", py::vectorize(&G::operator()),
              py::arg("x_index"),
              py::arg("z_index"))
@@ -47,10 +91,48 @@ void create_grid_binding(py::module& m, const std::string& type_name)
              py::arg("x_index"))
         .def("derivative", &G::derivative,
              py::arg("x_index"))
-        .def("z", &G::z,
+        .def("z", static_cast<double (G::*)(std::size_t, std::size_t) const>(
+                    &G::z),
+             py::arg("x_index"),
+             py::arg("z_index"))
+        .def("z", static_cast<double (G::*)(std::size_t) const>(&G::z),
              py::arg("z_index"))
         .def("x_size", &G::x_size)
-        .def("z_size", &G::z_size)
+        .def("z_size", static_cast<std::size_t (G::*)(std::size_t) const>(
+                    &G::z_size),
+             py::arg("x_index"))
+        .def("z_size", static_cast<std::size_t (G::*)() const>(&G::z_size))
+        .def("is_z_uniform", &G::is_z_uniform)
+        .def("size", &G::size,
+             "Return the total number of points of the grid.")
+        .def("index", &G::index,
+             "Return the position of a point in vectors containing all points"
+             " of the grid.",
+             py::arg("x_index"),
+             py::arg("z_index"))
+        .def("panel_boundaries", &G::panel_boundaries,
+             "Return the parameter values bounding the panels of"
+             " Gauss-Legendre knots in the x-plane.")
+        .def("panel_sizes", &G::panel_sizes,
+             "Return the number of knots on each panel.")
+        .def("panel_z_sizes", &G::panel_z_sizes,
+             "Return the number of knots in the z-plane for the x-values of"
+             " each panel.")
+        .def("panel_rules", &G::panel_rules,
+             "Return the rule used on each panel.")
+        .def("uses", &G::uses,
+             "Return true if `quadrature` is used on all panels.",
+             py::arg("quadrature"))
+        .def("refined", &G::refined,
+             "Return the grid with 2n+1 instead of n knots on each panel and"
+             " along each line in the z-plane, which contains all points of"
+             " this grid. Requires Quadrature.fejer.")
+        .def("refined_x_index", &G::refined_x_index,
+             "Return the index of the x-value `x_index` in `refined()`.",
+             py::arg("x_index"))
+        .def_static("refined_z_index", &G::refined_z_index,
+             "Return the index of the z-value `z_index` in `refined()`.",
+             py::arg("z_index"))
         .def("x_parameter_lower", &G::x_parameter_lower)
         .def("x_parameter_upper", &G::x_parameter_upper);
 }
@@ -75,7 +157,14 @@ void create_basis_binding(py::module& m, const std::string& type_name)
         "method: determine whether equations are solved iteratively"
         " or via direct matrix inversion\n"
         "accuracy: allows to tune the accuracy of the solution if"
-        " iteration is used.";
+        " iteration is used.\n"
+        "minimal_distance: half the width of the band around the threshold,"
+        " in which the average of neighbouring points is used\n"
+        "warm_start: if true, the dispersive integrals start from the"
+        " subdivision found in the previous evaluation, which speeds up scans"
+        " along nearby values of s.\n"
+        "reconstruction: determine how the integrands of the dispersive"
+        " integrals are interpolated between the knots of `g`";
     const std::string call_docstring =
          "Evaluate the basis function with subtraction polynomial s^`i` at `s`";
     py::class_<B>(m, name.c_str())
@@ -87,7 +176,9 @@ void create_basis_binding(py::module& m, const std::string& type_name)
                       double,
                       Method,
                       std::optional<double>,
-                      double>(),
+                      double,
+                      bool,
+                      Reconstruction>(),
              init_docstring.c_str(),
              py::arg("o"),
              py::arg("pi_pi"),
@@ -97,11 +188,131 @@ void create_basis_binding(py::module& m, const std::string& type_name)
              py::arg("virtuality"),
              py::arg("method")=Method::inverse,
              py::arg("accuracy")=std::nullopt,
-             py::arg("minimal_distance")=1e-4)
+             py::arg("minimal_distance")=1e-4,
+             py::arg("warm_start")=false,
+             py::arg("reconstruction")=Reconstruction::linear)
+        .def_static("vectorized",
+             [](const omnes::OmnesF& o, py::function pi_pi, int subtractions,
+                const G& g, double pion_mass, double virtuality,
+                Method method, std::optional<double> accuracy,
+                double minimal_distance, bool warm_start,
+                Reconstruction reconstruction)
+             {
+                 return B{o, vectorized<Complex>(std::move(pi_pi)),
+                          subtractions, g, pion_mass, virtuality, method,
+                          accuracy, minimal_distance, warm_start,
+                          reconstruction};
+             },
+             "Same as the constructor, but `pi_pi` is called once with a NumPy"
+             " array of all values of x of the grid.",
+             py::arg("o"),
+             py::arg("pi_pi"),
+             py::arg("subtractions"),
+             py::arg("g"),
+             py::arg("pion_mass"),
+             py::arg("virtuality"),
+             py::arg("method")=Method::inverse,
+             py::arg("accuracy")=std::nullopt,
+             py::arg("minimal_distance")=1e-4,
+             py::arg("warm_start")=false,
+             py::arg("reconstruction")=Reconstruction::linear)
         .def("__call__", py::vectorize(&B::operator()),
              call_docstring.c_str(),
              py::arg("i"),
-             py::arg("s"));
+             py::arg("s"))
+        .def("evaluate_all",
+             py::overload_cast<Complex>(&B::evaluate_all, py::const_),
+             "Evaluate all basis functions at `s` at once.",
+             py::arg("s"))
+        .def("evaluate_all",
+             py::overload_cast<const std::vector<Complex>&>(&B::evaluate_all,
+                                                          py::const_),
+             "Evaluate all basis functions at all elements of `s` at once."
+             " Return an array of shape (subtractions, len(s)).",
+             py::arg("s"))
+        .def("inhomogeneities",
+             py::overload_cast<Complex, std::size_t>(&B::inhomogeneities,
+                                                     py::const_),
+             "Return the angular averages 3/2 int_{-1}^1 dz (1-z^2) F(t(s,z))"
+             " of all basis functions F at `s`. The integral uses the rule"
+             " along the lines in the z-plane of the panel, whose values of x"
+             " lie closest to `s`, with `z_size` knots, by default as many as"
+             " on this panel.",
+             py::arg("s"),
+             py::arg("z_size")=0)
+        .def("inhomogeneities",
+             py::overload_cast<const std::vector<Complex>&,
+                               std::size_t>(&B::inhomogeneities, py::const_),
+             "Same as above for all elements of `s` at once. Return an array"
+             " of shape (subtractions, len(s)).",
+             py::arg("s"),
+             py::arg("z_size")=0)
+        .def("tabulate",
+             py::overload_cast<double, double, double>(&B::tabulate),
+             "Tabulate all basis functions on the interval [lower, upper] of"
+             " the real axis. Afterwards, real values of s in this interval"
+             " are interpolated.",
+             py::arg("lower"),
+             py::arg("upper"),
+             py::arg("tolerance")=1e-8)
+        .def("tabulate", py::overload_cast<Real_table>(&B::tabulate),
+             "Use `table`, e.g. one restored from an exported table.",
+             py::arg("table"))
+        .def("table", &B::table,
+             "Return the table used for real values of s, if any.")
+        .def("compress", &B::compress,
+             "Approximate all basis functions by rational functions, which"
+             " are cheap to evaluate. `samples` represent the region of"
+             " interest, e.g. points along its boundary. The result"
+             " continues the basis functions analytically beyond it.",
+             py::arg("samples"),
+             py::arg("tolerance")=1e-10,
+             py::arg("max_support")=100);
+}
+
+template<typename T>
+void create_adaptive_grid_binding(py::module& m)
+{
+    m.def("adaptive_grid", &khuri_treiman::adaptive_grid<T>,
+          "Return a grid along `curve`, whose panels are bisected where"
+          " needed to resolve the integrands of the KT equations to"
+          " `tolerance`.",
+          py::arg("o"),
+          py::arg("pi_pi"),
+          py::arg("subtractions"),
+          py::arg("curve"),
+          py::arg("pion_mass"),
+          py::arg("virtuality"),
+          py::arg("z_size"),
+          py::arg("tolerance"),
+          py::arg("order")=16,
+          py::arg("method")=Method::iteration,
+          py::arg("max_sweeps")=40);
+}
+
+template<typename T>
+void create_refinement_error_binding(py::module& m)
+{
+    using G = Grid<T>;
+    m.def("refinement_error",
+          py::overload_cast<const omnes::OmnesF&, const CFunction&, int,
+                            const G&, double, double, Method,
+                            std::optional<double>>(
+              &khuri_treiman::refinement_error<T>),
+          "Solve the KT equations on `g` and on `g.refined()`, reusing the"
+          " samples of the Omnes function and of `pi_pi` on `g`, and return"
+          " the largest difference of the basis functions at the shared"
+          " points relative to their largest modulus. `g` needs to use"
+          " Quadrature.fejer, the remaining arguments match those of the"
+          " basis.",
+          py::arg("o"),
+          py::arg("pi_pi"),
+          py::arg("subtractions"),
+          py::arg("g"),
+          py::arg("pion_mass"),
+          py::arg("virtuality"),
+          py::arg("method")=Method::inverse,
+          py::arg("accuracy")=std::nullopt);
 }
 
 template<typename T>
@@ -109,6 +320,8 @@ void create_bindings(py::module& m, const std::string& type_name)
 {
     create_grid_binding<T>(m, type_name);
     create_basis_binding<T>(m, type_name);
+    create_adaptive_grid_binding<T>(m);
+    create_refinement_error_binding<T>(m);
 }
 
 PYBIND11_MODULE(_khuri_khuri_treiman, m) {
@@ -121,12 +334,27 @@ PYBIND11_MODULE(_khuri_khuri_treiman, m) {
         .def("derivative_func", py::vectorize(&Curve::derivative_func),
              "Evaluate the derivative of the curve at `x`.",
              py::arg("x"))
+        .def("evaluate",
+             [](const Curve& c, const std::vector<double>& x) {
+                 std::vector<Complex> values(x.size());
+                 std::vector<Complex> derivatives(x.size());
+                 c.evaluate(x.data(),x.data()+x.size(),values.data(),
+                            derivatives.data());
+                 return std::make_pair(values,derivatives);
+             },
+             "Evaluate the curve and its derivative at all `x` at once.",
+             py::arg("x"))
         .def("hits", &Curve::hits,
              "Determine whether `s` hits the curve.\n\n"
              "If `s` lies on the curve, return the parameter values marking"
              " the beginning and the end of the segment that is hit.",
              py::arg("x"))
-        .def("boundaries", &Curve::boundaries);
+        .def("boundaries", &Curve::boundaries)
+        .def("is_linear", &Curve::is_linear,
+             "Return true if the curve is a polygon, whose segments are all"
+             " parametrised linearly.\n\n"
+             "Dispersive integrals along such curves are computed in closed"
+             " form.");
 
     py::class_<Piecewise, Curve> piecewise(m, "Piecewise",
                                            "a piecewise linear path in the"
@@ -155,6 +383,78 @@ PYBIND11_MODULE(_khuri_khuri_treiman, m) {
         .value("iteration", Method::iteration)
         .value("inverse", Method::inverse);
 
+    py::enum_<Reconstruction>(m, "Reconstruction",
+                              "The different available reconstructions of"
+                              " the integrands of basis functions.")
+        .value("linear", Reconstruction::linear)
+        .value("barycentric", Reconstruction::barycentric);
+
+    py::class_<Real_table>(m, "RealTable",
+                           "Functions tabulated along an interval of the real"
+                           " axis, interpolated by natural cubic splines.")
+        .def(py::init<const std::vector<double>&,
+                      const kernel::Matrix&>(),
+             "Restore a table from the output of `points` and `values`.",
+             py::arg("points"),
+             py::arg("values"))
+        .def("__call__", py::vectorize(&Real_table::operator()),
+             "Interpolate function `i` at `s`.",
+             py::arg("i"),
+             py::arg("s"))
+        .def("evaluate_all", &Real_table::evaluate_all,
+             "Interpolate all functions at `s`.",
+             py::arg("s"))
+        .def("contains", &Real_table::contains,
+             py::arg("s"))
+        .def("front", &Real_table::front)
+        .def("back", &Real_table::back)
+        .def("size", &Real_table::size,
+             "Return the number of functions.")
+        .def("points", &Real_table::points,
+             "Return the knots in ascending order, the break points between"
+             " neighbouring parts appear twice.")
+        .def("values", &Real_table::values,
+             "Return the tabulated values, column k contains the functions at"
+             " `points()[k]`.")
+        .def("error", &Real_table::error,
+             "Return the largest relative deviation from the tabulated"
+             " functions found while the knots were placed.");
+
+    py::enum_<Quadrature>(m, "Quadrature",
+                          "The available quadrature rules.")
+        .value("gauss_legendre", Quadrature::gauss_legendre)
+        .value("fejer", Quadrature::fejer)
+        .value("gauss_jacobi", Quadrature::gauss_jacobi)
+        .value("graded", Quadrature::graded)
+        .value("clenshaw_curtis", Quadrature::clenshaw_curtis);
+
+    py::class_<Rule>(m, "Rule",
+                     "A quadrature rule together with its parameters. The"
+                     " weights always refer to the plain integral, such that"
+                     " all rules can be used interchangeably.")
+        .def(py::init<Quadrature>(),
+             py::arg("quadrature")=Quadrature::gauss_legendre)
+        .def_static("gauss_jacobi", &Rule::gauss_jacobi,
+                    "Return the Gauss-Jacobi rule for integrands behaving like"
+                    " (x-start)^start_exponent (end-x)^end_exponent times a"
+                    " smooth function.",
+                    py::arg("start_exponent"),
+                    py::arg("end_exponent")=0.0)
+        .def_static("graded", &Rule::graded,
+                    "Return the composite Gauss-Legendre rule on levels+1"
+                    " intervals, whose lengths decrease by ratio towards the"
+                    " start (or the end) of the interval.",
+                    py::arg("levels"),
+                    py::arg("ratio")=0.15,
+                    py::arg("at_start")=true)
+        .def("quadrature", &Rule::quadrature)
+        .def("knots", &Rule::knots,
+             "Return (point, weight) pairs for integration in [start, end].",
+             py::arg("start"),
+             py::arg("end"),
+             py::arg("points"));
+    py::implicitly_convertible<Quadrature, Rule>();
+
     py::class_<khuri_treiman::Real, Piecewise>(m, "Real",
                                             "linear curve along the real axis")
         .def(py::init<double, double>());
@@ -171,6 +471,82 @@ PYBIND11_MODULE(_khuri_khuri_treiman, m) {
                                             " and arbitrary pion masses")
         .def(py::init<double, double, double>());
 
+    py::class_<khuri_treiman::Traced, Piecewise>(m, "Traced",
+                                            "the shortest polygon with a given"
+                                            " number of sides that leads"
+                                            " around the singular region,"
+                                            " followed by the real axis; it"
+                                            " requires virtualities above"
+                                            " 9 pion masses squared, such"
+                                            " that the singular region lies"
+                                            " to the right of the threshold,"
+                                            " and raises ValueError"
+                                            " otherwise")
+        .def(py::init<double, double, double, std::size_t, double>(),
+             py::arg("pion_mass"),
+             py::arg("virtuality"),
+             py::arg("cut"),
+             py::arg("sides")=3,
+             py::arg("margin")=1.0);
+
+    py::class_<Path, Curve> path(m, "Path",
+                                 "a smooth path in the complex plane glued"
+                                 " together from straight lines, elliptic"
+                                 " arcs and cubic Bezier curves");
+    path
+        .def(py::init<std::vector<Path::Piece>>())
+        .def("lower", &Path::lower,
+             "Return the parameter value corresponding to the start of the"
+             " path.")
+        .def("upper", &Path::upper,
+             "Return the parameter value corresponding to the end of the"
+             " path.")
+        .def("piece_index", py::vectorize(&Path::piece_index),
+                "Return the number of the piece corresponding to the"
+                " parameter value `x`.",
+             py::arg("x"));
+
+    py::class_<Path::Piece>(path, "Piece",
+                            "A single piece of a path, parametrised by u in"
+                            " [0,1].")
+        .def_static("line", &Path::Piece::line,
+                    py::arg("start"),
+                    py::arg("end"))
+        .def_static("arc", &Path::Piece::arc,
+                    "Return the circular arc around `center`, which runs"
+                    " counter-clockwise if end_angle > start_angle.",
+                    py::arg("center"),
+                    py::arg("radius"),
+                    py::arg("start_angle"),
+                    py::arg("end_angle"))
+        .def_static("elliptic_arc", &Path::Piece::elliptic_arc,
+                    "Return the arc center + a cos(phi) + i b sin(phi), where"
+                    " phi runs from `start_angle` to `end_angle`.",
+                    py::arg("center"),
+                    py::arg("real_semi_axis"),
+                    py::arg("imaginary_semi_axis"),
+                    py::arg("start_angle"),
+                    py::arg("end_angle"))
+        .def_static("bezier", &Path::Piece::bezier,
+                    "Return the cubic Bezier curve with the given control"
+                    " points.",
+                    py::arg("start"),
+                    py::arg("first_control"),
+                    py::arg("second_control"),
+                    py::arg("end"))
+        .def("value", &Path::Piece::value, py::arg("u"))
+        .def("derivative", &Path::Piece::derivative, py::arg("u"))
+        .def("locate", &Path::Piece::locate,
+             "Return the parameter u at which the piece passes through `s`,"
+             " or None.",
+             py::arg("s"));
+
+    py::class_<khuri_treiman::Smooth_adaptive, Path>(m, "SmoothAdaptive",
+                                            "same as Adaptive, but the"
+                                            " critical region is avoided by a"
+                                            " half ellipse")
+        .def(py::init<double, double, double>());
+
     py::class_<Point>(m, "Point",
                       "A point in the (x,z)-plane.")
         .def(py::init<Complex,double,Complex,double,double>())
@@ -184,4 +560,6 @@ PYBIND11_MODULE(_khuri_khuri_treiman, m) {
     create_bindings<khuri_treiman::Real>(m, "Real");
     create_bindings<khuri_treiman::Vector_decay>(m, "VectorDecay");
     create_bindings<khuri_treiman::Adaptive>(m, "Adaptive");
+    create_bindings<khuri_treiman::Traced>(m, "Traced");
+    create_bindings<khuri_treiman::Smooth_adaptive>(m, "SmoothAdaptive");
 }
@@ -1,8 +1,10 @@
 #include "mandelstam.h"
+#include "singularity.h"
 
 #include "pybind11/pybind11.h"
 #include "pybind11/complex.h"
 #include "pybind11/numpy.h"
+#include "pybind11/stl.h"
 
 namespace py = pybind11;
 
@@ -23,4 +25,20 @@ PYBIND11_MODULE(_khuri_mandelstam, m) {
         py::arg("cosine"),
         py::arg("mass"),
         py::arg("virtuality"));
+
+    m.def("singularity_curve", &singularity::singularity_curve,
+        "Return the values of the singularity curve `number` as parametrized"
+        " by the squared cosine of the scattering angle in [eps, 1-eps].",
+        py::arg("decay_mass_2"),
+        py::arg("mass_2"),
+        py::arg("number"),
+        py::arg("points")=200,
+        py::arg("eps")=1e-6);
+
+    m.def("lower_curve", &singularity::lower_curve,
+        "Return the boundary of the singular region in the lower half plane,"
+        " from (decay_mass_2-mass_2)/2 to decay_mass_2-5 mass_2.",
+        py::arg("decay_mass_2"),
+        py::arg("mass_2"),
+        py::arg("points")=200);
 }
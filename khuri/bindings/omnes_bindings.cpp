@@ -1,12 +1,17 @@
 #include "omnes.h"
 #include "gsl_interface.h"
+#include "vectorized.h"
 
 #include "pybind11/pybind11.h"
 #include "pybind11/complex.h"
 #include "pybind11/numpy.h"
 #include "pybind11/functional.h"
 
+#include <stdexcept>
+#include <vector>
+
 namespace py = pybind11;
+using bindings::vectorized;
 using omnes::Omnes;
 using gsl::Function;
 using gsl::Settings;
@@ -14,6 +19,10 @@ using gsl::Settings;
 template<typename T>
 void create_binding(py::module& m, const std::string& name)
 {
+    const char* vectorized_docstring =
+        "Same as the constructor, but `phase` is called with a NumPy array of"
+        " abscissae (e.g. all points of a quadrature rule) and needs to return"
+        " an array of the same size.";
     py::class_<Omnes<T>>(m, name.c_str())
         .def(py::init<const Function&, double, double, Settings>(),
              py::arg("phase"),
@@ -28,6 +37,33 @@ void create_binding(py::module& m, const std::string& name)
              py::arg("cut"),
              py::arg("minimal_distance") = 1e-10,
              py::arg("config") = Settings{})
+        .def_static("vectorized",
+             [](py::function phase, double threshold, double minimal_distance,
+                Settings config)
+             {
+                 return Omnes<T>{vectorized<double>(std::move(phase)),
+                                 threshold, minimal_distance, config};
+             },
+             vectorized_docstring,
+             py::arg("phase"),
+             py::arg("threshold"),
+             py::arg("minimal_distance") = 1e-10,
+             py::arg("config") = Settings{})
+        .def_static("vectorized",
+             [](py::function phase, double threshold, double constant,
+                double cut, double minimal_distance, Settings config)
+             {
+                 return Omnes<T>{vectorized<double>(std::move(phase)),
+                                 threshold, constant, cut, minimal_distance,
+                                 config};
+             },
+             vectorized_docstring,
+             py::arg("phase"),
+             py::arg("threshold"),
+             py::arg("constant"),
+             py::arg("cut"),
+             py::arg("minimal_distance") = 1e-10,
+             py::arg("config") = Settings{})
         .def("__call__", py::vectorize(&Omnes<T>::operator()),
                 py::arg("s"));
 }
@@ -57,7 +93,13 @@ PYBIND11_MODULE(_khuri_omnes, m) {
 
     create_binding<gsl::Cquad>(m, "OmnesCquad");
     create_binding<gsl::Qag>(m, "OmnesQag");
+    create_binding<gsl::Tanh_sinh>(m, "OmnesTanhSinh");
+    create_binding<gsl::Gauss_Jacobi>(m, "OmnesGaussJacobi");
+    create_binding<gsl::Warm_start>(m, "OmnesWarmStart");
 
     second_sheet_binding<gsl::Cquad>(m, "second_sheet_cquad");
     second_sheet_binding<gsl::Qag>(m, "second_sheet_qag");
+    second_sheet_binding<gsl::Tanh_sinh>(m, "second_sheet_tanh_sinh");
+    second_sheet_binding<gsl::Gauss_Jacobi>(m, "second_sheet_gauss_jacobi");
+    second_sheet_binding<gsl::Warm_start>(m, "second_sheet_warm_start");
 }
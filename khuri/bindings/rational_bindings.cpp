@@ -0,0 +1,78 @@
+#include "rational.h"
+
+#include "pybind11/pybind11.h"
+#include "pybind11/complex.h"
+#include "pybind11/eigen.h"
+#include "pybind11/numpy.h"
+#include "pybind11/stl.h"
+
+#include <vector>
+
+namespace py = pybind11;
+
+using rational::Complex;
+using rational::Matrix;
+using rational::Rational;
+
+PYBIND11_MODULE(_khuri_rational, m) {
+    m.doc() = "Rational approximations in barycentric form via the AAA"
+              " algorithm.";
+
+    py::class_<Rational>(m, "Rational",
+                         "Rational functions in barycentric form with common"
+                         " support points and weights.")
+        .def(py::init<std::vector<Complex>, std::vector<Complex>, Matrix,
+                      double>(),
+             "Restore rational functions from the output of"
+             " `support_points`, `weights`, `values` and `error`.",
+             py::arg("support_points"),
+             py::arg("weights"),
+             py::arg("values"),
+             py::arg("error")=0.0)
+        .def("__call__", py::vectorize(&Rational::operator()),
+             "Evaluate function `i` at `s`.",
+             py::arg("i"),
+             py::arg("s"))
+        .def("evaluate_all", &Rational::evaluate_all,
+             "Evaluate all functions at `s`.",
+             py::arg("s"))
+        .def("poles", &Rational::poles,
+             "Return the poles shared by all functions.")
+        .def("size", &Rational::size,
+             "Return the number of functions.")
+        .def("degree", &Rational::degree,
+             "Return the degree of the numerators and the denominator.")
+        .def("support_points", &Rational::support_points)
+        .def("weights", &Rational::weights)
+        .def("values", &Rational::values,
+             "Return the values, column j contains the functions at"
+             " `support_points()[j]`.")
+        .def("error", &Rational::error,
+             "Return the largest deviation from the approximated functions at"
+             " their samples, relative to the largest modulus of the"
+             " respective function.");
+
+    m.def("aaa",
+          py::overload_cast<const std::vector<Complex>&,
+                            const std::vector<Complex>&,
+                            double,
+                            std::size_t>(&rational::aaa),
+          "Approximate the function with values `f` at `z` by a rational"
+          " function via the AAA algorithm.",
+          py::arg("z"),
+          py::arg("f"),
+          py::arg("tolerance")=1e-12,
+          py::arg("max_support")=100);
+    m.def("aaa",
+          py::overload_cast<const std::vector<Complex>&,
+                            const Matrix&,
+                            double,
+                            std::size_t>(&rational::aaa),
+          "Approximate the functions sampled at `z` by rational functions"
+          " with common support points and weights. Row i of `f` contains"
+          " function i at `z`.",
+          py::arg("z"),
+          py::arg("f"),
+          py::arg("tolerance")=1e-12,
+          py::arg("max_support")=100);
+}
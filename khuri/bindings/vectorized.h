@@ -0,0 +1,33 @@
+#ifndef VECTORIZED_HEADER_GUARD
+#define VECTORIZED_HEADER_GUARD
+
+#include "pybind11/pybind11.h"
+#include "pybind11/complex.h"
+#include "pybind11/numpy.h"
+
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+/// Helpers shared by the bindings of several modules.
+namespace bindings {
+namespace py = pybind11;
+
+template<typename T>
+std::function<std::vector<T>(const std::vector<T>&)> vectorized(
+        py::function f)
+    /// Call `f` with NumPy arrays of arguments instead of single values.
+{
+    return [f = std::move(f)](const std::vector<T>& x)
+    {
+        using Array = py::array_t<T,
+                                  py::array::c_style | py::array::forcecast>;
+        const Array values{f(Array(x.size(), x.data()))};
+        if (static_cast<std::size_t>(values.size()) != x.size())
+            throw std::invalid_argument{
+                "vectorized function returned the wrong number of values"};
+        return std::vector<T>(values.data(), values.data() + values.size());
+    };
+}
+} // bindings
+#endif // VECTORIZED_HEADER_GUARD
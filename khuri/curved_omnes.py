@@ -1,17 +1,22 @@
 from _khuri_curved_omnes import *
 from _khuri_curved_omnes import __doc__ as module_docstring
 
-from khuri.khuri_treiman import Adaptive, VectorDecay, Real
+from khuri.khuri_treiman import (Adaptive, VectorDecay, Real, SmoothAdaptive,
+                                 Traced)
 
 
 __doc__ = module_docstring
 
 
 class CurvedOmnes:
-    def __init__(self, omnes_function, amplitude, curve):
-        args = omnes_function, amplitude, curve
+    def __init__(self, omnes_function, amplitude, curve, samples=64):
+        args = omnes_function, amplitude, curve, samples
         if isinstance(curve, Adaptive):
             self.func = make_curved_adaptive(*args)
+        elif isinstance(curve, SmoothAdaptive):
+            self.func = make_curved_smooth_adaptive(*args)
+        elif isinstance(curve, Traced):
+            self.func = make_curved_traced(*args)
         elif isinstance(curve, VectorDecay):
             self.func = make_curved_vector_decay(*args)
         elif isinstance(curve, Real):
@@ -13,6 +13,19 @@ class IntegrationRoutine(Enum):
     `cquad` is more potent in solving slowly converging or otherwise hard
     integrals, while `qag` uses less resources, but is also much less reliable.
     In general, `cquad` is strongly preferred.
+
+    `tanh_sinh` (double-exponential quadrature) and `gauss_jacobi` are suited
+    for integrands with algebraic behaviour at the endpoints, e.g. square roots
+    at a threshold. `gauss_jacobi` absorbs the endpoint behaviour specified via
+    `lower_exponent` and `upper_exponent` of `Settings` into its weight
+    function.
+
+    `warm_start` remembers the subdivision of the previous integral and starts
+    from it, which is advantageous for scans along nearby arguments. Such
+    instances must not be shared between threads.
     """
     cquad = 1
     qag = 2
+    tanh_sinh = 3
+    gauss_jacobi = 4
+    warm_start = 5
@@ -1,3 +1,4 @@
+from khuri.rational import Rational
 from _khuri_khuri_treiman import *
 from _khuri_khuri_treiman import __doc__ as module_docstring
 
@@ -8,18 +8,32 @@ from _khuri_omnes import __doc__ as module_docstring
 __doc__ = module_docstring
 
 
+# The routines that evaluate the integrand at single abscissae only.
+_SCALAR_ROUTINES = (IntegrationRoutine.cquad, IntegrationRoutine.qag)
+
+
 def _factory(func):
-    callable1, callable2 = func()
+    callables = func()
 
     @functools.wraps(func)
     def wrapper(*args,
-                integration_routine=IntegrationRoutine.cquad,
+                integration_routine=None,
+                vectorized=False,
                 **kwargs):
-        if integration_routine == IntegrationRoutine.cquad:
-            return callable1(*args, **kwargs)
-        if integration_routine == IntegrationRoutine.qag:
-            return callable2(*args, **kwargs)
-        raise ValueError('unknown integration routine')
+        if integration_routine is None:
+            integration_routine = (IntegrationRoutine.warm_start if vectorized
+                                   else IntegrationRoutine.cquad)
+        elif vectorized and integration_routine in _SCALAR_ROUTINES:
+            raise ValueError('a vectorized phase requires an integration'
+                             ' routine that evaluates several abscissae at'
+                             ' once')
+        try:
+            omnes_type = callables[integration_routine]
+        except KeyError:
+            raise ValueError('unknown integration routine') from None
+        if vectorized:
+            return omnes_type.vectorized(*args, **kwargs)
+        return omnes_type(*args, **kwargs)
 
     return wrapper
 
@@ -47,18 +61,37 @@ def generate_omnes():
         the settings for the integration routine
     integration_routine: IntegrationRoutine, optional
         specify an adaptive integration routine to be used to compute the
-        integral
+        integral, by default cquad or, if `vectorized` is true, warm_start
+    vectorized: bool, optional
+        if true, `phase` is called with a NumPy array of abscissae (e.g. all
+        points of a quadrature rule) and needs to return an array of the same
+        size. This is not supported by cquad and qag, which evaluate the
+        phase at single abscissae.
 
     Returns
     -------
     A callable that yields the values of the requested Omnes function.
     """
-    return OmnesCquad, OmnesQag
+    return {
+        IntegrationRoutine.cquad: OmnesCquad,
+        IntegrationRoutine.qag: OmnesQag,
+        IntegrationRoutine.tanh_sinh: OmnesTanhSinh,
+        IntegrationRoutine.gauss_jacobi: OmnesGaussJacobi,
+        IntegrationRoutine.warm_start: OmnesWarmStart,
+    }
+
+
+_SECOND_SHEETS = (
+    (OmnesCquad, second_sheet_cquad),
+    (OmnesQag, second_sheet_qag),
+    (OmnesTanhSinh, second_sheet_tanh_sinh),
+    (OmnesGaussJacobi, second_sheet_gauss_jacobi),
+    (OmnesWarmStart, second_sheet_warm_start),
+)
 
 
 def second_sheet(omnes_function, amplitude, mandelstam_s):
-    if isinstance(omnes_function, OmnesCquad):
-        return second_sheet_cquad(omnes_function, amplitude, mandelstam_s)
-    if isinstance(omnes_function, OmnesQag):
-        return second_sheet_qag(omnes_function, amplitude, mandelstam_s)
+    for omnes_type, function in _SECOND_SHEETS:
+        if isinstance(omnes_function, omnes_type):
+            return function(omnes_function, amplitude, mandelstam_s)
     raise ValueError('unknown type of omnes function')
@@ -0,0 +1,5 @@
+from _khuri_rational import *
+from _khuri_rational import __doc__ as module_docstring
+
+
+__doc__ = module_docstring
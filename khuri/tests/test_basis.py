@@ -1,7 +1,7 @@
 import numpy as np
 import pytest
 
-from khuri import madrid_global, phases, omnes
+from khuri import madrid_global, mandelstam, phases, omnes
 import khuri.khuri_treiman as kt
 
 
@@ -51,3 +51,155 @@ def test_basis(omnes_function, grid):
 
     with pytest.raises(IndexError):
         basis(1, 10.0)
+
+
+def test_vectorized_basis(omnes_function, grid):
+    """Test if a vectorized amplitude yields the same basis."""
+    arguments = (omnes_function, amplitude, 1, grid, 1.0, 0.0)
+    basis = kt.BasisReal(*arguments)
+    vectorized = kt.BasisReal.vectorized(*arguments)
+    mandelstam_s = np.array([2.0 - 10.0j, 10.0, 50.0 + 1.0j])
+    assert np.allclose(vectorized(0, mandelstam_s), basis(0, mandelstam_s))
+
+
+def test_evaluate_all(omnes_function, grid):
+    """Test if all basis functions at once agree with the single ones."""
+    subtractions = 2
+    basis = kt.BasisReal(omnes_function, amplitude, subtractions, grid, 1.0,
+                         0.0)
+    mandelstam_s = np.array([2.0 - 10.0j, 10.0, 4.0, 50.0 + 1.0j])
+    values = basis.evaluate_all(mandelstam_s)
+    assert values.shape == (subtractions, len(mandelstam_s))
+    for i in range(subtractions):
+        assert np.allclose(values[i], basis(i, mandelstam_s),
+                           rtol=1e-14, atol=0.0)
+    assert np.allclose(basis.evaluate_all(10.0), values[:, 1],
+                       rtol=1e-14, atol=0.0)
+
+
+def test_barycentric_reconstruction(omnes_function, curve):
+    """Test if both reconstructions of the integrands roughly agree."""
+    grid = kt.GridReal(curve, (20,), 5)
+    arguments = (omnes_function, amplitude, 1, grid, 1.0, 0.0)
+    linear = kt.BasisReal(*arguments)
+    barycentric = kt.BasisReal(
+        *arguments, reconstruction=kt.Reconstruction.barycentric)
+    mandelstam_s = np.array([2.0 - 10.0j, 10.0, 50.0 + 1.0j])
+    assert np.allclose(barycentric(0, mandelstam_s), linear(0, mandelstam_s),
+                       rtol=1e-2)
+
+
+def test_adaptive_grid(omnes_function, curve):
+    """Test if the adaptive grid refines the initial panel."""
+    order = 8
+    grid = kt.adaptive_grid(omnes_function, amplitude, 1, curve, 1.0, 0.0,
+                            z_size=2, tolerance=1e-4, order=order)
+    panels = grid.panel_boundaries()
+    assert panels[0] == 0.0 and panels[-1] == 1.0
+    assert len(panels) > 2
+    assert grid.x_size() == order * (len(panels) - 1)
+    basis = kt.BasisReal(omnes_function, amplitude, 1, grid, 1.0, 0.0)
+    assert isinstance(basis(0, 10.0), complex)
+
+
+def test_tabulate(omnes_function, grid):
+    """Test if the tabulated basis functions agree with the direct ones."""
+    subtractions = 2
+    basis = kt.BasisReal(omnes_function, amplitude, subtractions, grid, 1.0,
+                         0.0)
+    assert basis.table() is None
+    mandelstam_s = np.linspace(-5.0, 90.0, 37)
+    expected = basis.evaluate_all(mandelstam_s)
+    off_axis = basis.evaluate_all(50.0 + 1.0j)
+
+    basis.tabulate(-10.0, 95.0, tolerance=1e-8)
+    table = basis.table()
+    assert table.size() == subtractions
+    values = basis.evaluate_all(mandelstam_s)
+    scale = np.max(np.abs(expected), axis=1)[:, np.newaxis]
+    assert np.all(np.abs(values - expected) < 1e-6 * scale)
+    assert np.array_equal(basis.evaluate_all(50.0 + 1.0j), off_axis)
+
+    restored = kt.RealTable(table.points(), table.values())
+    assert np.array_equal(restored(1, mandelstam_s), table(1, mandelstam_s))
+
+
+def test_compress(omnes_function, grid):
+    """Test if the rational approximation agrees with the basis functions."""
+    subtractions = 2
+    basis = kt.BasisReal(omnes_function, amplitude, subtractions, grid, 1.0,
+                         0.0)
+    samples = -10.0 + 8.0 * np.exp(2j * np.pi * np.arange(64) / 64)
+    compressed = basis.compress(samples, tolerance=1e-10)
+    assert isinstance(compressed, kt.Rational)
+    assert compressed.size() == subtractions
+    assert compressed.error() < 1e-9
+    assert compressed.degree() < 30
+
+    mandelstam_s = np.array([-10.0, -8.0 + 3.0j, -15.0 - 2.0j, -4.0 + 0.5j])
+    expected = basis.evaluate_all(mandelstam_s)
+    scale = np.max(np.abs(expected), axis=1)[:, np.newaxis]
+    values = np.array([compressed(i, mandelstam_s)
+                       for i in range(subtractions)])
+    assert np.all(np.abs(values - expected) < 1e-8 * scale)
+
+
+def test_inhomogeneities(omnes_function, curve):
+    """Test if the angular averages agree with those via single calls."""
+    subtractions = 2
+    z_size = 6
+    grid = kt.GridReal(curve, (5,), z_size)
+    basis = kt.BasisReal(omnes_function, amplitude, subtractions, grid, 1.0,
+                         0.0)
+    mandelstam_s = np.array([-3.0, 2.0 + 1.0j, 10.0, 50.0 - 2.0j])
+    values = basis.inhomogeneities(mandelstam_s)
+    assert values.shape == (subtractions, len(mandelstam_s))
+    assert np.allclose(basis.inhomogeneities(10.0), values[:, 2],
+                       rtol=1e-14, atol=0.0)
+
+    z, weights = np.polynomial.legendre.leggauss(z_size)
+    t = mandelstam.t_vector_decay(mandelstam_s[:, np.newaxis], z, 1.0, 0.0)
+    for i in range(subtractions):
+        expected = 1.5 * np.sum(weights * (1.0 - z**2) * basis(i, t), axis=1)
+        assert np.allclose(values[i], expected, rtol=1e-12, atol=0.0)
+
+
+def test_refinement_error(omnes_function, curve):
+    """Test the error estimate via the refined grid."""
+    grid = kt.GridReal(curve, (3,), (3,), rule=kt.Quadrature.fejer)
+    error = kt.refinement_error(omnes_function, amplitude, 2, grid, 1.0, 0.0)
+    assert 0.0 < error < 1.0
+    with pytest.raises(RuntimeError):
+        kt.refinement_error(omnes_function, amplitude, 2,
+                            kt.GridReal(curve, (3,), 3), 1.0, 0.0)
+
+
+def test_real_kernel():
+    """Test the real kernel against the complex iteration.
+
+    With the phase of the Omnes function, the amplitude yields a real kernel
+    for scattering kinematics, which is used in the matrix inversion. The
+    tolerance reflects the accuracy of the iteration, the real kernel itself
+    is compared to the complex one in test_kernel.cpp.
+    """
+    def elastic_phase(s):
+        if s <= 4.0:
+            return 0.0
+        return np.arctan2(3.0 * (s / 4.0 - 1.0)**1.5 / np.sqrt(s), 30.0 - s)
+
+    def elastic_amplitude(s):
+        sigma = np.sqrt(1.0 - 4.0 / s)
+        return 3.0 * s * sigma**2 / 8.0 / (
+            30.0 - s - 3.0j * s * sigma**3 / 8.0)
+
+    omnes_function = omnes.generate_omnes(elastic_phase, threshold=4.0,
+                                          constant=np.pi, cut=1e10)
+    grid = kt.GridReal(kt.Real(4.0, 100.0), (10,), 4)
+    arguments = (omnes_function, elastic_amplitude, 2, grid, 1.0, 0.0)
+    inverse = kt.BasisReal(*arguments, method=kt.Method.inverse)
+    iteration = kt.BasisReal(*arguments, method=kt.Method.iteration,
+                             accuracy=1e-12)
+    mandelstam_s = np.array([-5.0, 2.0, 10.0 + 1.0j, 50.0])
+    assert np.allclose(inverse.evaluate_all(mandelstam_s),
+                       iteration.evaluate_all(mandelstam_s),
+                       rtol=1e-6, atol=0.0)
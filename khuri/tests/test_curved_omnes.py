@@ -1,9 +1,10 @@
 import numpy as np
 import pytest
 
-from khuri.curved_omnes import CurvedOmnes
+from khuri.curved_omnes import CurvedOmnes, Region
 from khuri.iam import nlo
-from khuri.khuri_treiman import Adaptive, Real, VectorDecay
+from khuri.khuri_treiman import (Adaptive, Real, SmoothAdaptive, Traced,
+                                 VectorDecay)
 from khuri.omnes import generate_omnes, second_sheet
 
 
@@ -42,3 +43,50 @@ def test_rectangle(curve):
     mandelstam_s_2nd_sheet = [5.0 - 1.0j, 8.0 - 1e-2j]
     assert np.all(curved(mandelstam_s_2nd_sheet)
                   == second_sheet(omn, amplitude, mandelstam_s_2nd_sheet))
+
+
+@pytest.mark.parametrize('curve,inside,outside', [
+    (Adaptive, [5.0 - 1.0j, 20.0 - 7.0j, 4.5 - 5.0j],
+     [35.0 - 2.0j, 27.0 - 1.0j]),
+    (SmoothAdaptive, [5.0 - 1.0j, 10.0 - 8.0j, 27.0 - 1.0j], [4.5 - 5.0j]),
+    (Traced, [20.0 - 7.0j, 35.0 - 2.0j, 41.0 - 0.1j], [40.0 - 2.0j]),
+    # the first edge runs from 4 to 5 - 7i, points to its left were on the
+    # second sheet in the rectangle [4, 27.5] x [-7, 0] used before
+    (VectorDecay, [4.5 - 1.0j, 5.0 - 6.5j, 27.0 - 1.0j],
+     [4.1 - 3.0j, 4.5 - 6.5j, 28.0 - 1.0j]),
+], ids=('Adaptive', 'SmoothAdaptive', 'Traced', 'VectorDecay'))
+def test_region(curve, inside, outside):
+    region = Region(curve(1.0, 30.0, 1e5))
+    outside = outside + [10.0, 10.0 + 10.0j, 10.0 - 1e2j, 30.0 - 9.0j]
+    assert all(region.contains(inside))
+    assert not any(region.contains(outside))
+
+
+@pytest.mark.parametrize('curve', (SmoothAdaptive, Traced),
+                         ids=('SmoothAdaptive', 'Traced'))
+def test_curved(curve):
+    curved = make_curved(curve(1.0, 30.0, 1e5))
+    omn = curved.original()
+
+    mandelstam_s_1st_sheet = [-10.0, 10.0, 40.0 - 2.0j, 10.0 - 1e2j]
+    assert np.all(curved(mandelstam_s_1st_sheet)
+                  == omn(mandelstam_s_1st_sheet))
+
+    mandelstam_s_2nd_sheet = [5.0 - 1.0j, 27.0 - 1.0j]
+    assert np.all(curved(mandelstam_s_2nd_sheet)
+                  == second_sheet(omn, amplitude, mandelstam_s_2nd_sheet))
+
+
+@pytest.mark.parametrize('samples', (4, 64))
+def test_region_near_curve(samples):
+    curve = SmoothAdaptive(1.0, 30.0, 1e5)
+    start, end = curve.boundaries()[:2]
+    parameters = np.linspace(start, end, 51)[1:-1]
+    points = curve.curve_func(parameters)
+    derivatives = curve.derivative_func(parameters)
+    # The curve runs from the threshold into the lower half plane and back,
+    # so the region is to its left
+    normal = 1e-6 * np.abs(points) * 1j * derivatives / np.abs(derivatives)
+    region = Region(curve, samples)
+    assert all(region.contains(points + normal))
+    assert not any(region.contains(points - normal))
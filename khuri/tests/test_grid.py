@@ -1,6 +1,6 @@
 import pytest
 
-from khuri.khuri_treiman import Real, GridReal
+from khuri.khuri_treiman import Real, GridReal, Quadrature, Rule
 
 X_SIZE = 20
 Z_SIZE = 5
@@ -30,6 +30,99 @@ def test_z_size(real_grid):
     assert real_grid.z_size() == Z_SIZE
 
 
+def test_panels(real_grid):
+    assert real_grid.panel_boundaries() == pytest.approx([0.0, 1.0])
+    assert real_grid.panel_sizes() == [X_SIZE]
+
+
+def test_refined_panels():
+    curve = Real(4.0, 50.0)
+    grid = GridReal(curve, [0.0, 0.25, 1.0], [4, 6], Z_SIZE)
+    assert grid.x_size() == 10
+    assert grid.panel_boundaries() == pytest.approx([0.0, 0.25, 1.0])
+    parameters = grid.x_parameter_values()
+    assert all(0.0 < p < 0.25 for p in parameters[:4])
+    assert all(0.25 < p < 1.0 for p in parameters[4:])
+    with pytest.raises(ValueError):
+        GridReal(curve, [0.0, 0.5], [4], Z_SIZE)
+
+
 def test_x_parameter(real_grid):
     assert real_grid.x_parameter_lower() == pytest.approx(0.0)
     assert real_grid.x_parameter_upper() == pytest.approx(1.0)
+
+
+def test_z_sizes():
+    curve = Real(4.0, 50.0)
+    grid = GridReal(curve, [0.0, 0.25, 1.0], [4, 6], [3, 5])
+    assert not grid.is_z_uniform()
+    assert grid.panel_z_sizes() == [3, 5]
+    assert grid.size() == 4 * 3 + 6 * 5
+    assert grid.z_size(0) == 3
+    assert grid.z_size(4) == 5
+    assert grid.index(4, 2) == 4 * 3 + 2
+    assert grid(5, 4).z == grid.z(5, 4)
+    with pytest.raises(RuntimeError):
+        grid.z_size()
+    with pytest.raises(ValueError):
+        GridReal(curve, [0.0, 0.25, 1.0], [4, 6], [3])
+
+
+def test_refined():
+    curve = Real(4.0, 50.0)
+    grid = GridReal(curve, [0.0, 0.25, 1.0], [3, 7], [3, 1],
+                    rule=Quadrature.fejer)
+    refined = grid.refined()
+    assert refined.panel_sizes() == [7, 15]
+    assert refined.panel_z_sizes() == [7, 3]
+    for x_index in range(grid.x_size()):
+        refined_x = grid.refined_x_index(x_index)
+        assert refined.x(refined_x) == pytest.approx(grid.x(x_index))
+        for z_index in range(grid.z_size(x_index)):
+            refined_z = GridReal.refined_z_index(z_index)
+            assert (refined.z(refined_x, refined_z)
+                    == pytest.approx(grid.z(x_index, z_index)))
+    with pytest.raises(RuntimeError):
+        GridReal(curve, [3], 3).refined()
+
+
+@pytest.mark.parametrize('rule', [
+    Rule(),
+    Rule(Quadrature.fejer),
+    Rule(Quadrature.clenshaw_curtis),
+    Rule.gauss_jacobi(0.5),
+    Rule.graded(3, 0.2),
+    Rule.graded(3, 0.2, at_start=False),
+])
+def test_rules(rule):
+    knots = rule.knots(1.0, 3.0, 12)
+    points = [p for p, _ in knots]
+    assert points == sorted(points)
+    integral = sum(w * (p - 1.0)**0.5 * p for p, w in knots)
+    # (3 - 1)^(3/2) (2/5 * 2 + 2/3)
+    exact = 2.0**1.5 * (0.8 + 2.0 / 3.0)
+    assert integral == pytest.approx(exact, rel=1e-2)
+
+
+def test_gauss_jacobi_threshold():
+    knots = Rule.gauss_jacobi(0.5).knots(1.0, 3.0, 6)
+    integral = sum(w * (p - 1.0)**0.5 * p**3 for p, w in knots)
+    # substitute p = 1 + u
+    exact = sum(c * 2.0**(k + 1.5) / (k + 1.5)
+                for k, c in enumerate([1.0, 3.0, 3.0, 1.0]))
+    assert integral == pytest.approx(exact, rel=1e-12)
+
+
+def test_panel_rules():
+    curve = Real(4.0, 50.0)
+    rules = [Rule.gauss_jacobi(0.5), Rule()]
+    grid = GridReal(curve, [0.0, 0.25, 1.0], [4, 6], [3, 5], rules)
+    assert [r.quadrature() for r in grid.panel_rules()] == [
+        Quadrature.gauss_jacobi, Quadrature.gauss_legendre]
+    assert not grid.uses(Quadrature.gauss_legendre)
+    parameters = grid.x_parameter_values()
+    integral = sum(grid(j, 0).x_weight * parameters[j]**0.5
+                   for j in range(4))
+    assert integral == pytest.approx(2.0 / 3.0 * 0.25**1.5)
+    with pytest.raises(ValueError):
+        GridReal(curve, [0.0, 0.25, 1.0], [4, 6], [3, 5], rules[:1])
@@ -100,3 +100,46 @@ def test_schwarz(function):
     imaginary_parts = np.linspace(-1e4, 1e4, 20)
     mandelstam_s = real_part + 1j * imaginary_parts
     schwarz(function, mandelstam_s)
+
+
+@pytest.mark.parametrize('routine', [IntegrationRoutine.tanh_sinh,
+                                     IntegrationRoutine.gauss_jacobi,
+                                     IntegrationRoutine.warm_start])
+def test_alternative_routines(routine):
+    """Check the alternative routines against the adaptive default."""
+    reference = generate_omnes(PHASES[0], threshold=THRESHOLD)
+    omnes = generate_omnes(PHASES[0], threshold=THRESHOLD,
+                           integration_routine=routine)
+    mandelstam_s = np.linspace(-1.0, THRESHOLD - 0.01, 20)
+    assert np.allclose(omnes(mandelstam_s), reference(mandelstam_s))
+    assert np.allclose(second_sheet(omnes, amplitude, mandelstam_s),
+                       second_sheet(reference, amplitude, mandelstam_s))
+
+
+@pytest.mark.parametrize('routine', [None,
+                                     IntegrationRoutine.tanh_sinh,
+                                     IntegrationRoutine.gauss_jacobi,
+                                     IntegrationRoutine.warm_start])
+def test_vectorized(routine):
+    """Check that a vectorized phase yields the same Omnes function."""
+    sizes = []
+
+    def phase(s):
+        sizes.append(len(s))
+        return np.array([PHASES[0](x) for x in s])
+
+    reference = generate_omnes(PHASES[0], threshold=THRESHOLD)
+    omnes = generate_omnes(phase, threshold=THRESHOLD, vectorized=True,
+                           integration_routine=routine)
+    mandelstam_s = np.linspace(-1.0, 2.0, 20) + 0.1j
+    assert np.allclose(omnes(mandelstam_s), reference(mandelstam_s))
+    assert max(sizes) > 1
+
+
+@pytest.mark.parametrize('routine', [IntegrationRoutine.cquad,
+                                     IntegrationRoutine.qag])
+def test_vectorized_scalar_routines(routine):
+    """Check that routines without batch evaluation reject vectorization."""
+    with pytest.raises(ValueError):
+        generate_omnes(PHASES[0], threshold=THRESHOLD, vectorized=True,
+                       integration_routine=routine)
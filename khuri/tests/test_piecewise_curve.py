@@ -1,7 +1,8 @@
 import numpy as np
 import pytest
 
-from khuri.khuri_treiman import Real
+from khuri.khuri_treiman import Adaptive, Path, Real, SmoothAdaptive, Traced
+from khuri.mandelstam import lower_curve
 
 LOWER_VALUE = 4.0
 UPPER_VALUE = 100.0
@@ -23,6 +24,9 @@ class TestBoundaries:
     def test_boundaries(self, real):
         assert real.boundaries() == [0.0, 1.0]
 
+    def test_is_linear(self, real):
+        assert real.is_linear()
+
 
 class TestHits:
     def test_miss(self, real):
@@ -43,3 +47,101 @@ class TestEvaluate:
         derivative = UPPER_VALUE - LOWER_VALUE
         for x in np.linspace(0.0, 1.0, 20):
             assert real.derivative_func(x) == pytest.approx(derivative)
+
+    def test_evaluate(self, real):
+        x = np.linspace(0.0, 1.0, 20)
+        values, derivatives = real.evaluate(x)
+        assert values == pytest.approx(real.curve_func(x))
+        assert derivatives == pytest.approx(real.derivative_func(x))
+
+
+@pytest.fixture
+def path():
+    """Path consisting of a line, a quarter circle and a Bezier curve"""
+    return Path([
+        Path.Piece.line(0.0, 1.0),
+        Path.Piece.arc(1.0 + 1.0j, 1.0, -np.pi / 2.0, 0.0),
+        Path.Piece.bezier(2.0 + 1.0j, 2.0 + 2.0j, 3.0 + 3.0j, 4.0 + 1.0j)])
+
+
+class TestPath:
+    def test_boundaries(self, path):
+        assert path.boundaries() == [0.0, 1.0, 2.0, 3.0]
+        assert path.curve_func(path.boundaries()) == pytest.approx(
+            [0.0, 1.0, 2.0 + 1.0j, 4.0 + 1.0j])
+        assert not path.is_linear()
+
+    def test_derivative(self, path):
+        step = 1e-6
+        for x in np.linspace(0.01, 2.99, 50):
+            difference = (path.curve_func(x + step)
+                          - path.curve_func(x - step)) / (2.0 * step)
+            assert path.derivative_func(x) == pytest.approx(difference,
+                                                            abs=1e-8)
+
+    def test_hits(self, path):
+        for x in np.linspace(0.0, 3.0, 31):
+            lower = min(np.floor(x), 2.0)
+            assert path.hits(path.curve_func(x)) == (lower, lower + 1.0)
+        assert path.hits(1.5 + 0.5j) is None
+        assert path.hits(3.0 + 1.5j) is None
+
+    def test_disconnected(self):
+        with pytest.raises(ValueError):
+            Path([Path.Piece.line(0.0, 1.0), Path.Piece.line(2.0, 3.0)])
+
+
+class TestSmoothAdaptive:
+    @pytest.mark.parametrize('virtuality', [12.0, 30.0, 60.0, 100.0])
+    def test_encloses_critical_region(self, virtuality):
+        pion_mass = 1.0
+        curve = SmoothAdaptive(pion_mass, virtuality, 300.0)
+        assert curve.curve_func(0.0) == 4.0 * pion_mass**2
+        assert curve.curve_func(curve.boundaries()[-1]) == 300.0
+        assert all(np.imag(curve.curve_func(curve.boundaries())) == 0.0)
+
+        radius = abs(virtuality - 8.0 * pion_mass**2) / 3.0
+        left = 0.5 * (virtuality - pion_mass**2)
+        right = virtuality - 4.0 * pion_mass**2
+        x = np.linspace(0.0, 1.0, 2001)
+        detour = curve.curve_func(x)
+        # The ellipse passes through the corner that is closer to its ends.
+        for corner in [left, right]:
+            index = np.argmin(abs(detour.real - corner))
+            assert detour[index].imag < -0.99 * radius
+
+
+def polygon_length(points):
+    return np.sum(abs(np.diff(points)))
+
+
+class TestTraced:
+    @pytest.mark.parametrize('virtuality', [12.0, 30.0, 60.0, 100.0])
+    def test_shorter_than_adaptive(self, virtuality):
+        traced = Traced(1.0, virtuality, 300.0)
+        adaptive = Adaptive(1.0, virtuality, 300.0)
+        traced_points = traced.curve_func(traced.boundaries())
+        adaptive_points = adaptive.curve_func(adaptive.boundaries())
+        assert traced_points[0] == 4.0
+        assert traced_points[-1] == 300.0
+        assert (polygon_length(traced_points)
+                < polygon_length(adaptive_points))
+
+    @pytest.mark.parametrize('sides', [2, 3, 5])
+    def test_margin(self, sides):
+        margin = 1.0
+        traced = Traced(1.0, 60.0, 300.0, sides=sides, margin=margin)
+        # the detour ends at s_greater, followed by the cut
+        assert len(traced.boundaries()) == sides + 2
+        x = np.linspace(0.0, sides, 20000)
+        contour = traced.curve_func(x)
+        assert np.all(contour.imag <= 0.0)
+        obstacle = np.array(lower_curve(60.0, 1.0, points=400))
+        distance = np.min(abs(obstacle[:, np.newaxis]
+                              - contour[np.newaxis, :]))
+        assert distance == pytest.approx(margin, rel=1e-2)
+
+    @pytest.mark.parametrize('virtuality', [1.0, 8.5, 9.0])
+    def test_below_nine_pion_masses(self, virtuality):
+        with pytest.raises(ValueError):
+            Traced(1.0, virtuality, 300.0)
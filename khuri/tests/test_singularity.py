@@ -1,7 +1,7 @@
 import pytest
 import numpy as np
 
-from khuri import singularity
+from khuri import mandelstam, singularity
 
 
 def test_cube_root():
@@ -35,3 +35,32 @@ def test_singularity_curves_timelike():
     inner = slice(1, -1)
     assert curves[0].real[inner] == pytest.approx(curves[2].real[inner])
     assert -curves[0].imag[inner] == pytest.approx(curves[2].imag[inner])
+
+
+@pytest.mark.parametrize('decay_mass_2', [-10.0, 12.0, 30.0])
+def test_native_singularity_curve(decay_mass_2):
+    for number in range(3):
+        expected = singularity.singularity_curve(decay_mass_2, 1.0, number,
+                                                 points=50)
+        native = np.array(mandelstam.singularity_curve(decay_mass_2, 1.0,
+                                                       number, points=50))
+        # the closed form is inaccurate at the endpoints
+        inner = slice(1, -1)
+        assert native[inner] == pytest.approx(expected[inner], rel=1e-6,
+                                              abs=1e-6)
+
+
+def test_lower_curve():
+    decay_mass_2 = 60.0
+    curve = np.array(mandelstam.lower_curve(decay_mass_2, 1.0, points=500))
+    assert curve[0] == (decay_mass_2 - 1.0) / 2.0
+    assert curve[-1] == decay_mass_2 - 5.0
+    assert np.all(curve.imag <= 0.0)
+    assert np.all(curve.real >= curve[0].real - 1e-10)
+    assert np.all(curve.real <= curve[-1].real + 1e-10)
+    # each point solves the cubic equation
+    curves = singularity.singularity_curves(decay_mass_2, 1.0, points=2000)
+    lower = curves[0] if curves[0][100].imag < 0.0 else curves[2]
+    distance = np.min(abs(curve[1:-1, np.newaxis] - lower[np.newaxis, :]),
+                      axis=1)
+    assert np.all(distance < 0.5)